@@ -0,0 +1,313 @@
+#include <stdio.h>
+#include <openssl/des.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <stdlib.h>
+
+#include "des_bitslice.h"
+#include "des_check.h"
+#include "des_gray.h"
+#include "keyspace.h"
+#include "search_context.h"
+
+// Microbenchmarks of the candidate-key path: converting a counter to a DES
+// key, setting up the key schedule, decrypting a whole text, the strstr
+// test the programs started from, and testing keys the way the search
+// programs do (a keyword scan over the whole text
+// as in solucion1 / bruteforce_partB, a known offset as with --offset, and
+// single-block checks of 15+ byte keywords as in solucion2), with OpenSSL,
+// the Gray-code walk and every bitslice kernel the CPU supports.
+//
+// Usage: ./bench [--time=S] [--csv=FILE]
+// Each case runs for at least S seconds (default 0.2). The results are
+// printed as a table and, with --csv, written as CSV (FILE "-" is stdout).
+
+// First counter tested (far from the key used to encrypt, so no case stops
+// early on a hit)
+#define BENCH_BASE (1ULL << 40)
+
+// Key used to encrypt the benchmark text
+#define BENCH_KEY 123456
+
+static const char bench_text[] = "Esta es una prueba del Proyecto 2. ";
+
+struct bench_input {
+    size_t length;                // Plaintext length
+    size_t keyword_length;
+    const char *check;            // Name of the check mode
+    uint8_t *ciphertext;
+    char *keyword;
+    DES_cblock iv;
+    struct des_check des;
+    struct search_context ctx;
+    uint8_t *decrypted;
+};
+
+typedef uint64_t (*bench_fn)(struct bench_input *in, uint64_t base, uint64_t count);
+
+double get_time_diff(struct timespec start, struct timespec end) {
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+// long_to_des_key in the search programs
+static uint64_t bench_counter_to_key(struct bench_input *in, uint64_t base, uint64_t count) {
+    (void)in;
+    uint64_t sink = 0;
+    for (uint64_t i = base; i < base + count; i++) {
+        DES_cblock key;
+        keyspace_counter_to_key(i, &key);
+        sink += key[0] ^ key[7];
+    }
+    return sink;
+}
+
+static uint64_t bench_set_key(struct bench_input *in, uint64_t base, uint64_t count) {
+    (void)in;
+    uint64_t sink = 0;
+    for (uint64_t i = base; i < base + count; i++) {
+        DES_cblock key;
+        DES_key_schedule schedule;
+        keyspace_counter_to_key(i, &key);
+        DES_set_key_unchecked(&key, &schedule);
+        sink += schedule.ks[15].deslong[1];
+    }
+    return sink;
+}
+
+// decrypt_with_key in the search programs: the whole text per key
+static uint64_t bench_decrypt(struct bench_input *in, uint64_t base, uint64_t count) {
+    uint64_t sink = 0;
+    for (uint64_t i = base; i < base + count; i++) {
+        DES_cblock key, iv;
+        DES_key_schedule schedule;
+        keyspace_counter_to_key(i, &key);
+        DES_set_key_unchecked(&key, &schedule);
+        memcpy(iv, in->iv, sizeof(DES_cblock));
+        DES_cbc_encrypt(in->ciphertext, in->decrypted, in->length, &schedule, &iv, DES_DECRYPT);
+        sink += in->decrypted[in->length - 1];
+    }
+    return sink;
+}
+
+// decrypt_with_key followed by strstr over the whole text, the test the
+// search programs made before des_match_scan
+static uint64_t bench_strstr(struct bench_input *in, uint64_t base, uint64_t count) {
+    uint64_t hits = 0;
+    for (uint64_t i = base; i < base + count; i++) {
+        DES_cblock key, iv;
+        DES_key_schedule schedule;
+        keyspace_counter_to_key(i, &key);
+        DES_set_key_unchecked(&key, &schedule);
+        memcpy(iv, in->iv, sizeof(DES_cblock));
+        DES_cbc_encrypt(in->ciphertext, in->decrypted, in->length, &schedule, &iv, DES_DECRYPT);
+        in->decrypted[in->length] = '\0';
+        hits += strstr((const char *)in->decrypted, in->keyword) != NULL;
+    }
+    return hits;
+}
+
+// tryKey with the OpenSSL backend
+static uint64_t bench_try_key(struct bench_input *in, uint64_t base, uint64_t count) {
+    uint64_t hits = 0;
+    for (uint64_t i = base; i < base + count; i++) {
+        hits += search_context_try_key(&in->ctx, i, 0) != 0;
+    }
+    return hits;
+}
+
+// tryKey with the OpenSSL backend and --order=gray
+static uint64_t bench_try_gray(struct bench_input *in, uint64_t base, uint64_t count) {
+    uint64_t hits = 0;
+    struct des_gray_walk walk;
+    des_gray_walk_init(&walk, base, base + count - 1, NULL);
+    while (des_gray_walk_next(&walk)) {
+        hits += search_context_try_schedule(&in->ctx, &walk.schedule, 0) != 0;
+    }
+    return hits;
+}
+
+// tryKey with the bitslice backend and the active kernel
+static uint64_t bench_try_bitslice(struct bench_input *in, uint64_t base, uint64_t count) {
+    uint64_t hits = 0;
+    uint64_t lanes = (uint64_t)des_bs_lanes();
+    for (uint64_t done = 0; done < count; done += lanes) {
+        int n = (int)(count - done < lanes ? count - done : lanes);
+        hits += search_context_try_keys(&in->ctx, KEYSPACE_ORDER_LINEAR, NULL, base + done, n, 0) != 0;
+    }
+    return hits;
+}
+
+// Runs fn on more and more keys until one run takes at least min_seconds.
+// Returns the keys of that run and its time.
+static uint64_t bench_run(bench_fn fn, struct bench_input *in, double min_seconds, double *seconds) {
+    static volatile uint64_t sink;
+    for (uint64_t count = 512;; count *= 2) {
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        sink += fn(in, BENCH_BASE, count);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        *seconds = get_time_diff(start, end);
+        if (*seconds >= min_seconds) {
+            return count;
+        }
+    }
+}
+
+static void bench_report(FILE *csv, const char *kernel, const char *simd, const struct bench_input *in,
+                         uint64_t keys, double seconds) {
+    double per_second = keys / seconds;
+    printf("%-18s %-7s %-9s %7zu %7zu %14.0f %10.1f\n", kernel, simd, in->check, in->length,
+           in->keyword_length, per_second, 1e9 / per_second);
+    if (csv != NULL) {
+        fprintf(csv, "%s,%s,%s,%zu,%zu,%llu,%.6f,%.0f,%.2f\n", kernel, simd, in->check, in->length,
+                in->keyword_length, (unsigned long long)keys, seconds, per_second, 1e9 / per_second);
+        fflush(csv);
+    }
+}
+
+// Sets up the encrypted text of length bytes, the keyword (its last
+// keyword_length bytes) and the check for mode "scan" (des_match_scan over
+// the whole text, as in solucion1), "printable" (solucion2's printable ASCII
+// filter before that scan), "offset" or "aligned". Any other mode gets the
+// default check. Returns -1 if the mode does not apply to these sizes.
+static int bench_input_init(struct bench_input *in, size_t length, size_t keyword_length, const char *check,
+                            enum search_backend backend) {
+    in->length = length;
+    in->keyword_length = keyword_length;
+    in->check = check;
+    memset(in->iv, 0, sizeof(DES_cblock));
+
+    uint8_t *plaintext = malloc(length);
+    in->ciphertext = malloc(length);
+    in->keyword = malloc(keyword_length + 1);
+    in->decrypted = malloc(length + 1);
+    if (plaintext == NULL || in->ciphertext == NULL || in->keyword == NULL || in->decrypted == NULL) {
+        fprintf(stderr, "Failed to allocate the benchmark buffers.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < length; i++) {
+        plaintext[i] = (uint8_t)bench_text[i % (sizeof(bench_text) - 1)];
+    }
+    memcpy(in->keyword, plaintext + length - keyword_length, keyword_length);
+    in->keyword[keyword_length] = '\0';
+
+    DES_cblock key, iv;
+    DES_key_schedule schedule;
+    keyspace_counter_to_key(BENCH_KEY, &key);
+    DES_set_key_unchecked(&key, &schedule);
+    memcpy(iv, in->iv, sizeof(DES_cblock));
+    DES_cbc_encrypt(plaintext, in->ciphertext, length, &schedule, &iv, DES_ENCRYPT);
+    free(plaintext);
+
+    long offset = strcmp(check, "offset") == 0 ? (long)(length - keyword_length) : DES_CHECK_ANYWHERE;
+    des_check_init(&in->des, in->ciphertext, length, &in->iv, (const char *const *)&in->keyword, 1, DES_MATCH_ANY,
+                   offset);
+    if (strcmp(check, "scan") == 0 || strcmp(check, "printable") == 0) {
+        in->des.aligned = 0;
+        if (check[0] == 'p') {
+            des_check_printable(&in->des);
+        }
+    } else if (strcmp(check, "aligned") == 0 && !in->des.aligned) {
+        des_check_free(&in->des);
+        free(in->ciphertext);
+        free(in->keyword);
+        free(in->decrypted);
+        return -1;
+    }
+    if (search_context_init(&in->ctx, &in->des, 1, backend) != 0) {
+        exit(EXIT_FAILURE);
+    }
+    return 0;
+}
+
+static void bench_input_free(struct bench_input *in) {
+    search_context_free(&in->ctx);
+    des_check_free(&in->des);
+    free(in->ciphertext);
+    free(in->keyword);
+    free(in->decrypted);
+}
+
+int main(int argc, char *argv[]) {
+    double min_seconds = 0.2;
+    FILE *csv = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--time=", 7) == 0 && atof(argv[i] + 7) > 0) {
+            min_seconds = atof(argv[i] + 7);
+        } else if (strncmp(argv[i], "--csv=", 6) == 0 && argv[i][6] != '\0') {
+            csv = strcmp(argv[i] + 6, "-") == 0 ? stdout : fopen(argv[i] + 6, "w");
+            if (csv == NULL) {
+                fprintf(stderr, "Cannot open %s\n", argv[i] + 6);
+                return 1;
+            }
+        } else {
+            printf("Usage: %s [--time=S] [--csv=FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    des_gray_init();
+    des_bs_init("auto");
+    if (csv != NULL) {
+        fprintf(csv, "kernel,simd,check,length,keyword_length,keys,seconds,keys_per_second,ns_per_key\n");
+    }
+    printf("%-18s %-7s %-9s %7s %7s %14s %10s\n", "kernel", "simd", "check", "length", "keyword", "keys/s",
+           "ns/key");
+
+    static const size_t lengths[] = {8, 64, 1024, 8192};
+    static const size_t keyword_lengths[] = {8, 16, 32};
+    static const char *checks[] = {"scan", "printable", "offset", "aligned"};
+
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+        struct bench_input in;
+        uint64_t keys;
+        double seconds;
+
+        // Key setup and whole-text decryption do not depend on the keyword
+        bench_input_init(&in, lengths[l], DES_KEY_SZ, "none", SEARCH_BACKEND_OPENSSL);
+        if (l == 0) {
+            keys = bench_run(bench_counter_to_key, &in, min_seconds, &seconds);
+            bench_report(csv, "long_to_des_key", "-", &in, keys, seconds);
+            keys = bench_run(bench_set_key, &in, min_seconds, &seconds);
+            bench_report(csv, "des_set_key", "-", &in, keys, seconds);
+        }
+        keys = bench_run(bench_decrypt, &in, min_seconds, &seconds);
+        bench_report(csv, "decrypt_with_key", "-", &in, keys, seconds);
+        bench_input_free(&in);
+
+        for (size_t k = 0; k < sizeof(keyword_lengths) / sizeof(keyword_lengths[0]); k++) {
+            if (keyword_lengths[k] > lengths[l]) {
+                continue;
+            }
+            bench_input_init(&in, lengths[l], keyword_lengths[k], "strstr", SEARCH_BACKEND_OPENSSL);
+            keys = bench_run(bench_strstr, &in, min_seconds, &seconds);
+            bench_report(csv, "decrypt_strstr", "-", &in, keys, seconds);
+            bench_input_free(&in);
+            for (size_t c = 0; c < sizeof(checks) / sizeof(checks[0]); c++) {
+                if (bench_input_init(&in, lengths[l], keyword_lengths[k], checks[c], SEARCH_BACKEND_BITSLICE) != 0) {
+                    continue;
+                }
+                keys = bench_run(bench_try_key, &in, min_seconds, &seconds);
+                bench_report(csv, "try_key_openssl", "-", &in, keys, seconds);
+                keys = bench_run(bench_try_gray, &in, min_seconds, &seconds);
+                bench_report(csv, "try_key_gray", "-", &in, keys, seconds);
+                for (int s = 0; s < DES_BS_KERNEL_COUNT; s++) {
+                    if (!des_bs_kernel_supported(&des_bs_kernels[s])) {
+                        continue;
+                    }
+                    des_bs_active = &des_bs_kernels[s];
+                    keys = bench_run(bench_try_bitslice, &in, min_seconds, &seconds);
+                    bench_report(csv, "try_key_bitslice", des_bs_kernels[s].name, &in, keys, seconds);
+                }
+                des_bs_init("auto");
+                bench_input_free(&in);
+            }
+        }
+    }
+
+    if (csv != NULL && csv != stdout) {
+        fclose(csv);
+    }
+    return 0;
+}
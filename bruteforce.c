@@ -4,6 +4,22 @@
 #include <mpi.h>
 #include <openssl/des.h>
 
+#include "des_bitslice.h"
+#include "des_check.h"
+#include "des_tmto.h"
+#include "keyspace.h"
+#include "search_checkpoint.h"
+#include "search_dist.h"
+#include "search_options.h"
+#include "search_pool.h"
+#include "search_stats.h"
+#include "search_stop.h"
+
+// Flags this program accepts (search_options.h)
+#define PROGRAM_OPTIONS (SEARCH_OPT_BACKEND | SEARCH_OPT_ORDER | SEARCH_OPT_TRAVERSAL | SEARCH_OPT_THREADS \
+                         | SEARCH_OPT_DISTRIBUTION | SEARCH_OPT_RANGE | SEARCH_OPT_CHECKPOINT \
+                         | SEARCH_OPT_TMTO)
+
 // DES key size
 #define DES_KEY_SIZE 8
 
@@ -40,46 +56,215 @@ void print_key(const uint8_t *key, int size) {
 }
 
 void long_to_des_key(unsigned long long key, DES_cblock *des_key) {
-    // We have to split the key into bytes and copy it into the DES_cblock (8 bytes).
-    for (int i = 0; i < 7; ++i) {
-        (*des_key)[7 - i] = (unsigned char)((key >> (i * 8)) & 0xFF);  // Big-endian byte order
-    }
-    (*des_key)[0] = 0x00;  // Ensure that the highest byte is zero for 56-bit key
+    // Spread the 56 key bits over the 7 used bits of each byte, skipping the
+    // parity bits DES ignores (see keyspace.h)
+    keyspace_counter_to_key(key, des_key);
 }
 
-// Try a key and check if it decrypts correctly
-int tryKey(unsigned long long key, const uint8_t *ciphertext, int len, const char *keyword, const DES_cblock *iv, int id) {
-    uint8_t decrypted[len];
-    memset(decrypted, 0, len);
+// --tmto-build: every process builds its share of the chains of every
+// table and writes them to PATH.<rank> on its local disk. Returns -1 on
+// every process if any of them failed.
+static int tmto_build(const struct search_options *opts, MPI_Comm comm, const DES_cblock *plaintext) {
+    int N, id;
+    MPI_Comm_size(comm, &N);
+    MPI_Comm_rank(comm, &id);
 
-    DES_cblock des_key;
-    // memcpy(&des_key, &key, sizeof(DES_cblock));
-    long_to_des_key(key, &des_key);
+    struct keyspace_mask mask;
+    unsigned long long keys = 1ULL << opts->key_bits;
+    unsigned long long length = opts->chain_length ? opts->chain_length : 1ULL << ((opts->key_bits + 2) / 3);
+    unsigned long long chains = opts->chains ? opts->chains : 2 * keys / length;
+    chains = chains < 1 ? 1 : chains > keys ? keys : chains;  // Every chain starts at its own key
+    struct des_tmto tmto;
+    des_tmto_init(&tmto, plaintext, opts->key_bits, search_key_mask(opts, &mask), length, chains, opts->tables);
+    if (id == 0) {
+        printf("Building %d tables of %llu chains of %llu keys over 2^%d keys\n", opts->tables, chains, length,
+               opts->key_bits);
+    }
 
-    // printf("Process %d is trying \n", id);
-    // print_key(des_key, DES_KEY_SIZE);
+    double start = MPI_Wtime();
+    unsigned long long first = chains * id / N, count = chains * (id + 1) / N - first;
+    struct des_tmto_table tables[DES_TMTO_MAX_TABLES];
+    unsigned long long kept = 0;
+    int status = 0;
+    for (int t = 0; t < opts->tables; t++) {
+        tables[t].count = 0;
+        tables[t].chains = NULL;
+        if (status == 0) {
+            status = des_tmto_build(&tmto, t, first, count, opts->threads, &tables[t]);
+            kept += tables[t].count;
+        }
+    }
+    char file[4096];
+    snprintf(file, sizeof(file), "%s.%d", opts->tmto_build, id);
+    if (status == 0) {
+        status = des_tmto_write(file, &tmto, tables, id, N);
+    }
+    for (int t = 0; t < opts->tables; t++) {
+        des_tmto_table_free(&tables[t]);
+    }
+
+    int worst;
+    unsigned long long total;
+    MPI_Allreduce(&status, &worst, 1, MPI_INT, MPI_MIN, comm);
+    MPI_Reduce(&kept, &total, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, 0, comm);
+    if (id == 0 && worst == 0) {
+        printf("Tables written to %s.<rank> in %f seconds: %llu chains left after dropping merged ones\n",
+               opts->tmto_build, MPI_Wtime() - start, total);
+    }
+    return worst;
+}
 
-    decrypt_with_key(ciphertext, decrypted, &des_key, iv);
+// --tmto-lookup: every process walks its share of the columns from the
+// ciphertext to the chain ends, and looks all of them up in the table files
+// it has (PATH.<rank>, and those of ranks beyond the current process count).
+// Returns -1 on every process if the tables cannot be used; *found is the
+// counter of the key, or SEARCH_STOP_NONE.
+static int tmto_lookup(const struct search_options *opts, MPI_Comm comm, const uint8_t *ciphertext, long *found) {
+    int N, id;
+    MPI_Comm_size(comm, &N);
+    MPI_Comm_rank(comm, &id);
+    *found = SEARCH_STOP_NONE;
 
-    // Check if the decrypted text contains the keyword
-    return strstr((char *)decrypted, keyword) != NULL;
+    // Rank 0 reads the shape of the set, every process its own files
+    struct des_tmto_header h;
+    char file[4096];
+    int status = 0;
+    if (id == 0) {
+        snprintf(file, sizeof(file), "%s.0", opts->tmto_lookup);
+        status = des_tmto_read_header(file, &h);
+    }
+    MPI_Bcast(&status, 1, MPI_INT, 0, comm);
+    if (status != 0) {
+        return -1;
+    }
+    MPI_Bcast(&h, sizeof(h), MPI_BYTE, 0, comm);
+
+    DES_cblock plaintext;
+    for (int i = 0; i < 8; i++) {
+        plaintext[i] = (uint8_t)(h.plaintext >> (56 - 8 * i));
+    }
+    struct keyspace_mask mask;
+    if (h.free != 0) {
+        keyspace_mask_init(&mask, h.free, h.fixed);
+    }
+    struct des_tmto tmto;
+    des_tmto_init(&tmto, &plaintext, (int)h.bits, h.free != 0 ? &mask : NULL, h.length, h.chains, (int)h.tables);
+
+    int parts = id < (int)h.parts ? ((int)h.parts - id + N - 1) / N : 0;
+    struct des_tmto_table *tables = calloc((size_t)(parts ? parts : 1) * h.tables, sizeof(struct des_tmto_table));
+    uint64_t *ends = calloc(h.tables * h.length, sizeof(uint64_t));
+    status = tables == NULL || ends == NULL ? -1 : 0;
+    for (int p = 0; p < parts && status == 0; p++) {
+        snprintf(file, sizeof(file), "%s.%d", opts->tmto_lookup, id + p * N);
+        status = des_tmto_read(file, &h, tables + (size_t)p * h.tables);
+        if (status != 0) {
+            parts = p;
+        }
+    }
+    int worst;
+    MPI_Allreduce(&status, &worst, 1, MPI_INT, MPI_MIN, comm);
+
+    uint64_t c = 0;
+    for (int i = 0; i < 8; i++) {
+        c = (c << 8) | ciphertext[i];
+    }
+    unsigned long long work[2] = {0, 0};  // Encryptions and false alarms
+    uint64_t key = UINT64_MAX;
+    if (worst == 0) {
+        // Ends of the chains holding the key in each column, interleaved
+        // so every process walks about as far
+        for (int t = 0; t < tmto.tables; t++) {
+            for (uint64_t column = (uint64_t)id; column < tmto.length; column += (uint64_t)N) {
+                ends[t * tmto.length + column] = des_tmto_end(&tmto, t, column, c);
+                work[0] += tmto.length - 1 - column;
+            }
+        }
+        MPI_Allreduce(MPI_IN_PLACE, ends, (int)(h.tables * h.length), MPI_UINT64_T, MPI_BOR, comm);
+
+        for (int p = 0; p < parts && key == UINT64_MAX; p++) {
+            for (int t = 0; t < tmto.tables && key == UINT64_MAX; t++) {
+                const struct des_tmto_table *table = &tables[(size_t)p * h.tables + t];
+                for (uint64_t column = 0; column < tmto.length && key == UINT64_MAX; column++) {
+                    long chain = des_tmto_find(table, ends[t * tmto.length + column]);
+                    if (chain < 0) {
+                        continue;
+                    }
+                    work[0] += column + 1;
+                    if (!des_tmto_check(&tmto, t, &table->chains[chain], column, c, &key)) {
+                        work[1]++;
+                    }
+                }
+            }
+        }
+    }
+    uint64_t best;
+    unsigned long long sum[2];
+    MPI_Allreduce(&key, &best, 1, MPI_UINT64_T, MPI_MIN, comm);
+    MPI_Reduce(work, sum, 2, MPI_UNSIGNED_LONG_LONG, MPI_SUM, 0, comm);
+    if (id == 0 && worst == 0) {
+        printf("Table lookup: %llu tables of %llu keys per chain, %llu encryptions, %llu false alarms\n",
+               (unsigned long long)h.tables, (unsigned long long)h.length, sum[0], sum[1]);
+    }
+    for (size_t i = 0; tables != NULL && i < (size_t)parts * h.tables; i++) {
+        des_tmto_table_free(&tables[i]);
+    }
+    free(tables);
+    free(ends);
+    if (best != UINT64_MAX) {
+        *found = (long)best;
+    }
+    return worst;
 }
 
 int main(int argc, char *argv[]) {
     int N, id;
-    unsigned long long upper = (1ULL << 56);  // Upper bound for DES keys (2^56)
+    unsigned long long upper = KEYSPACE_SIZE;  // Upper bound for DES keys (2^56)
     unsigned long long mylower, myupper;
     long found = 0;  // Moved to a higher scope
     double start_time, end_time;  // Moved to a higher scope
-    MPI_Status st;
-    MPI_Request req;
-    int flag = 0;
     MPI_Comm comm = MPI_COMM_WORLD;
 
-    MPI_Init(&argc, &argv);
+    // Only this thread calls MPI; the search threads never do
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    if (provided < MPI_THREAD_FUNNELED) {
+        // The workers run beside the thread that calls MPI
+        fprintf(stderr, "Error: MPI provides thread level %d, below MPI_THREAD_FUNNELED.\n", provided);
+        MPI_Abort(comm, EXIT_FAILURE);
+    }
     MPI_Comm_size(comm, &N);
     MPI_Comm_rank(comm, &id);
 
+    struct search_options opts;
+    if (parse_search_options(&argc, argv, PROGRAM_OPTIONS, &opts) != 0 || argc != 1) {
+        if (id == 0) {
+            printf("Usage: %s [options]\n", argv[0]);
+            print_search_options(PROGRAM_OPTIONS);
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    if (opts.tables > DES_TMTO_MAX_TABLES) {
+        if (id == 0) {
+            printf("Error: at most %d tables\n", DES_TMTO_MAX_TABLES);
+        }
+        MPI_Finalize();
+        return 1;
+    }
+
+    if (opts.end - opts.start < (unsigned long long)N) {
+        if (id == 0) {
+            printf("Error: the key range holds fewer keys than there are processes\n");
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    des_gray_init();
+    if (des_bs_init(opts.simd) != 0) {
+        MPI_Finalize();
+        return 1;
+    }
+
     const uint8_t correct_plaintext[DES_KEY_SIZE] = {0x48, 0x65, 0x6C, 0x6C, 0x6F, 0x57, 0x72, 0x6C};  // Example: "HelloWrl"
     uint8_t ciphertext[DES_KEY_SIZE];
 
@@ -112,43 +297,118 @@ int main(int argc, char *argv[]) {
     MPI_Bcast(ciphertext, DES_KEY_SIZE, MPI_UNSIGNED_CHAR, 0, comm);
     MPI_Bcast(&keyword, DES_KEY_SIZE, MPI_UNSIGNED_CHAR, 0, comm);
 
-    unsigned long long range_per_node = upper / N;  // Divide the key space by all N workers
-    mylower = range_per_node * id;  // Start range for this process
-    myupper = (id == N - 1) ? upper : range_per_node * (id + 1) - 1;  // Last process gets the remaining keys
+    // Rainbow tables for the plaintext block replace the search (with a
+    // zero IV the single CBC block is a plain DES encryption)
+    if (opts.tmto_build != NULL) {
+        int status = tmto_build(&opts, comm, (const DES_cblock *)correct_plaintext);
+        MPI_Finalize();
+        return status != 0;
+    }
+    if (opts.tmto_lookup != NULL) {
+        const uint8_t *target = opts.ciphertext_given ? opts.ciphertext : ciphertext;
+        start_time = MPI_Wtime();
+        int status = tmto_lookup(&opts, comm, target, &found);
+        if (id == 0 && status == 0 && found == SEARCH_STOP_NONE) {
+            printf("Key not found in the tables\n");
+        } else if (id == 0 && status == 0) {
+            DES_cblock des_key;
+            long_to_des_key(found, &des_key);
+            uint8_t decrypted[DES_KEY_SIZE + 1] = {0};
+            decrypt_with_key(target, decrypted, &des_key, &iv);
+            printf("Key found: %li\nDecrypted: %s\n", found, decrypted);
+            printf("Time taken to look the key up: %f seconds\n", MPI_Wtime() - start_time);
+        }
+        MPI_Finalize();
+        return status != 0;
+    }
 
-    printf("Process %d: Searching keys from %llx to %llx\n", id, mylower, myupper);
+    upper = opts.end;  // --start, --end and --key-bits narrow the search
 
-    start_time = MPI_Wtime();
+    // The single block decrypts to the keyword
+    const char *keywords[] = {keyword};
+    struct des_check check;
+    des_check_init(&check, ciphertext, DES_KEY_SIZE, &iv, keywords, 1, DES_MATCH_ANY, 0);
 
-    MPI_Irecv(&found, 1, MPI_LONG, MPI_ANY_SOURCE, MPI_ANY_TAG, comm, &req);
+    int lanes_per_pass = des_bs_lanes();
+    if (opts.backend == SEARCH_BACKEND_BITSLICE && id == 0) {
+        printf("Bitslice kernel: %s (%d keys per pass)\n", des_bs_kernel_name(), lanes_per_pass);
+    }
+    if (opts.masked && id == 0) {
+        printf("Key pattern: %d unknown bits\n", opts.key_bits);
+    }
 
-    for (unsigned long long i = mylower; i <= myupper; ++i) {
-        // Periodically check if a key has been found
-        MPI_Test(&req, &flag, &st);
-        if (flag) {
-            // Key found by another process, stop searching
-            break;
-        }
-        if (tryKey(i, ciphertext, DES_KEY_SIZE, keyword, &iv, id)) {
-            found = i;
-            printf("Key found by process %d\n", id);
-            // Broadcast the found key to all other processes
-            for (int node = 0; node < N; node++) {
-                MPI_Send(&found, 1, MPI_LONG, node, 0, MPI_COMM_WORLD);
-            }
-            break;
-        }
+    // Direction of each process's walk and, for some traversals or a
+    // --key-pattern, the key each position stands for (keyspace.h)
+    enum keyspace_traversal traversal = search_traversal(&opts, KEYSPACE_TRAVERSAL_FORWARD);
+    int down = keyspace_traversal_down(traversal, id);
+    struct keyspace_map map;
+    struct keyspace_mask mask;
+    keyspace_map_init(&map, traversal, opts.start, opts.end, N, opts.seed, search_key_mask(&opts, &mask));
+
+    // Keys already searched by an interrupted run are skipped with --resume
+    struct search_checkpoint ckpt;
+    if (search_checkpoint_init(&ckpt, comm, &opts, &check, &map) != 0) {
+        MPI_Finalize();
+        return 1;
     }
 
-    MPI_Test(&req, &flag, &st);
-    if (flag) {
-        printf("Process %d received notification to stop.\n", id);
+    // --distribution=weighted times every process first and splits the
+    // range by speed
+    struct search_dist_weights weights;
+    if (search_dist_calibrate(&weights, comm, &opts, &check, 1, &map, opts.start, upper) != 0) {
+        MPI_Abort(comm, EXIT_FAILURE);
     }
+    search_dist_share(&weights, id, N, opts.start, upper, &mylower, &myupper);
 
+    if (opts.distribution == SEARCH_DIST_DYNAMIC) {
+        printf("Process %d: Taking chunks of %llu keys on demand with %d threads\n", id, opts.chunk, opts.threads);
+    } else {
+        printf("Process %d: Searching keys from %llx to %llx with %d threads\n", id, mylower, myupper, opts.threads);
+    }
 
-    MPI_Barrier(comm);
+    start_time = MPI_Wtime();
 
-    if (id == 0) {
+    // Worker threads search the keys handed to this process while this
+    // thread polls MPI for a stop from another process and for new chunks
+    struct search_pool pool;
+    if (search_pool_start(&pool, &check, 1, opts.backend, opts.order, opts.threads) != 0) {
+        MPI_Abort(comm, EXIT_FAILURE);
+    }
+    search_checkpoint_attach(&ckpt, &pool);
+    search_pool_map(&pool, &map);
+    struct search_dist dist;
+    search_dist_init(&dist, &pool, comm, opts.distribution, opts.chunk, opts.lease, down, opts.start, opts.end,
+                     mylower, myupper, &weights);
+    struct search_stop stop;
+    search_stop_init(&stop, comm, &pool);
+    while (search_stop_poll(&stop, &pool)) {
+        search_dist_progress(&dist, &pool, &stop);
+        search_checkpoint_tick(&ckpt, &pool);
+        search_stop_nap(&stop);
+    }
+    struct search_stats stats;
+    search_stats_collect(&stats, &pool, &stop, start_time);
+    search_checkpoint_save(&ckpt, &pool);
+    if (search_pool_join(&pool)) {
+        printf("Key found by process %d\n", id);
+    } else if (stop.key != SEARCH_STOP_NONE) {
+        printf("Process %d received notification to stop.\n", id);
+    }
+    search_dist_finish(&dist);
+    search_dist_weights_free(&weights);
+    search_checkpoint_free(&ckpt);
+    des_check_free(&check);
+    found = stop.key;
+
+    // Processes given up on (--lease) never reach the barrier
+    if (dist.lost == 0) {
+        search_stats_barrier(&stats, comm);
+    }
+
+    if (id == 0 && found == SEARCH_STOP_NONE) {
+        printf("Key not found\n");
+        printf("Time taken to search the key space: %f seconds\n", MPI_Wtime() - start_time);
+    } else if (id == 0) {
         end_time = MPI_Wtime();
         double elapsed_time = end_time - start_time;
 
@@ -161,10 +421,13 @@ int main(int argc, char *argv[]) {
 
         printf("Key found: %li\nDecrypted: %s\n", found, decrypted);
         printf("Time taken to find the key: %f seconds\n", elapsed_time);
+        printf("Stop latency: %f seconds\n", stop.latency);
 
         
     }
 
+    search_dist_abandon(comm, dist.lost);
+    search_stats_report(&stats, comm);
     MPI_Finalize();
     return 0;
 
@@ -4,6 +4,25 @@
 #include <mpi.h>
 #include <openssl/des.h>
 
+#include "des_bitslice.h"
+#include "des_check.h"
+#include "keyspace.h"
+#include "search_checkpoint.h"
+#include "search_context.h"
+#include "search_dict_file.h"
+#include "search_dist.h"
+#include "search_file.h"
+#include "search_pool.h"
+#include "search_stats.h"
+#include "search_stop.h"
+#include "search_options.h"
+
+// Flags this program accepts (search_options.h)
+#define PROGRAM_OPTIONS (SEARCH_OPT_BACKEND | SEARCH_OPT_ORDER | SEARCH_OPT_TRAVERSAL | SEARCH_OPT_OFFSET \
+                         | SEARCH_OPT_THREADS | SEARCH_OPT_DISTRIBUTION | SEARCH_OPT_RANGE \
+                         | SEARCH_OPT_CHECKPOINT | SEARCH_OPT_KEYWORDS | SEARCH_OPT_BATCH \
+                         | SEARCH_OPT_DICTIONARY)
+
 // DES key size
 #define DES_KEY_SIZE 8
 
@@ -40,201 +59,398 @@ void print_key(const uint8_t *key, int size) {
 }
 
 void long_to_des_key(unsigned long long key, DES_cblock *des_key) {
-    // We have to split the key into bytes and copy it into the DES_cblock (8 bytes).
-    for (int i = 0; i < 7; ++i) {
-        (*des_key)[7 - i] = (unsigned char)((key >> (i * 8)) & 0xFF);  // Big-endian byte order
-    }
-    (*des_key)[0] = 0x00;  // Ensure that the highest byte is zero for 56-bit key
+    // Spread the 56 key bits over the 7 used bits of each byte, skipping the
+    // parity bits DES ignores (see keyspace.h)
+    keyspace_counter_to_key(key, des_key);
 }
 
-// Try a key and check if it decrypts correctly
-int tryKey(long key, const uint8_t *ciphertext, int len, const char *keyword, const DES_cblock *iv, int id) {
-    uint8_t *decrypted = malloc(len); 
-    memset(decrypted, 0, len);
 
-    DES_cblock des_key;
-    // memcpy(&des_key, &key, sizeof(DES_cblock));
-    long_to_des_key(key, &des_key);
-    // printf("Process %d using key: %lln\n", id, key);
-    // print_key(&key, DES_KEY_SIZE);
 
-    decrypt_with_key(ciphertext, decrypted, &des_key, iv,len);
+// One ciphertext to recover: a plaintext file encrypted with a known key
+struct target {
+    const char *file;
+    const char *keyword;
+    const char *keywords[SEARCH_MAX_KEYWORDS]; // keyword and the --keyword flags
+    unsigned long long private_key;
+    uint8_t *plaintext;
+    size_t plaintext_length;
+    uint8_t *ciphertext;
+};
+
+// Reads the targets of --batch, one "<plaintext_file> <private_key> <keyword>"
+// per line (the keyword is the rest of the line; blank lines and lines
+// starting with # are skipped). Returns the number of targets, or -1.
+int read_batch_file(const char *filename, struct target *targets) {
+    FILE *file = fopen(filename, "r");
+    if (file == NULL) {
+        perror("Failed to open batch file");
+        return -1;
+    }
 
-    // Check if the decrypted text matches the correct plaintext
-    return strstr(decrypted, keyword) != NULL;
+    int count = 0;
+    char line[4096];
+    while (fgets(line, sizeof(line), file) != NULL) {
+        line[strcspn(line, "\r\n")] = '\0';
+        char *name = strtok(line, " \t");
+        if (name == NULL || name[0] == '#') {
+            continue;
+        }
+        char *key = strtok(NULL, " \t");
+        char *keyword = key != NULL ? strtok(NULL, "") : NULL;
+        while (keyword != NULL && (*keyword == ' ' || *keyword == '\t')) {
+            keyword++;
+        }
+        if (keyword == NULL || *keyword == '\0') {
+            printf("Error: batch lines are \"<plaintext_file> <private_key> <keyword>\"\n");
+            fclose(file);
+            return -1;
+        }
+        if (count == SEARCH_TARGETS_MAX) {
+            printf("Error: a batch holds at most %d targets\n", SEARCH_TARGETS_MAX);
+            fclose(file);
+            return -1;
+        }
+        if (parse_search_key(key, &targets[count].private_key) != 0) {
+            fclose(file);
+            return -1;
+        }
+        targets[count].file = strdup(name);
+        targets[count].keyword = strdup(keyword);
+        count++;
+    }
+    fclose(file);
+    if (count == 0) {
+        printf("Error: %s lists no targets\n", filename);
+        return -1;
+    }
+    return count;
 }
 
+// Searches positions [begin, end), split between the processes (by speed
+// with weights): the lines of dict if it is not NULL, else the key space
+// under map (with checkpoints if ckpt is not NULL). Targets whose keys[] is set are skipped, and the
+// keys solved in this pass are added to keys (on rank 0 all of them). Returns the processes rank 0 gave
+// up on (--lease); the others always return 0.
+static int search_pass(const struct search_options *opts, MPI_Comm comm, const struct des_check *checks,
+                        int target_count, const struct search_dict *dict, const struct keyspace_map *map,
+                        struct search_checkpoint *ckpt, int down, unsigned long long begin, unsigned long long end,
+                        const struct search_dist_weights *weights, long keys[], struct search_stop *stop,
+                        struct search_stats *stats) {
+    int N, id;
+    MPI_Comm_size(comm, &N);
+    MPI_Comm_rank(comm, &id);
+    const char *unit = dict != NULL ? "dictionary bytes" : "keys";
 
-
-// Function to read the entire plaintext from a file
-uint8_t* read_plaintext_from_file(const char *filename, size_t *length) {
-    FILE *file = fopen(filename, "rb");
-    if (file == NULL) {
-        perror("Failed to open file");
-        return NULL;
+    unsigned long long mylower, myupper;
+    search_dist_share(weights, id, N, begin, end, &mylower, &myupper);
+
+    if (opts->distribution == SEARCH_DIST_DYNAMIC) {
+        printf("Process %d: Taking chunks of %llu %s on demand with %d threads\n", id, opts->chunk, unit,
+               opts->threads);
+    } else {
+        printf("Process %d: Searching %s from %llx to %llx with %d threads\n", id, unit, mylower, myupper,
+               opts->threads);
     }
 
-    // Get the file size
-    fseek(file, 0, SEEK_END);
-    long file_size = ftell(file);
-    rewind(file);
+    double start_time = MPI_Wtime();
 
-    if (file_size <= 0) {
-        printf("Error: File is empty or has invalid size.\n");
-        fclose(file);
-        return NULL;
+    // Worker threads search the keys handed to this process while this
+    // thread polls MPI for a stop from another process and for new chunks
+    struct search_pool pool;
+    if (search_pool_start(&pool, checks, target_count, opts->backend, opts->order, opts->threads) != 0) {
+        MPI_Abort(comm, EXIT_FAILURE);
     }
-
-    // Allocate memory for the file contents
-    uint8_t *buffer = (uint8_t *)malloc(file_size);
-    if (buffer == NULL) {
-        printf("Error: Failed to allocate memory.\n");
-        fclose(file);
-        return NULL;
+    for (int t = 0; t < target_count; t++) {
+        if (keys[t] != SEARCH_STOP_NONE) {
+            search_pool_retire(&pool, t);
+        }
     }
-
-    // Read the entire file into the buffer
-    size_t bytes_read = fread(buffer, 1, file_size, file);
-    if (bytes_read != file_size) {
-        printf("Error: Failed to read entire file.\n");
-        free(buffer);
-        fclose(file);
-        return NULL;
+    if (dict != NULL) {
+        search_pool_dict(&pool, dict);
+    } else {
+        search_checkpoint_attach(ckpt, &pool);
+        search_pool_map(&pool, map);
     }
-
-    *length = file_size;  // Set the length of the plaintext
-    fclose(file);
-    return buffer;
+    struct search_dist dist;
+    search_dist_init(&dist, &pool, comm, opts->distribution, opts->chunk, opts->lease, down, begin, end, mylower,
+                     myupper, weights);
+    search_stop_init(stop, comm, &pool);
+    while (search_stop_poll(stop, &pool)) {
+        search_dist_progress(&dist, &pool, stop);
+        if (dict == NULL) {
+            search_checkpoint_tick(ckpt, &pool);
+        }
+        search_stop_nap(stop);
+    }
+    search_stats_collect(stats, &pool, stop, start_time);
+    if (dict == NULL) {
+        search_checkpoint_save(ckpt, &pool);
+    }
+    if (search_pool_join(&pool)) {
+        printf("Key found by process %d\n", id);
+    } else if (stop->key != SEARCH_STOP_NONE) {
+        printf("Process %d received notification to stop.\n", id);
+    }
+    search_dist_finish(&dist);
+    for (int t = 0; t < target_count; t++) {
+        if (stop->keys[t] != SEARCH_STOP_NONE) {
+            keys[t] = stop->keys[t];
+        }
+    }
+    return dist.lost;
 }
 
-
-
 int main(int argc, char *argv[]) {
-    if (argc != 4) {
-        printf("Usage: %s <plaintext_file> <keyword> <private_key>\n", argv[0]);
+    struct search_options opts;
+    if (parse_search_options(&argc, argv, PROGRAM_OPTIONS, &opts) != 0 || argc != (opts.batch != NULL ? 1 : 4)) {
+        printf("Usage: %s [options] <plaintext_file> <keyword> <private_key>\n", argv[0]);
+        printf("       %s [options] --batch=FILE\n", argv[0]);
+        print_search_options(PROGRAM_OPTIONS);
+        return 1;
+    }
+    des_gray_init();
+    if (des_bs_init(opts.simd) != 0) {
         return 1;
     }
 
-    const char *plaintext_file = argv[1];
-    const char *keyword = argv[2];
-    unsigned long long private_key = strtoull(argv[3], NULL, 10);
-
+    // Every key tried is tested against all the targets at once
+    struct target targets[SEARCH_TARGETS_MAX];
+    int target_count = 1;
+    if (opts.batch != NULL) {
+        target_count = read_batch_file(opts.batch, targets);
+        if (target_count < 0) {
+            return 1;
+        }
+    } else {
+        targets[0].file = argv[1];
+        targets[0].keyword = argv[2];
+        if (parse_search_key(argv[3], &targets[0].private_key) != 0) {
+            return 1;
+        }
+    }
 
-    size_t plaintext_length;
-    uint8_t *plaintext = read_plaintext_from_file(plaintext_file, &plaintext_length);
-    if (plaintext == NULL) {
-        return 1;
+    for (int t = 0; t < target_count; t++) {
+        targets[t].plaintext = read_plaintext_from_file(targets[t].file, &targets[t].plaintext_length);
+        if (targets[t].plaintext == NULL) {
+            return 1;
+        }
     }
 
     int N, id;
-    unsigned long long upper = (1ULL << 56);  
-    unsigned long long mylower, myupper;
     long found = 0;  
     double start_time, end_time;  
-    MPI_Status st;
-    MPI_Request req;
-    int flag = 0;
     MPI_Comm comm = MPI_COMM_WORLD;
 
-    MPI_Init(&argc, &argv);
+    // Only this thread calls MPI; the search threads never do
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    if (provided < MPI_THREAD_FUNNELED) {
+        // The workers run beside the thread that calls MPI
+        fprintf(stderr, "Error: MPI provides thread level %d, below MPI_THREAD_FUNNELED.\n", provided);
+        MPI_Abort(comm, EXIT_FAILURE);
+    }
     MPI_Comm_size(comm, &N);
     MPI_Comm_rank(comm, &id);
 
+    if (opts.end - opts.start < (unsigned long long)N) {
+        if (id == 0) {
+            printf("Error: the key range holds fewer keys than there are processes\n");
+        }
+        MPI_Finalize();
+        return 1;
+    }
+
+    struct search_dict dict = {0};
+    if (opts.dictionary != NULL && search_dict_open(&dict, opts.dictionary, opts.derive) != 0) {
+        MPI_Finalize();
+        return 1;
+    }
+    if (opts.dictionary != NULL && dict.size < (size_t)N) {
+        if (id == 0) {
+            printf("Error: the dictionary holds fewer bytes than there are processes\n");
+        }
+        MPI_Finalize();
+        return 1;
+    }
 
-    uint8_t *ciphertext = (uint8_t *)malloc(plaintext_length);
     DES_cblock iv = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};  // IV initialization
-    
-    DES_cblock generated_key;
-    long_to_des_key(private_key, &generated_key);
+    struct des_check checks[SEARCH_TARGETS_MAX];
 
-    MPI_Bcast(&plaintext_length, 1, MPI_UNSIGNED_LONG, 0, comm);
-    
-    MPI_Barrier(comm);
+    for (int t = 0; t < target_count; t++) {
+        uint8_t *plaintext = targets[t].plaintext;
+        size_t plaintext_length = targets[t].plaintext_length;
 
-    if (id == 0) {
-        // Process 0 will perform the encryption
-        printf("Plaintext: %s\n", plaintext);
-        printf("Encrypting with key:\n");
-        print_key((uint8_t *)&generated_key, DES_KEY_SIZE);
+        // DES_cbc_encrypt writes whole blocks, so round the buffer up
+        size_t padded_length = (plaintext_length + DES_KEY_SIZE - 1) / DES_KEY_SIZE * DES_KEY_SIZE;
+        uint8_t *ciphertext = (uint8_t *)calloc(padded_length, 1);
+        targets[t].ciphertext = ciphertext;
 
-        // Encrypt the plaintext using the specified key
-        encrypt_with_key(plaintext, ciphertext, &generated_key, &iv,plaintext_length);
+        DES_cblock generated_key;
+        long_to_des_key(targets[t].private_key, &generated_key);
 
-        // Print the ciphertext
-        printf("Ciphertext: ");
-        for (int i = 0; i < plaintext_length; i++) {
-            printf("%02x ", ciphertext[i]);
+        MPI_Bcast(&plaintext_length, 1, MPI_UNSIGNED_LONG, 0, comm);
+
+        MPI_Barrier(comm);
+
+        if (id == 0) {
+            if (opts.batch != NULL) {
+                printf("Target %d: %s\n", t, targets[t].file);
+            }
+            // Process 0 will perform the encryption
+            printf("Plaintext: %s\n", plaintext);
+            printf("Encrypting with key:\n");
+            print_key((uint8_t *)&generated_key, DES_KEY_SIZE);
+
+            // Encrypt the plaintext using the specified key
+            encrypt_with_key(plaintext, ciphertext, &generated_key, &iv,plaintext_length);
+
+            // Print the ciphertext
+            printf("Ciphertext: ");
+            for (int i = 0; i < plaintext_length; i++) {
+                printf("%02x ", ciphertext[i]);
+            }
+            printf("\n");
         }
-        printf("\n");
 
-        
-    }
+        MPI_Barrier(comm);
 
-    MPI_Barrier(comm);
+        // Broadcast the ciphertext to all processes
+        MPI_Bcast(ciphertext, padded_length, MPI_UNSIGNED_CHAR, 0, comm);
 
-    // Broadcast the ciphertext to all processes
-    MPI_Bcast(ciphertext, plaintext_length, MPI_UNSIGNED_CHAR, 0, comm);
+        int keyword_count = search_keywords(&opts, targets[t].keyword, targets[t].keywords);
+        if (des_check_init(&checks[t], ciphertext, plaintext_length, &iv, targets[t].keywords, keyword_count,
+                           opts.match, opts.offset) != 0) {
+            MPI_Finalize();
+            return 1;
+        }
+    }
 
-    unsigned long long range_per_node = upper / N;  // Divide the key space by all N workers
-    mylower = range_per_node * id;  // Start range for this process
-    myupper = (id == N - 1) ? upper : range_per_node * (id + 1) - 1;  // Last process gets the remaining keys
+    int lanes_per_pass = des_bs_lanes();
+    if (opts.backend == SEARCH_BACKEND_BITSLICE && id == 0) {
+        printf("Bitslice kernel: %s (%d keys per pass)\n", des_bs_kernel_name(), lanes_per_pass);
+    }
+    if (opts.masked && id == 0) {
+        printf("Key pattern: %d unknown bits\n", opts.key_bits);
+    }
 
-    printf("Process %d: Searching keys from %llx to %llx\n", id, mylower, myupper);
+    // Direction of each process's walk and, for some traversals or a
+    // --key-pattern, the key each position stands for (keyspace.h)
+    enum keyspace_traversal traversal = search_traversal(&opts, KEYSPACE_TRAVERSAL_FORWARD);
+    int down = keyspace_traversal_down(traversal, id);
+    struct keyspace_map map;
+    struct keyspace_mask mask;
+    keyspace_map_init(&map, traversal, opts.start, opts.end, N, opts.seed, search_key_mask(&opts, &mask));
+
+    // Keys already searched by an interrupted run are skipped with --resume
+    struct search_checkpoint ckpt;
+    if (search_checkpoint_init(&ckpt, comm, &opts, &checks[0], &map) != 0) {
+        MPI_Finalize();
+        return 1;
+    }
+
+    // --distribution=weighted times every process first and splits each
+    // pass by speed
+    struct search_dist_weights weights;
+    if (search_dist_calibrate(&weights, comm, &opts, checks, target_count, &map, opts.start, opts.end) != 0) {
+        MPI_Abort(comm, EXIT_FAILURE);
+    }
 
+    long keys[SEARCH_TARGETS_MAX];
+    for (int t = 0; t < target_count; t++) {
+        keys[t] = SEARCH_STOP_NONE;
+    }
+    int solved = 0;
+    int lost = 0;
+    struct search_stop stop;
+    struct search_stats stats;
     start_time = MPI_Wtime();
 
-    MPI_Irecv(&found, 1, MPI_LONG, MPI_ANY_SOURCE, MPI_ANY_TAG, comm, &req);
-
-    for (unsigned long long i = mylower; i <= myupper; ++i) {
-        // Periodically check if a key has been found
-        MPI_Test(&req, &flag, &st);
-        if (flag) {
-            // Key found by another process, stop searching
-            break;
-        }
-        if (tryKey(i, ciphertext, plaintext_length, keyword, &iv, id)) {
-            found = i;
-            printf("Key found by process %d\n", id);
-            // Broadcast the found key to all other processes
-            for (int node = 0; node < N; node++) {
-                MPI_Send(&found, 1, MPI_LONG, node, 0, MPI_COMM_WORLD);
+    // The wordlist goes first, front to back, and the key space only if it
+    // leaves a target unsolved
+    if (opts.dictionary != NULL) {
+        if (id == 0) {
+            printf("Dictionary: %s (%zu bytes)\n", opts.dictionary, dict.size);
+        }
+        lost = search_pass(&opts, comm, checks, target_count, &dict, NULL, NULL, 0, 0, dict.size, &weights, keys,
+                           &stop, &stats);
+        // Processes given up on (--lease) never reach the collectives
+        if (lost == 0) {
+            search_stats_barrier(&stats, comm);
+            MPI_Bcast(keys, target_count, MPI_LONG, 0, comm);
+        }
+        for (int t = 0; t < target_count; t++) {
+            solved += keys[t] != SEARCH_STOP_NONE;
+        }
+    }
+    if (solved < target_count && lost > 0) {
+        printf("Processes stopped answering during the dictionary pass: the key space was not searched\n");
+    } else if (solved < target_count) {
+        if (opts.dictionary != NULL) {
+            search_stats_report(&stats, comm);
+            if (id == 0) {
+                printf("Dictionary exhausted, searching the key space\n");
             }
-            break;
+        }
+        lost = search_pass(&opts, comm, checks, target_count, NULL, &map, &ckpt, down, opts.start, opts.end,
+                           &weights, keys, &stop, &stats);
+        if (lost == 0) {
+            search_stats_barrier(&stats, comm);
         }
     }
-
-    MPI_Test(&req, &flag, &st);
-    if (flag) {
-        printf("Process %d received notification to stop.\n", id);
+    search_dict_close(&dict);
+    search_dist_weights_free(&weights);
+    search_checkpoint_free(&ckpt);
+    for (int t = 0; t < target_count; t++) {
+        des_check_free(&checks[t]);
     }
 
-    MPI_Barrier(comm);
-
     if (id == 0) {
         end_time = MPI_Wtime();
         double elapsed_time = end_time - start_time;
 
-        // Decrypt with the found key and print the result
-        DES_cblock des_key;
-        long_to_des_key(found, &des_key);
+        solved = 0;
+        for (int t = 0; t < target_count; t++) {
+            if (opts.batch != NULL) {
+                printf("Target %d: %s\n", t, targets[t].file);
+            }
+            found = keys[t];
+            if (found == SEARCH_STOP_NONE) {
+                printf("Key not found\n");
+                continue;
+            }
+            solved++;
 
-        uint8_t *decrypted = (uint8_t *)malloc(plaintext_length + 1);  // Allocate buffer with null terminator
-        if (decrypted == NULL) {
-            fprintf(stderr, "Failed to allocate memory for decrypted buffer.\n");
-            MPI_Abort(comm, EXIT_FAILURE);
-        }
+            // Decrypt with the found key and print the result
+            DES_cblock des_key;
+            long_to_des_key(found, &des_key);
 
-        decrypt_with_key(ciphertext, decrypted, &des_key, &iv, plaintext_length);
+            size_t plaintext_length = targets[t].plaintext_length;
+            uint8_t *decrypted = (uint8_t *)malloc(plaintext_length + 1);  // Allocate buffer with null terminator
+            if (decrypted == NULL) {
+                fprintf(stderr, "Failed to allocate memory for decrypted buffer.\n");
+                MPI_Abort(comm, EXIT_FAILURE);
+            }
+
+            decrypt_with_key(targets[t].ciphertext, decrypted, &des_key, &iv, plaintext_length);
 
-        decrypted[plaintext_length] = '\0';
+            decrypted[plaintext_length] = '\0';
 
-        printf("Key found: %li\nDecrypted: %s\n", found, decrypted);
-        printf("Time taken to find the key: %f seconds\n", elapsed_time);
+            printf("Key found: %li\nDecrypted: %s\n", found, decrypted);
 
-        free(decrypted);
+            free(decrypted);
+        }
+
+        if (solved == target_count) {
+            printf("Time taken to find the key: %f seconds\n", elapsed_time);
+            printf("Stop latency: %f seconds\n", stop.latency);
+        } else {
+            printf("Time taken to search the key space: %f seconds\n", elapsed_time);
+        }
     }
 
 
+    search_dist_abandon(comm, lost);
+    search_stats_report(&stats, comm);
     MPI_Barrier(comm);
     MPI_Finalize();
     return 0;
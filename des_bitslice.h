@@ -0,0 +1,309 @@
+#ifndef DES_BITSLICE_H
+#define DES_BITSLICE_H
+
+// Bitsliced DES used as an alternative search backend.
+//
+// Instead of running DES_set_key + DES_cbc_encrypt once per candidate, every
+// bit of the cipher state is stored in its own machine word and bit "l" of
+// each word belongs to candidate key "l". A single pass over the 16 rounds
+// therefore tests one key per bit of the word, and because the key schedule
+// is only a permutation of key bits it costs nothing in this representation.
+//
+// The kernel in des_bitslice_kernel.h is instantiated for 64-bit integers and,
+// on x86-64, for SSE2 (128), AVX2 (256) and AVX-512 (512 bit) registers.
+// des_bs_init() picks the widest one the CPU supports unless told otherwise.
+
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <openssl/des.h>
+
+// Most keys any kernel tests per pass, for sizing caller buffers
+#define DES_BS_MAX_LANES 512
+
+// Initial permutation (FIPS 46-3), 1-based bit positions
+static const uint8_t des_bs_ip[64] = {
+    58, 50, 42, 34, 26, 18, 10, 2, 60, 52, 44, 36, 28, 20, 12, 4,
+    62, 54, 46, 38, 30, 22, 14, 6, 64, 56, 48, 40, 32, 24, 16, 8,
+    57, 49, 41, 33, 25, 17,  9, 1, 59, 51, 43, 35, 27, 19, 11, 3,
+    61, 53, 45, 37, 29, 21, 13, 5, 63, 55, 47, 39, 31, 23, 15, 7
+};
+
+// Expansion of the 32-bit half block into 48 bits
+static const uint8_t des_bs_e[48] = {
+    32,  1,  2,  3,  4,  5,  4,  5,  6,  7,  8,  9,
+     8,  9, 10, 11, 12, 13, 12, 13, 14, 15, 16, 17,
+    16, 17, 18, 19, 20, 21, 20, 21, 22, 23, 24, 25,
+    24, 25, 26, 27, 28, 29, 28, 29, 30, 31, 32,  1
+};
+
+// Permutation applied to the S-box outputs
+static const uint8_t des_bs_p[32] = {
+    16,  7, 20, 21, 29, 12, 28, 17,  1, 15, 23, 26,  5, 18, 31, 10,
+     2,  8, 24, 14, 32, 27,  3,  9, 19, 13, 30,  6, 22, 11,  4, 25
+};
+
+// Permuted choice 1: selects the 56 key bits (parity bits are dropped)
+static const uint8_t des_bs_pc1[56] = {
+    57, 49, 41, 33, 25, 17,  9,  1, 58, 50, 42, 34, 26, 18,
+    10,  2, 59, 51, 43, 35, 27, 19, 11,  3, 60, 52, 44, 36,
+    63, 55, 47, 39, 31, 23, 15,  7, 62, 54, 46, 38, 30, 22,
+    14,  6, 61, 53, 45, 37, 29, 21, 13,  5, 28, 20, 12,  4
+};
+
+// Permuted choice 2: selects the 48 subkey bits from C and D
+static const uint8_t des_bs_pc2[48] = {
+    14, 17, 11, 24,  1,  5,  3, 28, 15,  6, 21, 10,
+    23, 19, 12,  4, 26,  8, 16,  7, 27, 20, 13,  2,
+    41, 52, 31, 37, 47, 55, 30, 40, 51, 45, 33, 48,
+    44, 49, 39, 56, 34, 53, 46, 42, 50, 36, 29, 32
+};
+
+// Left rotations of C and D before each round
+static const uint8_t des_bs_shifts[16] = {1, 1, 2, 2, 2, 2, 2, 2, 1, 2, 2, 2, 2, 2, 2, 1};
+
+// Tables derived once by des_bs_init()
+static uint8_t des_bs_fp[64];             // Inverse of the initial permutation (0-based)
+static uint8_t des_bs_pinv[32];           // S-box output bit -> position in f(R) (0-based)
+static uint8_t des_bs_ks[16][48];         // Round subkey bit -> key bit (0-based, MSB of byte 0 is 0)
+static int des_bs_ready = 0;
+
+// Builds the tables derived from the FIPS ones above (once)
+static void des_bs_build_tables(void) {
+    if (des_bs_ready) {
+        return;
+    }
+
+    for (int i = 0; i < 64; i++) {
+        des_bs_fp[des_bs_ip[i] - 1] = (uint8_t)i;
+    }
+    for (int j = 0; j < 32; j++) {
+        des_bs_pinv[des_bs_p[j] - 1] = (uint8_t)j;
+    }
+
+    // The key schedule only moves bits around, so record where every subkey
+    // bit comes from instead of computing subkeys
+    int shift = 0;
+    for (int round = 0; round < 16; round++) {
+        shift += des_bs_shifts[round];
+        for (int j = 0; j < 48; j++) {
+            int cd = des_bs_pc2[j] - 1;
+            int half = (cd < 28) ? 0 : 28;
+            int rotated = half + (cd - half + shift) % 28;
+            des_bs_ks[round][j] = (uint8_t)(des_bs_pc1[rotated] - 1);
+        }
+    }
+
+    des_bs_ready = 1;
+}
+
+// Packs an 8-byte block into a 64-bit integer, byte 0 in the high bits
+static inline uint64_t des_bs_pack(const uint8_t *block) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) {
+        v = (v << 8) | block[i];
+    }
+    return v;
+}
+
+static inline void des_bs_unpack(uint64_t v, uint8_t *block) {
+    for (int i = 7; i >= 0; i--) {
+        block[i] = (uint8_t)(v & 0xFF);
+        v >>= 8;
+    }
+}
+
+// In-place transpose of a 64x64 bit matrix: bit c of a[r] becomes bit r of a[c]
+static inline void des_bs_transpose64(uint64_t a[64]) {
+    uint64_t m = 0x00000000FFFFFFFFULL;
+    for (int j = 32; j != 0; j >>= 1, m ^= m << j) {
+        for (int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+            uint64_t t = ((a[k] >> j) ^ a[k | j]) & m;
+            a[k] ^= t << j;
+            a[k | j] ^= t;
+        }
+    }
+}
+
+// Applies the initial permutation to a packed block
+static inline uint64_t des_bs_permute_ip(uint64_t v) {
+    uint64_t out = 0;
+    for (int i = 0; i < 64; i++) {
+        out = (out << 1) | ((v >> (64 - des_bs_ip[i])) & 1);
+    }
+    return out;
+}
+
+// Kernel instantiations
+
+#define DES_BS_WORD uint64_t
+#define DES_BS_WIDTH 1
+#define DES_BS_FN(x) des_bs_##x##_scalar
+#include "des_bitslice_kernel.h"
+#undef DES_BS_WORD
+#undef DES_BS_WIDTH
+#undef DES_BS_FN
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define DES_BS_HAVE_SIMD 1
+
+typedef uint64_t des_bs_v128 __attribute__((vector_size(16)));
+typedef uint64_t des_bs_v256 __attribute__((vector_size(32)));
+typedef uint64_t des_bs_v512 __attribute__((vector_size(64)));
+
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#define DES_BS_WORD des_bs_v128
+#define DES_BS_WIDTH 2
+#define DES_BS_FN(x) des_bs_##x##_sse2
+#include "des_bitslice_kernel.h"
+#undef DES_BS_WORD
+#undef DES_BS_WIDTH
+#undef DES_BS_FN
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#define DES_BS_WORD des_bs_v256
+#define DES_BS_WIDTH 4
+#define DES_BS_FN(x) des_bs_##x##_avx2
+#include "des_bitslice_kernel.h"
+#undef DES_BS_WORD
+#undef DES_BS_WIDTH
+#undef DES_BS_FN
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#define DES_BS_WORD des_bs_v512
+#define DES_BS_WIDTH 8
+#define DES_BS_FN(x) des_bs_##x##_avx512
+#include "des_bitslice_kernel.h"
+#undef DES_BS_WORD
+#undef DES_BS_WIDTH
+#undef DES_BS_FN
+#pragma GCC pop_options
+#endif
+
+// Runtime dispatch
+
+struct des_bs_kernel {
+    const char *name;
+    int lanes;
+    // Sets bit l of hits (lanes / 64 words) when key l decrypts ciphertext to
+    // expected on the bytes selected by mask (0xff = compare the byte).
+    // expected is a plaintext-side value, so for CBC the caller XORs the
+    // previous ciphertext block (or IV) into it first.
+    void (*match_keys)(const DES_cblock *keys, int count, const uint8_t *ciphertext,
+                       const uint8_t *expected, const uint8_t *mask, uint64_t *hits);
+    // CBC-decrypts the first length bytes of ciphertext under each key; key l
+    // writes its plaintext to out + l * stride
+    void (*decrypt_cbc)(const DES_cblock *keys, int count, const uint8_t *ciphertext, size_t length,
+                        const DES_cblock *iv, uint8_t *out, size_t stride);
+    // Sets bit l of hits when, for one of the CBC blocks 0, step, 2 * step...
+    // below blocks, key l decrypts it to one of the n plaintext blocks in
+    // targets (des_bs_target form)
+    void (*match_any)(const DES_cblock *keys, int count, const uint8_t *ciphertext, size_t blocks, size_t step,
+                      const DES_cblock *iv, const uint64_t *targets, int n, uint64_t *hits);
+};
+
+static const struct des_bs_kernel des_bs_kernels[] = {
+    {"scalar", 64, des_bs_match_keys_scalar, des_bs_decrypt_cbc_scalar, des_bs_match_any_scalar},
+#ifdef DES_BS_HAVE_SIMD
+    {"sse2", 128, des_bs_match_keys_sse2, des_bs_decrypt_cbc_sse2, des_bs_match_any_sse2},
+    {"avx2", 256, des_bs_match_keys_avx2, des_bs_decrypt_cbc_avx2, des_bs_match_any_avx2},
+    {"avx512", 512, des_bs_match_keys_avx512, des_bs_decrypt_cbc_avx512, des_bs_match_any_avx512},
+#endif
+};
+
+#define DES_BS_KERNEL_COUNT ((int)(sizeof(des_bs_kernels) / sizeof(des_bs_kernels[0])))
+
+// Kernel used by des_bs_match_keys / des_bs_decrypt_cbc
+static const struct des_bs_kernel *des_bs_active = &des_bs_kernels[0];
+
+static int des_bs_kernel_supported(const struct des_bs_kernel *kernel) {
+#ifdef DES_BS_HAVE_SIMD
+    __builtin_cpu_init();
+    if (strcmp(kernel->name, "sse2") == 0) {
+        return __builtin_cpu_supports("sse2");
+    }
+    if (strcmp(kernel->name, "avx2") == 0) {
+        return __builtin_cpu_supports("avx2");
+    }
+    if (strcmp(kernel->name, "avx512") == 0) {
+        return __builtin_cpu_supports("avx512f");
+    }
+#endif
+    return strcmp(kernel->name, "scalar") == 0;
+}
+
+// Builds the derived tables and selects the kernel. simd is "auto" (widest
+// kernel the CPU supports) or a kernel name to force. Must run before any
+// other des_bs_* call and before worker threads are started. Returns -1 if
+// the requested kernel is unknown or not supported by this CPU.
+static int des_bs_init(const char *simd) {
+    des_bs_build_tables();
+
+    if (simd == NULL || strcmp(simd, "auto") == 0) {
+        for (int i = 0; i < DES_BS_KERNEL_COUNT; i++) {
+            if (des_bs_kernel_supported(&des_bs_kernels[i])) {
+                des_bs_active = &des_bs_kernels[i];
+            }
+        }
+        return 0;
+    }
+
+    for (int i = 0; i < DES_BS_KERNEL_COUNT; i++) {
+        if (strcmp(simd, des_bs_kernels[i].name) == 0) {
+            if (!des_bs_kernel_supported(&des_bs_kernels[i])) {
+                printf("Error: this CPU does not support the %s kernel\n", simd);
+                return -1;
+            }
+            des_bs_active = &des_bs_kernels[i];
+            return 0;
+        }
+    }
+    printf("Error: unknown SIMD kernel %s\n", simd);
+    return -1;
+}
+
+// Number of keys the active kernel tests per call
+static inline int des_bs_lanes(void) {
+    return des_bs_active->lanes;
+}
+
+static inline const char *des_bs_kernel_name(void) {
+    return des_bs_active->name;
+}
+
+static inline void des_bs_match_keys(const DES_cblock *keys, int count, const uint8_t *ciphertext,
+                                     const uint8_t *expected, const uint8_t *mask, uint64_t *hits) {
+    des_bs_active->match_keys(keys, count, ciphertext, expected, mask, hits);
+}
+
+static inline void des_bs_decrypt_cbc(const DES_cblock *keys, int count, const uint8_t *ciphertext, size_t length,
+                                      const DES_cblock *iv, uint8_t *out, size_t stride) {
+    des_bs_active->decrypt_cbc(keys, count, ciphertext, length, iv, out, stride);
+}
+
+static inline void des_bs_match_any(const DES_cblock *keys, int count, const uint8_t *ciphertext, size_t blocks,
+                                    size_t step, const DES_cblock *iv, const uint64_t *targets, int n, uint64_t *hits) {
+    des_bs_active->match_any(keys, count, ciphertext, blocks, step, iv, targets, n, hits);
+}
+
+// Converts a plaintext block to the form des_bs_match_any compares against
+static inline uint64_t des_bs_target(const uint8_t *block) {
+    return des_bs_permute_ip(des_bs_pack(block));
+}
+
+// First lane below count whose bit is set in hits, or -1
+static inline int des_bs_first_hit(const uint64_t *hits, int count) {
+    for (int l = 0; l < count; l++) {
+        if ((hits[l / 64] >> (l % 64)) & 1) {
+            return l;
+        }
+    }
+    return -1;
+}
+
+#endif
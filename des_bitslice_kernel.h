@@ -0,0 +1,202 @@
+// Bitsliced DES kernel for one register width.
+//
+// Included by des_bitslice.h once per instantiation (no include guard) with:
+//   DES_BS_WORD    the register type (uint64_t or a GCC vector of uint64_t)
+//   DES_BS_WIDTH   number of uint64_t elements in a DES_BS_WORD
+//   DES_BS_FN(x)   name mangling, e.g. x##_avx2
+// Lane l of a word belongs to bit (l % 64) of its 64-bit element l / 64.
+
+#define DES_BS_ZERO DES_BS_FN(splat)(0)
+#define DES_BS_ONES DES_BS_FN(splat)(~0ULL)
+
+static inline DES_BS_WORD DES_BS_FN(splat)(uint64_t v) {
+    DES_BS_WORD w;
+    uint64_t parts[DES_BS_WIDTH];
+    for (int i = 0; i < DES_BS_WIDTH; i++) {
+        parts[i] = v;
+    }
+    memcpy(&w, parts, sizeof(w));
+    return w;
+}
+
+#include "des_bitslice_sboxes.h"
+
+static inline void DES_BS_FN(sbox_eval)(int s, const DES_BS_WORD x[6], DES_BS_WORD out[4]) {
+    switch (s) {
+    case 0: DES_BS_FN(s1)(x[0], x[1], x[2], x[3], x[4], x[5], &out[0], &out[1], &out[2], &out[3]); break;
+    case 1: DES_BS_FN(s2)(x[0], x[1], x[2], x[3], x[4], x[5], &out[0], &out[1], &out[2], &out[3]); break;
+    case 2: DES_BS_FN(s3)(x[0], x[1], x[2], x[3], x[4], x[5], &out[0], &out[1], &out[2], &out[3]); break;
+    case 3: DES_BS_FN(s4)(x[0], x[1], x[2], x[3], x[4], x[5], &out[0], &out[1], &out[2], &out[3]); break;
+    case 4: DES_BS_FN(s5)(x[0], x[1], x[2], x[3], x[4], x[5], &out[0], &out[1], &out[2], &out[3]); break;
+    case 5: DES_BS_FN(s6)(x[0], x[1], x[2], x[3], x[4], x[5], &out[0], &out[1], &out[2], &out[3]); break;
+    case 6: DES_BS_FN(s7)(x[0], x[1], x[2], x[3], x[4], x[5], &out[0], &out[1], &out[2], &out[3]); break;
+    default: DES_BS_FN(s8)(x[0], x[1], x[2], x[3], x[4], x[5], &out[0], &out[1], &out[2], &out[3]); break;
+    }
+}
+
+// Loads up to DES_BS_WIDTH * 64 keys; missing lanes repeat the first key
+static inline void DES_BS_FN(load_keys)(const DES_cblock *keys, int count, DES_BS_WORD slices[64]) {
+    uint64_t parts[64][DES_BS_WIDTH];
+    for (int g = 0; g < DES_BS_WIDTH; g++) {
+        uint64_t rows[64];
+        for (int l = 0; l < 64; l++) {
+            int lane = g * 64 + l;
+            rows[l] = des_bs_pack(keys[lane < count ? lane : 0]);
+        }
+        des_bs_transpose64(rows);
+        for (int b = 0; b < 64; b++) {
+            parts[b][g] = rows[63 - b];
+        }
+    }
+    for (int b = 0; b < 64; b++) {
+        memcpy(&slices[b], parts[b], sizeof(DES_BS_WORD));
+    }
+}
+
+static inline DES_BS_WORD DES_BS_FN(broadcast)(uint64_t v, int bit) {
+    return ((v >> (63 - bit)) & 1) ? DES_BS_ONES : DES_BS_ZERO;
+}
+
+static inline int DES_BS_FN(all_set)(DES_BS_WORD w) {
+    uint64_t parts[DES_BS_WIDTH];
+    memcpy(parts, &w, sizeof(w));
+    for (int i = 0; i < DES_BS_WIDTH; i++) {
+        if (parts[i] != ~0ULL) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static inline void DES_BS_FN(round)(const DES_BS_WORD *l, const DES_BS_WORD *r, DES_BS_WORD *new_r,
+                                    const DES_BS_WORD key[64], const uint8_t *subkey) {
+    for (int s = 0; s < 8; s++) {
+        DES_BS_WORD x[6], out[4];
+        for (int m = 0; m < 6; m++) {
+            x[m] = r[des_bs_e[6 * s + m] - 1] ^ key[subkey[6 * s + m]];
+        }
+        DES_BS_FN(sbox_eval)(s, x, out);
+        for (int o = 0; o < 4; o++) {
+            int pos = des_bs_pinv[4 * s + o];
+            new_r[pos] = l[pos] ^ out[o];
+        }
+    }
+}
+
+// Runs the 16 decryption rounds of one block (see des_bs_match_keys for the
+// meaning of expected and mask, both given in IP order). Returns the lanes
+// whose output matches, stopping after round 15 if none can.
+static inline DES_BS_WORD DES_BS_FN(rounds)(const DES_BS_WORD key[64], uint64_t block, DES_BS_WORD pre[64],
+                                            const uint64_t *expected, uint64_t mask) {
+    DES_BS_WORD a[32], b[32], c[32];
+    DES_BS_WORD *l = a, *r = b, *next = c;
+
+    for (int i = 0; i < 32; i++) {
+        l[i] = DES_BS_FN(broadcast)(block, des_bs_ip[i] - 1);
+        r[i] = DES_BS_FN(broadcast)(block, des_bs_ip[32 + i] - 1);
+    }
+
+    DES_BS_WORD diff = DES_BS_ZERO;
+    for (int round = 0; round < 16; round++) {
+        DES_BS_FN(round)(l, r, next, key, des_bs_ks[15 - round]);
+        DES_BS_WORD *tmp = l;
+        l = r;
+        r = next;
+        next = tmp;
+
+        if (expected != NULL && round == 14) {
+            // The right half after round 15 is the final left half
+            for (int i = 0; i < 32; i++) {
+                if ((mask >> (31 - i)) & 1) {
+                    diff |= r[i] ^ DES_BS_FN(broadcast)(*expected, 32 + i);
+                }
+            }
+            if (DES_BS_FN(all_set)(diff)) {
+                return DES_BS_ZERO;
+            }
+        }
+    }
+
+    if (expected != NULL) {
+        for (int i = 0; i < 32; i++) {
+            if ((mask >> (63 - i)) & 1) {
+                diff |= r[i] ^ DES_BS_FN(broadcast)(*expected, i);
+            }
+        }
+    }
+    if (pre != NULL) {
+        memcpy(pre, r, 32 * sizeof(DES_BS_WORD));
+        memcpy(pre + 32, l, 32 * sizeof(DES_BS_WORD));
+    }
+    return ~diff;
+}
+
+static void DES_BS_FN(match_keys)(const DES_cblock *keys, int count, const uint8_t *ciphertext,
+                                  const uint8_t *expected, const uint8_t *mask, uint64_t *hits) {
+    DES_BS_WORD slices[64];
+    DES_BS_FN(load_keys)(keys, count, slices);
+
+    uint64_t target = des_bs_permute_ip(des_bs_pack(expected));
+    uint64_t bits = des_bs_permute_ip(des_bs_pack(mask));
+    DES_BS_WORD result = DES_BS_FN(rounds)(slices, des_bs_pack(ciphertext), NULL, &target, bits);
+    memcpy(hits, &result, sizeof(result));
+}
+
+static void DES_BS_FN(match_any)(const DES_cblock *keys, int count, const uint8_t *ciphertext, size_t blocks,
+                                 size_t step, const DES_cblock *iv, const uint64_t *targets, int n, uint64_t *hits) {
+    DES_BS_WORD slices[64], pre[64];
+    DES_BS_FN(load_keys)(keys, count, slices);
+
+    DES_BS_WORD any = DES_BS_ZERO;
+    for (size_t b = 0; b < blocks; b += step) {
+        const uint8_t *chain = (b == 0) ? *iv : ciphertext + (b - 1) * DES_KEY_SZ;
+        uint64_t shift = des_bs_permute_ip(des_bs_pack(chain));
+        DES_BS_FN(rounds)(slices, des_bs_pack(ciphertext + b * DES_KEY_SZ), pre, NULL, 0);
+
+        // Compare in the bitsliced domain, without transposing the output
+        for (int k = 0; k < n; k++) {
+            uint64_t target = targets[k] ^ shift;
+            DES_BS_WORD diff = DES_BS_ZERO;
+            for (int i = 0; i < 64; i++) {
+                diff |= pre[i] ^ DES_BS_FN(broadcast)(target, i);
+            }
+            any |= ~diff;
+        }
+    }
+    memcpy(hits, &any, sizeof(any));
+}
+
+static void DES_BS_FN(decrypt_cbc)(const DES_cblock *keys, int count, const uint8_t *ciphertext, size_t length,
+                                   const DES_cblock *iv, uint8_t *out, size_t stride) {
+    DES_BS_WORD slices[64], pre[64];
+    DES_BS_FN(load_keys)(keys, count, slices);
+
+    uint64_t prev = des_bs_pack(*iv);
+    for (size_t off = 0; off < length; off += DES_KEY_SZ) {
+        size_t n = (length - off < DES_KEY_SZ) ? length - off : DES_KEY_SZ;
+        DES_BS_FN(rounds)(slices, des_bs_pack(ciphertext + off), pre, NULL, 0);
+
+        uint64_t parts[64][DES_BS_WIDTH];
+        for (int i = 0; i < 64; i++) {
+            memcpy(parts[i], &pre[des_bs_fp[i]], sizeof(DES_BS_WORD));
+        }
+        for (int g = 0; g < DES_BS_WIDTH; g++) {
+            uint64_t rows[64];
+            for (int i = 0; i < 64; i++) {
+                rows[63 - i] = parts[i][g];
+            }
+            des_bs_transpose64(rows);
+
+            int lanes = count - g * 64;
+            for (int l = 0; l < 64 && l < lanes; l++) {
+                uint8_t bytes[DES_KEY_SZ];
+                des_bs_unpack(rows[l] ^ prev, bytes);
+                memcpy(out + (size_t)(g * 64 + l) * stride + off, bytes, n);
+            }
+        }
+        prev = des_bs_pack(ciphertext + off);
+    }
+}
+
+#undef DES_BS_ZERO
+#undef DES_BS_ONES
@@ -0,0 +1,1209 @@
+// Generated by tools/gen_des_sboxes.py, do not edit.
+//
+// Bitsliced DES S-boxes. Inputs x0..x5 are the S-box input bits b1..b6,
+// outputs o0..o3 the four output bits, most significant first.
+//
+// Included by des_bitslice_kernel.h once per register width, with
+// DES_BS_WORD, DES_BS_FN, DES_BS_ZERO and DES_BS_ONES defined by the caller.
+
+// S1: 151 gates
+static inline void DES_BS_FN(s1)(DES_BS_WORD x0, DES_BS_WORD x1, DES_BS_WORD x2,
+                                 DES_BS_WORD x3, DES_BS_WORD x4, DES_BS_WORD x5,
+                                 DES_BS_WORD *o0, DES_BS_WORD *o1, DES_BS_WORD *o2, DES_BS_WORD *o3) {
+    DES_BS_WORD t6 = x4 ^ x5;
+    DES_BS_WORD t7 = ~t6;
+    DES_BS_WORD t8 = x4 | x5;
+    DES_BS_WORD t9 = ~t8;
+    DES_BS_WORD t10 = x4 & x5;
+    DES_BS_WORD t11 = ~t10;
+    DES_BS_WORD t12 = x5 & ~x4;
+    DES_BS_WORD t13 = ~t12;
+    DES_BS_WORD t14 = x4 & ~x5;
+    DES_BS_WORD t17 = x1 ^ t7;
+    DES_BS_WORD t18 = x1 ^ t9;
+    DES_BS_WORD t19 = x1 ^ t11;
+    DES_BS_WORD t20 = x5 ^ t13;
+    DES_BS_WORD t21 = x1 & t20;
+    DES_BS_WORD t22 = x5 ^ t21;
+    DES_BS_WORD t23 = t7 ^ t11;
+    DES_BS_WORD t24 = x1 & t23;
+    DES_BS_WORD t25 = t11 ^ t24;
+    DES_BS_WORD t26 = t10 ^ t14;
+    DES_BS_WORD t27 = x1 & t26;
+    DES_BS_WORD t28 = t14 ^ t27;
+    DES_BS_WORD t29 = t17 ^ t18;
+    DES_BS_WORD t30 = x3 & t29;
+    DES_BS_WORD t31 = t17 ^ t30;
+    DES_BS_WORD t32 = t6 ^ t19;
+    DES_BS_WORD t33 = x3 & t32;
+    DES_BS_WORD t34 = t6 ^ t33;
+    DES_BS_WORD t35 = t22 ^ t25;
+    DES_BS_WORD t36 = x3 & t35;
+    DES_BS_WORD t37 = t22 ^ t36;
+    DES_BS_WORD t38 = t17 ^ t28;
+    DES_BS_WORD t39 = x3 & t38;
+    DES_BS_WORD t40 = t17 ^ t39;
+    DES_BS_WORD t41 = t31 ^ t34;
+    DES_BS_WORD t42 = x2 & t41;
+    DES_BS_WORD t43 = t31 ^ t42;
+    DES_BS_WORD t44 = t37 ^ t40;
+    DES_BS_WORD t45 = x2 & t44;
+    DES_BS_WORD t46 = t37 ^ t45;
+    DES_BS_WORD t47 = t43 ^ t46;
+    DES_BS_WORD t48 = x0 & t47;
+    DES_BS_WORD t49 = t43 ^ t48;
+    DES_BS_WORD t50 = ~t14;
+    DES_BS_WORD t51 = t10 ^ t13;
+    DES_BS_WORD t52 = x1 & t51;
+    DES_BS_WORD t53 = t13 ^ t52;
+    DES_BS_WORD t54 = t11 ^ t50;
+    DES_BS_WORD t55 = x1 & t54;
+    DES_BS_WORD t56 = t50 ^ t55;
+    DES_BS_WORD t57 = x1 ^ t6;
+    DES_BS_WORD t58 = t12 ^ t14;
+    DES_BS_WORD t59 = x1 & t58;
+    DES_BS_WORD t60 = t12 ^ t59;
+    DES_BS_WORD t61 = x4 ^ t9;
+    DES_BS_WORD t62 = x1 & t61;
+    DES_BS_WORD t63 = t9 ^ t62;
+    DES_BS_WORD t64 = t11 & ~x1;
+    DES_BS_WORD t65 = t10 ^ t50;
+    DES_BS_WORD t66 = x1 & t65;
+    DES_BS_WORD t67 = t10 ^ t66;
+    DES_BS_WORD t68 = t53 ^ t56;
+    DES_BS_WORD t69 = x3 & t68;
+    DES_BS_WORD t70 = t53 ^ t69;
+    DES_BS_WORD t71 = t57 ^ t60;
+    DES_BS_WORD t72 = x3 & t71;
+    DES_BS_WORD t73 = t57 ^ t72;
+    DES_BS_WORD t74 = t56 ^ t63;
+    DES_BS_WORD t75 = x3 & t74;
+    DES_BS_WORD t76 = t56 ^ t75;
+    DES_BS_WORD t77 = t64 ^ t67;
+    DES_BS_WORD t78 = x3 & t77;
+    DES_BS_WORD t79 = t64 ^ t78;
+    DES_BS_WORD t80 = t70 ^ t73;
+    DES_BS_WORD t81 = x2 & t80;
+    DES_BS_WORD t82 = t70 ^ t81;
+    DES_BS_WORD t83 = t76 ^ t79;
+    DES_BS_WORD t84 = x2 & t83;
+    DES_BS_WORD t85 = t76 ^ t84;
+    DES_BS_WORD t86 = t82 ^ t85;
+    DES_BS_WORD t87 = x0 & t86;
+    DES_BS_WORD t88 = t82 ^ t87;
+    DES_BS_WORD t89 = x1 | t7;
+    DES_BS_WORD t90 = t7 ^ t12;
+    DES_BS_WORD t91 = x1 & t90;
+    DES_BS_WORD t92 = t12 ^ t91;
+    DES_BS_WORD t93 = ~x1;
+    DES_BS_WORD t94 = t6 ^ t9;
+    DES_BS_WORD t95 = x1 & t94;
+    DES_BS_WORD t96 = t9 ^ t95;
+    DES_BS_WORD t97 = t7 ^ t8;
+    DES_BS_WORD t98 = x1 & t97;
+    DES_BS_WORD t99 = t7 ^ t98;
+    DES_BS_WORD t100 = t11 ^ t14;
+    DES_BS_WORD t101 = x1 & t100;
+    DES_BS_WORD t102 = t14 ^ t101;
+    DES_BS_WORD t103 = x1 ^ t13;
+    DES_BS_WORD t104 = t89 ^ t92;
+    DES_BS_WORD t105 = x3 & t104;
+    DES_BS_WORD t106 = t89 ^ t105;
+    DES_BS_WORD t107 = t93 ^ t96;
+    DES_BS_WORD t108 = x3 & t107;
+    DES_BS_WORD t109 = t93 ^ t108;
+    DES_BS_WORD t110 = t92 ^ t99;
+    DES_BS_WORD t111 = x3 & t110;
+    DES_BS_WORD t112 = t92 ^ t111;
+    DES_BS_WORD t113 = t102 ^ t103;
+    DES_BS_WORD t114 = x3 & t113;
+    DES_BS_WORD t115 = t102 ^ t114;
+    DES_BS_WORD t116 = t106 ^ t109;
+    DES_BS_WORD t117 = x2 & t116;
+    DES_BS_WORD t118 = t106 ^ t117;
+    DES_BS_WORD t119 = t112 ^ t115;
+    DES_BS_WORD t120 = x2 & t119;
+    DES_BS_WORD t121 = t112 ^ t120;
+    DES_BS_WORD t122 = t118 ^ t121;
+    DES_BS_WORD t123 = x0 & t122;
+    DES_BS_WORD t124 = t118 ^ t123;
+    DES_BS_WORD t125 = t9 ^ t10;
+    DES_BS_WORD t126 = x1 & t125;
+    DES_BS_WORD t127 = t10 ^ t126;
+    DES_BS_WORD t128 = x1 | t14;
+    DES_BS_WORD t129 = t6 ^ t50;
+    DES_BS_WORD t130 = x1 & t129;
+    DES_BS_WORD t131 = t50 ^ t130;
+    DES_BS_WORD t132 = t6 ^ t130;
+    DES_BS_WORD t133 = x1 & t11;
+    DES_BS_WORD t134 = t7 ^ t9;
+    DES_BS_WORD t135 = x1 & t134;
+    DES_BS_WORD t136 = t7 ^ t135;
+    DES_BS_WORD t137 = t8 ^ t98;
+    DES_BS_WORD t138 = t19 ^ t127;
+    DES_BS_WORD t139 = x3 & t138;
+    DES_BS_WORD t140 = t127 ^ t139;
+    DES_BS_WORD t141 = t128 ^ t131;
+    DES_BS_WORD t142 = x3 & t141;
+    DES_BS_WORD t143 = t128 ^ t142;
+    DES_BS_WORD t144 = t132 ^ t133;
+    DES_BS_WORD t145 = x3 & t144;
+    DES_BS_WORD t146 = t132 ^ t145;
+    DES_BS_WORD t147 = t136 ^ t137;
+    DES_BS_WORD t148 = x3 & t147;
+    DES_BS_WORD t149 = t136 ^ t148;
+    DES_BS_WORD t150 = t140 ^ t143;
+    DES_BS_WORD t151 = x2 & t150;
+    DES_BS_WORD t152 = t140 ^ t151;
+    DES_BS_WORD t153 = t146 ^ t149;
+    DES_BS_WORD t154 = x2 & t153;
+    DES_BS_WORD t155 = t146 ^ t154;
+    DES_BS_WORD t156 = t152 ^ t155;
+    DES_BS_WORD t157 = x0 & t156;
+    DES_BS_WORD t158 = t152 ^ t157;
+    *o0 = t49;
+    *o1 = t88;
+    *o2 = t124;
+    *o3 = t158;
+}
+
+// S2: 138 gates
+static inline void DES_BS_FN(s2)(DES_BS_WORD x0, DES_BS_WORD x1, DES_BS_WORD x2,
+                                 DES_BS_WORD x3, DES_BS_WORD x4, DES_BS_WORD x5,
+                                 DES_BS_WORD *o0, DES_BS_WORD *o1, DES_BS_WORD *o2, DES_BS_WORD *o3) {
+    DES_BS_WORD t6 = x0 ^ x2;
+    DES_BS_WORD t7 = ~t6;
+    DES_BS_WORD t8 = ~x2;
+    DES_BS_WORD t9 = x2 & ~x0;
+    DES_BS_WORD t10 = ~t9;
+    DES_BS_WORD t11 = x0 & ~x2;
+    DES_BS_WORD t12 = ~t11;
+    DES_BS_WORD t15 = t6 ^ t8;
+    DES_BS_WORD t16 = x3 & t15;
+    DES_BS_WORD t17 = t6 ^ t16;
+    DES_BS_WORD t18 = x3 ^ t10;
+    DES_BS_WORD t19 = x3 ^ t12;
+    DES_BS_WORD t20 = x3 ^ t8;
+    DES_BS_WORD t21 = x3 ^ t11;
+    DES_BS_WORD t22 = x3 ^ t9;
+    DES_BS_WORD t23 = x5 ^ t7;
+    DES_BS_WORD t24 = t17 ^ t18;
+    DES_BS_WORD t25 = x5 & t24;
+    DES_BS_WORD t26 = t17 ^ t25;
+    DES_BS_WORD t27 = t19 ^ t20;
+    DES_BS_WORD t28 = x5 & t27;
+    DES_BS_WORD t29 = t19 ^ t28;
+    DES_BS_WORD t30 = t21 ^ t22;
+    DES_BS_WORD t31 = x5 & t30;
+    DES_BS_WORD t32 = t21 ^ t31;
+    DES_BS_WORD t33 = t23 ^ t26;
+    DES_BS_WORD t34 = x4 & t33;
+    DES_BS_WORD t35 = t23 ^ t34;
+    DES_BS_WORD t36 = t29 ^ t32;
+    DES_BS_WORD t37 = x4 & t36;
+    DES_BS_WORD t38 = t29 ^ t37;
+    DES_BS_WORD t39 = t35 ^ t38;
+    DES_BS_WORD t40 = x1 & t39;
+    DES_BS_WORD t41 = t35 ^ t40;
+    DES_BS_WORD t42 = ~x0;
+    DES_BS_WORD t43 = x0 | x2;
+    DES_BS_WORD t44 = ~t43;
+    DES_BS_WORD t45 = x3 ^ t42;
+    DES_BS_WORD t46 = x3 ^ t6;
+    DES_BS_WORD t47 = x0 ^ x3;
+    DES_BS_WORD t48 = t7 ^ t42;
+    DES_BS_WORD t49 = x3 & t48;
+    DES_BS_WORD t50 = t7 ^ t49;
+    DES_BS_WORD t51 = t10 ^ t44;
+    DES_BS_WORD t52 = x3 & t51;
+    DES_BS_WORD t53 = t44 ^ t52;
+    DES_BS_WORD t54 = x0 ^ t6;
+    DES_BS_WORD t55 = x3 & t54;
+    DES_BS_WORD t56 = x0 ^ t55;
+    DES_BS_WORD t57 = t45 ^ t46;
+    DES_BS_WORD t58 = x5 & t57;
+    DES_BS_WORD t59 = t45 ^ t58;
+    DES_BS_WORD t60 = t47 ^ t50;
+    DES_BS_WORD t61 = x5 & t60;
+    DES_BS_WORD t62 = t47 ^ t61;
+    DES_BS_WORD t63 = t6 ^ t45;
+    DES_BS_WORD t64 = x5 & t63;
+    DES_BS_WORD t65 = t6 ^ t64;
+    DES_BS_WORD t66 = t53 ^ t56;
+    DES_BS_WORD t67 = x5 & t66;
+    DES_BS_WORD t68 = t53 ^ t67;
+    DES_BS_WORD t69 = t59 ^ t62;
+    DES_BS_WORD t70 = x4 & t69;
+    DES_BS_WORD t71 = t59 ^ t70;
+    DES_BS_WORD t72 = t65 ^ t68;
+    DES_BS_WORD t73 = x4 & t72;
+    DES_BS_WORD t74 = t65 ^ t73;
+    DES_BS_WORD t75 = t71 ^ t74;
+    DES_BS_WORD t76 = x1 & t75;
+    DES_BS_WORD t77 = t71 ^ t76;
+    DES_BS_WORD t78 = t6 ^ t12;
+    DES_BS_WORD t79 = x3 & t78;
+    DES_BS_WORD t80 = t12 ^ t79;
+    DES_BS_WORD t81 = x2 ^ t12;
+    DES_BS_WORD t82 = x3 & t81;
+    DES_BS_WORD t83 = x2 ^ t82;
+    DES_BS_WORD t84 = x3 & t7;
+    DES_BS_WORD t85 = t6 ^ t43;
+    DES_BS_WORD t86 = x3 & t85;
+    DES_BS_WORD t87 = t6 ^ t86;
+    DES_BS_WORD t88 = t7 ^ t43;
+    DES_BS_WORD t89 = x3 & t88;
+    DES_BS_WORD t90 = t7 ^ t89;
+    DES_BS_WORD t91 = t11 ^ t44;
+    DES_BS_WORD t92 = x3 & t91;
+    DES_BS_WORD t93 = t11 ^ t92;
+    DES_BS_WORD t94 = t19 ^ t80;
+    DES_BS_WORD t95 = x5 & t94;
+    DES_BS_WORD t96 = t80 ^ t95;
+    DES_BS_WORD t97 = t17 ^ t83;
+    DES_BS_WORD t98 = x5 & t97;
+    DES_BS_WORD t99 = t17 ^ t98;
+    DES_BS_WORD t100 = t84 ^ t87;
+    DES_BS_WORD t101 = x5 & t100;
+    DES_BS_WORD t102 = t84 ^ t101;
+    DES_BS_WORD t103 = t90 ^ t93;
+    DES_BS_WORD t104 = x5 & t103;
+    DES_BS_WORD t105 = t90 ^ t104;
+    DES_BS_WORD t106 = t96 ^ t99;
+    DES_BS_WORD t107 = x4 & t106;
+    DES_BS_WORD t108 = t96 ^ t107;
+    DES_BS_WORD t109 = t102 ^ t105;
+    DES_BS_WORD t110 = x4 & t109;
+    DES_BS_WORD t111 = t102 ^ t110;
+    DES_BS_WORD t112 = t108 ^ t111;
+    DES_BS_WORD t113 = x1 & t112;
+    DES_BS_WORD t114 = t108 ^ t113;
+    DES_BS_WORD t115 = x0 & x2;
+    DES_BS_WORD t116 = ~t115;
+    DES_BS_WORD t117 = x3 ^ t44;
+    DES_BS_WORD t118 = ~x3;
+    DES_BS_WORD t119 = t7 ^ t8;
+    DES_BS_WORD t120 = x3 & t119;
+    DES_BS_WORD t121 = t7 ^ t120;
+    DES_BS_WORD t122 = t11 ^ t116;
+    DES_BS_WORD t123 = x3 & t122;
+    DES_BS_WORD t124 = t11 ^ t123;
+    DES_BS_WORD t125 = t117 ^ t118;
+    DES_BS_WORD t126 = x5 & t125;
+    DES_BS_WORD t127 = t117 ^ t126;
+    DES_BS_WORD t128 = t45 ^ t121;
+    DES_BS_WORD t129 = x5 & t128;
+    DES_BS_WORD t130 = t45 ^ t129;
+    DES_BS_WORD t131 = t18 ^ t124;
+    DES_BS_WORD t132 = x5 & t131;
+    DES_BS_WORD t133 = t18 ^ t132;
+    DES_BS_WORD t134 = x2 ^ t7;
+    DES_BS_WORD t135 = x5 & t134;
+    DES_BS_WORD t136 = t7 ^ t135;
+    DES_BS_WORD t137 = t127 ^ t130;
+    DES_BS_WORD t138 = x4 & t137;
+    DES_BS_WORD t139 = t127 ^ t138;
+    DES_BS_WORD t140 = t133 ^ t136;
+    DES_BS_WORD t141 = x4 & t140;
+    DES_BS_WORD t142 = t133 ^ t141;
+    DES_BS_WORD t143 = t139 ^ t142;
+    DES_BS_WORD t144 = x1 & t143;
+    DES_BS_WORD t145 = t139 ^ t144;
+    *o0 = t41;
+    *o1 = t77;
+    *o2 = t114;
+    *o3 = t145;
+}
+
+// S3: 138 gates
+static inline void DES_BS_FN(s3)(DES_BS_WORD x0, DES_BS_WORD x1, DES_BS_WORD x2,
+                                 DES_BS_WORD x3, DES_BS_WORD x4, DES_BS_WORD x5,
+                                 DES_BS_WORD *o0, DES_BS_WORD *o1, DES_BS_WORD *o2, DES_BS_WORD *o3) {
+    DES_BS_WORD t6 = x3 & x5;
+    DES_BS_WORD t7 = ~t6;
+    DES_BS_WORD t8 = x3 & ~x5;
+    DES_BS_WORD t9 = ~t8;
+    DES_BS_WORD t10 = x3 ^ x5;
+    DES_BS_WORD t11 = ~t10;
+    DES_BS_WORD t12 = ~x3;
+    DES_BS_WORD t15 = t7 ^ t8;
+    DES_BS_WORD t16 = x2 & t15;
+    DES_BS_WORD t17 = t7 ^ t16;
+    DES_BS_WORD t18 = x2 ^ t8;
+    DES_BS_WORD t19 = x3 ^ t6;
+    DES_BS_WORD t20 = x2 & t19;
+    DES_BS_WORD t21 = x3 ^ t20;
+    DES_BS_WORD t22 = t9 ^ t10;
+    DES_BS_WORD t23 = x2 & t22;
+    DES_BS_WORD t24 = t9 ^ t23;
+    DES_BS_WORD t25 = x2 ^ t11;
+    DES_BS_WORD t26 = t10 ^ t12;
+    DES_BS_WORD t27 = x2 & t26;
+    DES_BS_WORD t28 = t10 ^ t27;
+    DES_BS_WORD t29 = x2 ^ t10;
+    DES_BS_WORD t30 = t17 ^ t18;
+    DES_BS_WORD t31 = x1 & t30;
+    DES_BS_WORD t32 = t17 ^ t31;
+    DES_BS_WORD t33 = t21 ^ t24;
+    DES_BS_WORD t34 = x1 & t33;
+    DES_BS_WORD t35 = t21 ^ t34;
+    DES_BS_WORD t36 = t11 ^ t25;
+    DES_BS_WORD t37 = x1 & t36;
+    DES_BS_WORD t38 = t11 ^ t37;
+    DES_BS_WORD t39 = t28 ^ t29;
+    DES_BS_WORD t40 = x1 & t39;
+    DES_BS_WORD t41 = t28 ^ t40;
+    DES_BS_WORD t42 = t32 ^ t35;
+    DES_BS_WORD t43 = x4 & t42;
+    DES_BS_WORD t44 = t32 ^ t43;
+    DES_BS_WORD t45 = t38 ^ t41;
+    DES_BS_WORD t46 = x4 & t45;
+    DES_BS_WORD t47 = t38 ^ t46;
+    DES_BS_WORD t48 = t44 ^ t47;
+    DES_BS_WORD t49 = x0 & t48;
+    DES_BS_WORD t50 = t44 ^ t49;
+    DES_BS_WORD t51 = x5 & ~x3;
+    DES_BS_WORD t52 = ~t51;
+    DES_BS_WORD t53 = x3 | x5;
+    DES_BS_WORD t54 = ~t53;
+    DES_BS_WORD t55 = ~x5;
+    DES_BS_WORD t56 = x2 ^ t51;
+    DES_BS_WORD t57 = x2 & t10;
+    DES_BS_WORD t58 = x3 ^ t57;
+    DES_BS_WORD t59 = t52 ^ t54;
+    DES_BS_WORD t60 = x2 & t59;
+    DES_BS_WORD t61 = t52 ^ t60;
+    DES_BS_WORD t62 = x2 ^ t52;
+    DES_BS_WORD t63 = x2 ^ x5;
+    DES_BS_WORD t64 = t11 ^ t54;
+    DES_BS_WORD t65 = x2 & t64;
+    DES_BS_WORD t66 = t54 ^ t65;
+    DES_BS_WORD t67 = t10 ^ t53;
+    DES_BS_WORD t68 = x2 & t67;
+    DES_BS_WORD t69 = t10 ^ t68;
+    DES_BS_WORD t70 = t56 ^ t58;
+    DES_BS_WORD t71 = x1 & t70;
+    DES_BS_WORD t72 = t56 ^ t71;
+    DES_BS_WORD t73 = t10 ^ t61;
+    DES_BS_WORD t74 = x1 & t73;
+    DES_BS_WORD t75 = t10 ^ t74;
+    DES_BS_WORD t76 = t62 ^ t63;
+    DES_BS_WORD t77 = x1 & t76;
+    DES_BS_WORD t78 = t62 ^ t77;
+    DES_BS_WORD t79 = t66 ^ t69;
+    DES_BS_WORD t80 = x1 & t79;
+    DES_BS_WORD t81 = t66 ^ t80;
+    DES_BS_WORD t82 = t72 ^ t75;
+    DES_BS_WORD t83 = x4 & t82;
+    DES_BS_WORD t84 = t72 ^ t83;
+    DES_BS_WORD t85 = t78 ^ t81;
+    DES_BS_WORD t86 = x4 & t85;
+    DES_BS_WORD t87 = t78 ^ t86;
+    DES_BS_WORD t88 = t84 ^ t87;
+    DES_BS_WORD t89 = x0 & t88;
+    DES_BS_WORD t90 = t84 ^ t89;
+    DES_BS_WORD t91 = x2 | t54;
+    DES_BS_WORD t92 = x3 ^ t51;
+    DES_BS_WORD t93 = x2 & t92;
+    DES_BS_WORD t94 = x3 ^ t93;
+    DES_BS_WORD t95 = t52 ^ t53;
+    DES_BS_WORD t96 = x2 & t95;
+    DES_BS_WORD t97 = t52 ^ t96;
+    DES_BS_WORD t98 = t11 ^ t12;
+    DES_BS_WORD t99 = x2 & t98;
+    DES_BS_WORD t100 = t12 ^ t99;
+    DES_BS_WORD t101 = t56 ^ t91;
+    DES_BS_WORD t102 = x1 & t101;
+    DES_BS_WORD t103 = t91 ^ t102;
+    DES_BS_WORD t104 = t29 ^ t94;
+    DES_BS_WORD t105 = x1 & t104;
+    DES_BS_WORD t106 = t29 ^ t105;
+    DES_BS_WORD t107 = t57 ^ t97;
+    DES_BS_WORD t108 = x1 & t107;
+    DES_BS_WORD t109 = t57 ^ t108;
+    DES_BS_WORD t110 = t63 ^ t100;
+    DES_BS_WORD t111 = x1 & t110;
+    DES_BS_WORD t112 = t100 ^ t111;
+    DES_BS_WORD t113 = t103 ^ t106;
+    DES_BS_WORD t114 = x4 & t113;
+    DES_BS_WORD t115 = t103 ^ t114;
+    DES_BS_WORD t116 = t109 ^ t112;
+    DES_BS_WORD t117 = x4 & t116;
+    DES_BS_WORD t118 = t109 ^ t117;
+    DES_BS_WORD t119 = t115 ^ t118;
+    DES_BS_WORD t120 = x0 & t119;
+    DES_BS_WORD t121 = t115 ^ t120;
+    DES_BS_WORD t122 = x2 ^ t55;
+    DES_BS_WORD t123 = x2 ^ t9;
+    DES_BS_WORD t124 = t12 ^ t54;
+    DES_BS_WORD t125 = x2 & t124;
+    DES_BS_WORD t126 = t54 ^ t125;
+    DES_BS_WORD t127 = x1 ^ t10;
+    DES_BS_WORD t128 = t63 ^ t122;
+    DES_BS_WORD t129 = x1 & t128;
+    DES_BS_WORD t130 = t63 ^ t129;
+    DES_BS_WORD t131 = t123 ^ t126;
+    DES_BS_WORD t132 = x1 & t131;
+    DES_BS_WORD t133 = t123 ^ t132;
+    DES_BS_WORD t134 = t18 ^ t24;
+    DES_BS_WORD t135 = x1 & t134;
+    DES_BS_WORD t136 = t18 ^ t135;
+    DES_BS_WORD t137 = t127 ^ t130;
+    DES_BS_WORD t138 = x4 & t137;
+    DES_BS_WORD t139 = t127 ^ t138;
+    DES_BS_WORD t140 = t133 ^ t136;
+    DES_BS_WORD t141 = x4 & t140;
+    DES_BS_WORD t142 = t133 ^ t141;
+    DES_BS_WORD t143 = t139 ^ t142;
+    DES_BS_WORD t144 = x0 & t143;
+    DES_BS_WORD t145 = t139 ^ t144;
+    *o0 = t50;
+    *o1 = t90;
+    *o2 = t121;
+    *o3 = t145;
+}
+
+// S4: 123 gates
+static inline void DES_BS_FN(s4)(DES_BS_WORD x0, DES_BS_WORD x1, DES_BS_WORD x2,
+                                 DES_BS_WORD x3, DES_BS_WORD x4, DES_BS_WORD x5,
+                                 DES_BS_WORD *o0, DES_BS_WORD *o1, DES_BS_WORD *o2, DES_BS_WORD *o3) {
+    DES_BS_WORD t6 = x0 & x2;
+    DES_BS_WORD t7 = ~t6;
+    DES_BS_WORD t8 = x0 ^ x2;
+    DES_BS_WORD t9 = ~t8;
+    DES_BS_WORD t10 = x2 & ~x0;
+    DES_BS_WORD t13 = x0 ^ t7;
+    DES_BS_WORD t14 = x3 & t13;
+    DES_BS_WORD t15 = x0 ^ t14;
+    DES_BS_WORD t16 = x2 ^ t9;
+    DES_BS_WORD t17 = x3 & t16;
+    DES_BS_WORD t18 = t9 ^ t17;
+    DES_BS_WORD t19 = x3 ^ t8;
+    DES_BS_WORD t20 = t8 ^ t10;
+    DES_BS_WORD t21 = x3 & t20;
+    DES_BS_WORD t22 = t10 ^ t21;
+    DES_BS_WORD t23 = x3 ^ t7;
+    DES_BS_WORD t24 = x0 ^ t10;
+    DES_BS_WORD t25 = x3 & t24;
+    DES_BS_WORD t26 = x0 ^ t25;
+    DES_BS_WORD t27 = x3 | t10;
+    DES_BS_WORD t28 = t15 ^ t18;
+    DES_BS_WORD t29 = x4 & t28;
+    DES_BS_WORD t30 = t15 ^ t29;
+    DES_BS_WORD t31 = t19 ^ t22;
+    DES_BS_WORD t32 = x4 & t31;
+    DES_BS_WORD t33 = t19 ^ t32;
+    DES_BS_WORD t34 = t9 ^ t23;
+    DES_BS_WORD t35 = x4 & t34;
+    DES_BS_WORD t36 = t9 ^ t35;
+    DES_BS_WORD t37 = t26 ^ t27;
+    DES_BS_WORD t38 = x4 & t37;
+    DES_BS_WORD t39 = t26 ^ t38;
+    DES_BS_WORD t40 = t30 ^ t33;
+    DES_BS_WORD t41 = x1 & t40;
+    DES_BS_WORD t42 = t30 ^ t41;
+    DES_BS_WORD t43 = t36 ^ t39;
+    DES_BS_WORD t44 = x1 & t43;
+    DES_BS_WORD t45 = t36 ^ t44;
+    DES_BS_WORD t46 = t42 ^ t45;
+    DES_BS_WORD t47 = x5 & t46;
+    DES_BS_WORD t48 = t42 ^ t47;
+    DES_BS_WORD t49 = ~x0;
+    DES_BS_WORD t50 = ~x2;
+    DES_BS_WORD t51 = ~t10;
+    DES_BS_WORD t52 = t6 ^ t49;
+    DES_BS_WORD t53 = x3 & t52;
+    DES_BS_WORD t54 = t49 ^ t53;
+    DES_BS_WORD t55 = t8 ^ t50;
+    DES_BS_WORD t56 = x3 & t55;
+    DES_BS_WORD t57 = t8 ^ t56;
+    DES_BS_WORD t58 = x3 ^ t9;
+    DES_BS_WORD t59 = t9 ^ t51;
+    DES_BS_WORD t60 = x3 & t59;
+    DES_BS_WORD t61 = t51 ^ t60;
+    DES_BS_WORD t62 = t54 ^ t57;
+    DES_BS_WORD t63 = x4 & t62;
+    DES_BS_WORD t64 = t54 ^ t63;
+    DES_BS_WORD t65 = t58 ^ t61;
+    DES_BS_WORD t66 = x4 & t65;
+    DES_BS_WORD t67 = t58 ^ t66;
+    DES_BS_WORD t68 = t64 ^ t67;
+    DES_BS_WORD t69 = x1 & t68;
+    DES_BS_WORD t70 = t64 ^ t69;
+    DES_BS_WORD t71 = t45 ^ t70;
+    DES_BS_WORD t72 = x5 & t71;
+    DES_BS_WORD t73 = t45 ^ t72;
+    DES_BS_WORD t74 = x0 | x2;
+    DES_BS_WORD t75 = x0 & ~x2;
+    DES_BS_WORD t76 = ~t74;
+    DES_BS_WORD t77 = ~t75;
+    DES_BS_WORD t78 = t9 ^ t50;
+    DES_BS_WORD t79 = x3 & t78;
+    DES_BS_WORD t80 = t50 ^ t79;
+    DES_BS_WORD t81 = t49 ^ t74;
+    DES_BS_WORD t82 = x3 & t81;
+    DES_BS_WORD t83 = t74 ^ t82;
+    DES_BS_WORD t84 = t8 ^ t75;
+    DES_BS_WORD t85 = x3 & t84;
+    DES_BS_WORD t86 = t8 ^ t85;
+    DES_BS_WORD t87 = x3 ^ t74;
+    DES_BS_WORD t88 = x3 & t77;
+    DES_BS_WORD t89 = x0 ^ t77;
+    DES_BS_WORD t90 = x3 & t89;
+    DES_BS_WORD t91 = t77 ^ t90;
+    DES_BS_WORD t92 = t80 ^ t83;
+    DES_BS_WORD t93 = x4 & t92;
+    DES_BS_WORD t94 = t80 ^ t93;
+    DES_BS_WORD t95 = t58 ^ t86;
+    DES_BS_WORD t96 = x4 & t95;
+    DES_BS_WORD t97 = t86 ^ t96;
+    DES_BS_WORD t98 = t8 ^ t87;
+    DES_BS_WORD t99 = x4 & t98;
+    DES_BS_WORD t100 = t87 ^ t99;
+    DES_BS_WORD t101 = t88 ^ t91;
+    DES_BS_WORD t102 = x4 & t101;
+    DES_BS_WORD t103 = t88 ^ t102;
+    DES_BS_WORD t104 = t94 ^ t97;
+    DES_BS_WORD t105 = x1 & t104;
+    DES_BS_WORD t106 = t94 ^ t105;
+    DES_BS_WORD t107 = t100 ^ t103;
+    DES_BS_WORD t108 = x1 & t107;
+    DES_BS_WORD t109 = t100 ^ t108;
+    DES_BS_WORD t110 = t106 ^ t109;
+    DES_BS_WORD t111 = x5 & t110;
+    DES_BS_WORD t112 = t106 ^ t111;
+    DES_BS_WORD t113 = x3 ^ t76;
+    DES_BS_WORD t114 = x3 & ~t75;
+    DES_BS_WORD t115 = ~t114;
+    DES_BS_WORD t116 = t49 ^ t75;
+    DES_BS_WORD t117 = x3 & t116;
+    DES_BS_WORD t118 = t75 ^ t117;
+    DES_BS_WORD t119 = t9 ^ t113;
+    DES_BS_WORD t120 = x4 & t119;
+    DES_BS_WORD t121 = t113 ^ t120;
+    DES_BS_WORD t122 = t115 ^ t118;
+    DES_BS_WORD t123 = x4 & t122;
+    DES_BS_WORD t124 = t115 ^ t123;
+    DES_BS_WORD t125 = t121 ^ t124;
+    DES_BS_WORD t126 = x1 & t125;
+    DES_BS_WORD t127 = t121 ^ t126;
+    DES_BS_WORD t128 = t106 ^ t127;
+    DES_BS_WORD t129 = x5 & t128;
+    DES_BS_WORD t130 = t127 ^ t129;
+    *o0 = t48;
+    *o1 = t73;
+    *o2 = t112;
+    *o3 = t130;
+}
+
+// S5: 151 gates
+static inline void DES_BS_FN(s5)(DES_BS_WORD x0, DES_BS_WORD x1, DES_BS_WORD x2,
+                                 DES_BS_WORD x3, DES_BS_WORD x4, DES_BS_WORD x5,
+                                 DES_BS_WORD *o0, DES_BS_WORD *o1, DES_BS_WORD *o2, DES_BS_WORD *o3) {
+    DES_BS_WORD t6 = ~x5;
+    DES_BS_WORD t7 = x0 & ~x5;
+    DES_BS_WORD t8 = ~t7;
+    DES_BS_WORD t9 = x0 & x5;
+    DES_BS_WORD t10 = x0 ^ x5;
+    DES_BS_WORD t11 = ~t10;
+    DES_BS_WORD t12 = x5 & ~x0;
+    DES_BS_WORD t13 = ~t12;
+    DES_BS_WORD t14 = ~x0;
+    DES_BS_WORD t17 = x1 ^ x5;
+    DES_BS_WORD t18 = x0 ^ t8;
+    DES_BS_WORD t19 = x1 & t18;
+    DES_BS_WORD t20 = t8 ^ t19;
+    DES_BS_WORD t21 = t9 ^ t10;
+    DES_BS_WORD t22 = x1 & t21;
+    DES_BS_WORD t23 = t9 ^ t22;
+    DES_BS_WORD t24 = t8 ^ t10;
+    DES_BS_WORD t25 = x1 & t24;
+    DES_BS_WORD t26 = t10 ^ t25;
+    DES_BS_WORD t27 = t7 ^ t11;
+    DES_BS_WORD t28 = x1 & t27;
+    DES_BS_WORD t29 = t7 ^ t28;
+    DES_BS_WORD t30 = x1 ^ t13;
+    DES_BS_WORD t31 = x0 ^ t6;
+    DES_BS_WORD t32 = x1 & t31;
+    DES_BS_WORD t33 = x0 ^ t32;
+    DES_BS_WORD t34 = t17 ^ t20;
+    DES_BS_WORD t35 = x4 & t34;
+    DES_BS_WORD t36 = t17 ^ t35;
+    DES_BS_WORD t37 = t23 ^ t26;
+    DES_BS_WORD t38 = x4 & t37;
+    DES_BS_WORD t39 = t23 ^ t38;
+    DES_BS_WORD t40 = t29 ^ t30;
+    DES_BS_WORD t41 = x4 & t40;
+    DES_BS_WORD t42 = t29 ^ t41;
+    DES_BS_WORD t43 = t14 ^ t33;
+    DES_BS_WORD t44 = x4 & t43;
+    DES_BS_WORD t45 = t14 ^ t44;
+    DES_BS_WORD t46 = t36 ^ t39;
+    DES_BS_WORD t47 = x3 & t46;
+    DES_BS_WORD t48 = t36 ^ t47;
+    DES_BS_WORD t49 = t42 ^ t45;
+    DES_BS_WORD t50 = x3 & t49;
+    DES_BS_WORD t51 = t42 ^ t50;
+    DES_BS_WORD t52 = t48 ^ t51;
+    DES_BS_WORD t53 = x2 & t52;
+    DES_BS_WORD t54 = t48 ^ t53;
+    DES_BS_WORD t55 = x0 | x5;
+    DES_BS_WORD t56 = ~t55;
+    DES_BS_WORD t57 = t10 ^ t55;
+    DES_BS_WORD t58 = x1 & t57;
+    DES_BS_WORD t59 = t10 ^ t58;
+    DES_BS_WORD t60 = t11 ^ t56;
+    DES_BS_WORD t61 = x1 & t60;
+    DES_BS_WORD t62 = t56 ^ t61;
+    DES_BS_WORD t63 = x1 ^ t11;
+    DES_BS_WORD t64 = t6 ^ t14;
+    DES_BS_WORD t65 = x1 & t64;
+    DES_BS_WORD t66 = t14 ^ t65;
+    DES_BS_WORD t67 = t9 ^ t55;
+    DES_BS_WORD t68 = x1 & t67;
+    DES_BS_WORD t69 = t55 ^ t68;
+    DES_BS_WORD t70 = x1 ^ t10;
+    DES_BS_WORD t71 = t59 ^ t62;
+    DES_BS_WORD t72 = x4 & t71;
+    DES_BS_WORD t73 = t59 ^ t72;
+    DES_BS_WORD t74 = t17 ^ t63;
+    DES_BS_WORD t75 = x4 & t74;
+    DES_BS_WORD t76 = t63 ^ t75;
+    DES_BS_WORD t77 = t66 ^ t69;
+    DES_BS_WORD t78 = x4 & t77;
+    DES_BS_WORD t79 = t66 ^ t78;
+    DES_BS_WORD t80 = t63 ^ t70;
+    DES_BS_WORD t81 = x4 & t80;
+    DES_BS_WORD t82 = t70 ^ t81;
+    DES_BS_WORD t83 = t73 ^ t76;
+    DES_BS_WORD t84 = x3 & t83;
+    DES_BS_WORD t85 = t73 ^ t84;
+    DES_BS_WORD t86 = t79 ^ t82;
+    DES_BS_WORD t87 = x3 & t86;
+    DES_BS_WORD t88 = t79 ^ t87;
+    DES_BS_WORD t89 = t85 ^ t88;
+    DES_BS_WORD t90 = x2 & t89;
+    DES_BS_WORD t91 = t85 ^ t90;
+    DES_BS_WORD t92 = t10 ^ t22;
+    DES_BS_WORD t93 = t12 ^ t14;
+    DES_BS_WORD t94 = x1 & t93;
+    DES_BS_WORD t95 = t12 ^ t94;
+    DES_BS_WORD t96 = x0 ^ x1;
+    DES_BS_WORD t97 = t6 ^ t55;
+    DES_BS_WORD t98 = x1 & t97;
+    DES_BS_WORD t99 = t6 ^ t98;
+    DES_BS_WORD t100 = x1 ^ t8;
+    DES_BS_WORD t101 = t13 ^ t56;
+    DES_BS_WORD t102 = x1 & t101;
+    DES_BS_WORD t103 = t13 ^ t102;
+    DES_BS_WORD t104 = x1 ^ t56;
+    DES_BS_WORD t105 = t20 ^ t92;
+    DES_BS_WORD t106 = x4 & t105;
+    DES_BS_WORD t107 = t20 ^ t106;
+    DES_BS_WORD t108 = t95 ^ t96;
+    DES_BS_WORD t109 = x4 & t108;
+    DES_BS_WORD t110 = t95 ^ t109;
+    DES_BS_WORD t111 = t99 ^ t100;
+    DES_BS_WORD t112 = x4 & t111;
+    DES_BS_WORD t113 = t99 ^ t112;
+    DES_BS_WORD t114 = t103 ^ t104;
+    DES_BS_WORD t115 = x4 & t114;
+    DES_BS_WORD t116 = t103 ^ t115;
+    DES_BS_WORD t117 = t107 ^ t110;
+    DES_BS_WORD t118 = x3 & t117;
+    DES_BS_WORD t119 = t107 ^ t118;
+    DES_BS_WORD t120 = t113 ^ t116;
+    DES_BS_WORD t121 = x3 & t120;
+    DES_BS_WORD t122 = t113 ^ t121;
+    DES_BS_WORD t123 = t119 ^ t122;
+    DES_BS_WORD t124 = x2 & t123;
+    DES_BS_WORD t125 = t119 ^ t124;
+    DES_BS_WORD t126 = ~t9;
+    DES_BS_WORD t127 = x1 ^ t12;
+    DES_BS_WORD t128 = t7 ^ t14;
+    DES_BS_WORD t129 = x1 & t128;
+    DES_BS_WORD t130 = t7 ^ t129;
+    DES_BS_WORD t131 = t11 ^ t14;
+    DES_BS_WORD t132 = x1 & t131;
+    DES_BS_WORD t133 = t11 ^ t132;
+    DES_BS_WORD t134 = x1 ^ t126;
+    DES_BS_WORD t135 = x5 ^ t11;
+    DES_BS_WORD t136 = x1 & t135;
+    DES_BS_WORD t137 = x5 ^ t136;
+    DES_BS_WORD t138 = t23 ^ t127;
+    DES_BS_WORD t139 = x4 & t138;
+    DES_BS_WORD t140 = t23 ^ t139;
+    DES_BS_WORD t141 = t13 ^ t130;
+    DES_BS_WORD t142 = x4 & t141;
+    DES_BS_WORD t143 = t130 ^ t142;
+    DES_BS_WORD t144 = t10 ^ t133;
+    DES_BS_WORD t145 = x4 & t144;
+    DES_BS_WORD t146 = t133 ^ t145;
+    DES_BS_WORD t147 = t134 ^ t137;
+    DES_BS_WORD t148 = x4 & t147;
+    DES_BS_WORD t149 = t134 ^ t148;
+    DES_BS_WORD t150 = t140 ^ t143;
+    DES_BS_WORD t151 = x3 & t150;
+    DES_BS_WORD t152 = t140 ^ t151;
+    DES_BS_WORD t153 = t146 ^ t149;
+    DES_BS_WORD t154 = x3 & t153;
+    DES_BS_WORD t155 = t146 ^ t154;
+    DES_BS_WORD t156 = t152 ^ t155;
+    DES_BS_WORD t157 = x2 & t156;
+    DES_BS_WORD t158 = t152 ^ t157;
+    *o0 = t54;
+    *o1 = t91;
+    *o2 = t125;
+    *o3 = t158;
+}
+
+// S6: 145 gates
+static inline void DES_BS_FN(s6)(DES_BS_WORD x0, DES_BS_WORD x1, DES_BS_WORD x2,
+                                 DES_BS_WORD x3, DES_BS_WORD x4, DES_BS_WORD x5,
+                                 DES_BS_WORD *o0, DES_BS_WORD *o1, DES_BS_WORD *o2, DES_BS_WORD *o3) {
+    DES_BS_WORD t6 = ~x1;
+    DES_BS_WORD t7 = x1 ^ x5;
+    DES_BS_WORD t8 = ~t7;
+    DES_BS_WORD t9 = ~x5;
+    DES_BS_WORD t10 = x5 & ~x1;
+    DES_BS_WORD t11 = ~t10;
+    DES_BS_WORD t12 = x1 | x5;
+    DES_BS_WORD t13 = ~t12;
+    DES_BS_WORD t16 = t6 ^ t7;
+    DES_BS_WORD t17 = x4 & t16;
+    DES_BS_WORD t18 = t6 ^ t17;
+    DES_BS_WORD t19 = x4 ^ t9;
+    DES_BS_WORD t20 = x4 ^ t10;
+    DES_BS_WORD t21 = t7 ^ t13;
+    DES_BS_WORD t22 = x4 & t21;
+    DES_BS_WORD t23 = t13 ^ t22;
+    DES_BS_WORD t24 = t9 ^ t10;
+    DES_BS_WORD t25 = x4 & t24;
+    DES_BS_WORD t26 = t10 ^ t25;
+    DES_BS_WORD t27 = x4 & ~x5;
+    DES_BS_WORD t28 = ~t27;
+    DES_BS_WORD t29 = t8 ^ t18;
+    DES_BS_WORD t30 = x3 & t29;
+    DES_BS_WORD t31 = t18 ^ t30;
+    DES_BS_WORD t32 = t19 ^ t20;
+    DES_BS_WORD t33 = x3 & t32;
+    DES_BS_WORD t34 = t19 ^ t33;
+    DES_BS_WORD t35 = t8 ^ t23;
+    DES_BS_WORD t36 = x3 & t35;
+    DES_BS_WORD t37 = t8 ^ t36;
+    DES_BS_WORD t38 = t26 ^ t28;
+    DES_BS_WORD t39 = x3 & t38;
+    DES_BS_WORD t40 = t26 ^ t39;
+    DES_BS_WORD t41 = t31 ^ t34;
+    DES_BS_WORD t42 = x2 & t41;
+    DES_BS_WORD t43 = t31 ^ t42;
+    DES_BS_WORD t44 = t37 ^ t40;
+    DES_BS_WORD t45 = x2 & t44;
+    DES_BS_WORD t46 = t37 ^ t45;
+    DES_BS_WORD t47 = t43 ^ t46;
+    DES_BS_WORD t48 = x0 & t47;
+    DES_BS_WORD t49 = t43 ^ t48;
+    DES_BS_WORD t50 = x1 & ~x5;
+    DES_BS_WORD t51 = ~t50;
+    DES_BS_WORD t52 = x1 & x5;
+    DES_BS_WORD t53 = x4 ^ t8;
+    DES_BS_WORD t54 = x5 ^ t11;
+    DES_BS_WORD t55 = x4 & t54;
+    DES_BS_WORD t56 = x5 ^ t55;
+    DES_BS_WORD t57 = t9 ^ t25;
+    DES_BS_WORD t58 = x4 ^ t7;
+    DES_BS_WORD t59 = t9 ^ t51;
+    DES_BS_WORD t60 = x4 & t59;
+    DES_BS_WORD t61 = t9 ^ t60;
+    DES_BS_WORD t62 = t7 ^ t52;
+    DES_BS_WORD t63 = x4 & t62;
+    DES_BS_WORD t64 = t52 ^ t63;
+    DES_BS_WORD t65 = x4 ^ t6;
+    DES_BS_WORD t66 = t53 ^ t56;
+    DES_BS_WORD t67 = x3 & t66;
+    DES_BS_WORD t68 = t53 ^ t67;
+    DES_BS_WORD t69 = t7 ^ t57;
+    DES_BS_WORD t70 = x3 & t69;
+    DES_BS_WORD t71 = t7 ^ t70;
+    DES_BS_WORD t72 = t58 ^ t61;
+    DES_BS_WORD t73 = x3 & t72;
+    DES_BS_WORD t74 = t58 ^ t73;
+    DES_BS_WORD t75 = t64 ^ t65;
+    DES_BS_WORD t76 = x3 & t75;
+    DES_BS_WORD t77 = t64 ^ t76;
+    DES_BS_WORD t78 = t68 ^ t71;
+    DES_BS_WORD t79 = x2 & t78;
+    DES_BS_WORD t80 = t68 ^ t79;
+    DES_BS_WORD t81 = t74 ^ t77;
+    DES_BS_WORD t82 = x2 & t81;
+    DES_BS_WORD t83 = t74 ^ t82;
+    DES_BS_WORD t84 = t80 ^ t83;
+    DES_BS_WORD t85 = x0 & t84;
+    DES_BS_WORD t86 = t80 ^ t85;
+    DES_BS_WORD t87 = ~t52;
+    DES_BS_WORD t88 = x5 ^ t10;
+    DES_BS_WORD t89 = x4 & t88;
+    DES_BS_WORD t90 = x5 ^ t89;
+    DES_BS_WORD t91 = t7 ^ t11;
+    DES_BS_WORD t92 = x4 & t91;
+    DES_BS_WORD t93 = t7 ^ t92;
+    DES_BS_WORD t94 = t8 ^ t50;
+    DES_BS_WORD t95 = x4 & t94;
+    DES_BS_WORD t96 = t8 ^ t95;
+    DES_BS_WORD t97 = x1 ^ t51;
+    DES_BS_WORD t98 = x4 & t97;
+    DES_BS_WORD t99 = x1 ^ t98;
+    DES_BS_WORD t100 = t8 & ~x4;
+    DES_BS_WORD t101 = t7 ^ t87;
+    DES_BS_WORD t102 = x4 & t101;
+    DES_BS_WORD t103 = t7 ^ t102;
+    DES_BS_WORD t104 = t61 ^ t90;
+    DES_BS_WORD t105 = x3 & t104;
+    DES_BS_WORD t106 = t90 ^ t105;
+    DES_BS_WORD t107 = t93 ^ t96;
+    DES_BS_WORD t108 = x3 & t107;
+    DES_BS_WORD t109 = t93 ^ t108;
+    DES_BS_WORD t110 = t65 ^ t99;
+    DES_BS_WORD t111 = x3 & t110;
+    DES_BS_WORD t112 = t99 ^ t111;
+    DES_BS_WORD t113 = t100 ^ t103;
+    DES_BS_WORD t114 = x3 & t113;
+    DES_BS_WORD t115 = t100 ^ t114;
+    DES_BS_WORD t116 = t106 ^ t109;
+    DES_BS_WORD t117 = x2 & t116;
+    DES_BS_WORD t118 = t106 ^ t117;
+    DES_BS_WORD t119 = t112 ^ t115;
+    DES_BS_WORD t120 = x2 & t119;
+    DES_BS_WORD t121 = t112 ^ t120;
+    DES_BS_WORD t122 = t118 ^ t121;
+    DES_BS_WORD t123 = x0 & t122;
+    DES_BS_WORD t124 = t118 ^ t123;
+    DES_BS_WORD t125 = x1 ^ t13;
+    DES_BS_WORD t126 = x4 & t125;
+    DES_BS_WORD t127 = x1 ^ t126;
+    DES_BS_WORD t128 = t7 ^ t12;
+    DES_BS_WORD t129 = x4 & t128;
+    DES_BS_WORD t130 = t12 ^ t129;
+    DES_BS_WORD t131 = x4 ^ t11;
+    DES_BS_WORD t132 = x4 ^ t127;
+    DES_BS_WORD t133 = x3 & t132;
+    DES_BS_WORD t134 = x4 ^ t133;
+    DES_BS_WORD t135 = t65 ^ t130;
+    DES_BS_WORD t136 = x3 & t135;
+    DES_BS_WORD t137 = t65 ^ t136;
+    DES_BS_WORD t138 = t8 ^ t131;
+    DES_BS_WORD t139 = x3 & t138;
+    DES_BS_WORD t140 = t131 ^ t139;
+    DES_BS_WORD t141 = t7 ^ t58;
+    DES_BS_WORD t142 = x3 & t141;
+    DES_BS_WORD t143 = t7 ^ t142;
+    DES_BS_WORD t144 = t134 ^ t137;
+    DES_BS_WORD t145 = x2 & t144;
+    DES_BS_WORD t146 = t134 ^ t145;
+    DES_BS_WORD t147 = t140 ^ t143;
+    DES_BS_WORD t148 = x2 & t147;
+    DES_BS_WORD t149 = t140 ^ t148;
+    DES_BS_WORD t150 = t146 ^ t149;
+    DES_BS_WORD t151 = x0 & t150;
+    DES_BS_WORD t152 = t146 ^ t151;
+    *o0 = t49;
+    *o1 = t86;
+    *o2 = t124;
+    *o3 = t152;
+}
+
+// S7: 138 gates
+static inline void DES_BS_FN(s7)(DES_BS_WORD x0, DES_BS_WORD x1, DES_BS_WORD x2,
+                                 DES_BS_WORD x3, DES_BS_WORD x4, DES_BS_WORD x5,
+                                 DES_BS_WORD *o0, DES_BS_WORD *o1, DES_BS_WORD *o2, DES_BS_WORD *o3) {
+    DES_BS_WORD t6 = x4 & ~x3;
+    DES_BS_WORD t7 = ~t6;
+    DES_BS_WORD t8 = ~x4;
+    DES_BS_WORD t9 = x3 ^ x4;
+    DES_BS_WORD t10 = ~t9;
+    DES_BS_WORD t11 = x3 | x4;
+    DES_BS_WORD t12 = x3 & ~x4;
+    DES_BS_WORD t13 = ~t12;
+    DES_BS_WORD t16 = x4 ^ t7;
+    DES_BS_WORD t17 = x2 & t16;
+    DES_BS_WORD t18 = x4 ^ t17;
+    DES_BS_WORD t19 = x2 ^ t8;
+    DES_BS_WORD t20 = t6 ^ t9;
+    DES_BS_WORD t21 = x2 & t20;
+    DES_BS_WORD t22 = t9 ^ t21;
+    DES_BS_WORD t23 = x2 ^ t10;
+    DES_BS_WORD t24 = x3 ^ t10;
+    DES_BS_WORD t25 = x2 & t24;
+    DES_BS_WORD t26 = x3 ^ t25;
+    DES_BS_WORD t27 = t11 ^ t12;
+    DES_BS_WORD t28 = x2 & t27;
+    DES_BS_WORD t29 = t11 ^ t28;
+    DES_BS_WORD t30 = x2 ^ t13;
+    DES_BS_WORD t31 = t18 ^ t19;
+    DES_BS_WORD t32 = x5 & t31;
+    DES_BS_WORD t33 = t18 ^ t32;
+    DES_BS_WORD t34 = t22 ^ t23;
+    DES_BS_WORD t35 = x5 & t34;
+    DES_BS_WORD t36 = t22 ^ t35;
+    DES_BS_WORD t37 = t26 ^ t29;
+    DES_BS_WORD t38 = x5 & t37;
+    DES_BS_WORD t39 = t26 ^ t38;
+    DES_BS_WORD t40 = t10 ^ t30;
+    DES_BS_WORD t41 = x5 & t40;
+    DES_BS_WORD t42 = t30 ^ t41;
+    DES_BS_WORD t43 = t33 ^ t36;
+    DES_BS_WORD t44 = x1 & t43;
+    DES_BS_WORD t45 = t33 ^ t44;
+    DES_BS_WORD t46 = t39 ^ t42;
+    DES_BS_WORD t47 = x1 & t46;
+    DES_BS_WORD t48 = t39 ^ t47;
+    DES_BS_WORD t49 = t45 ^ t48;
+    DES_BS_WORD t50 = x0 & t49;
+    DES_BS_WORD t51 = t45 ^ t50;
+    DES_BS_WORD t52 = ~t11;
+    DES_BS_WORD t53 = t10 ^ t52;
+    DES_BS_WORD t54 = x2 & t53;
+    DES_BS_WORD t55 = t10 ^ t54;
+    DES_BS_WORD t56 = x2 ^ x4;
+    DES_BS_WORD t57 = t7 ^ t17;
+    DES_BS_WORD t58 = x4 ^ t10;
+    DES_BS_WORD t59 = x2 & t58;
+    DES_BS_WORD t60 = x4 ^ t59;
+    DES_BS_WORD t61 = t10 ^ t55;
+    DES_BS_WORD t62 = x5 & t61;
+    DES_BS_WORD t63 = t10 ^ t62;
+    DES_BS_WORD t64 = t56 ^ t57;
+    DES_BS_WORD t65 = x5 & t64;
+    DES_BS_WORD t66 = t56 ^ t65;
+    DES_BS_WORD t67 = t22 ^ t60;
+    DES_BS_WORD t68 = x5 & t67;
+    DES_BS_WORD t69 = t22 ^ t68;
+    DES_BS_WORD t70 = t63 ^ t66;
+    DES_BS_WORD t71 = x1 & t70;
+    DES_BS_WORD t72 = t63 ^ t71;
+    DES_BS_WORD t73 = t33 ^ t69;
+    DES_BS_WORD t74 = x1 & t73;
+    DES_BS_WORD t75 = t33 ^ t74;
+    DES_BS_WORD t76 = t72 ^ t75;
+    DES_BS_WORD t77 = x0 & t76;
+    DES_BS_WORD t78 = t72 ^ t77;
+    DES_BS_WORD t79 = x3 & x4;
+    DES_BS_WORD t80 = ~x3;
+    DES_BS_WORD t81 = ~t79;
+    DES_BS_WORD t82 = x2 ^ t11;
+    DES_BS_WORD t83 = x3 ^ t79;
+    DES_BS_WORD t84 = x2 & t83;
+    DES_BS_WORD t85 = x3 ^ t84;
+    DES_BS_WORD t86 = t13 ^ t80;
+    DES_BS_WORD t87 = x2 & t86;
+    DES_BS_WORD t88 = t80 ^ t87;
+    DES_BS_WORD t89 = t12 ^ t28;
+    DES_BS_WORD t90 = x2 ^ t80;
+    DES_BS_WORD t91 = x2 ^ t81;
+    DES_BS_WORD t92 = x2 ^ t79;
+    DES_BS_WORD t93 = t82 ^ t85;
+    DES_BS_WORD t94 = x5 & t93;
+    DES_BS_WORD t95 = t82 ^ t94;
+    DES_BS_WORD t96 = t23 ^ t88;
+    DES_BS_WORD t97 = x5 & t96;
+    DES_BS_WORD t98 = t23 ^ t97;
+    DES_BS_WORD t99 = t89 ^ t90;
+    DES_BS_WORD t100 = x5 & t99;
+    DES_BS_WORD t101 = t89 ^ t100;
+    DES_BS_WORD t102 = t91 ^ t92;
+    DES_BS_WORD t103 = x5 & t102;
+    DES_BS_WORD t104 = t91 ^ t103;
+    DES_BS_WORD t105 = t95 ^ t98;
+    DES_BS_WORD t106 = x1 & t105;
+    DES_BS_WORD t107 = t95 ^ t106;
+    DES_BS_WORD t108 = t101 ^ t104;
+    DES_BS_WORD t109 = x1 & t108;
+    DES_BS_WORD t110 = t101 ^ t109;
+    DES_BS_WORD t111 = t107 ^ t110;
+    DES_BS_WORD t112 = x0 & t111;
+    DES_BS_WORD t113 = t107 ^ t112;
+    DES_BS_WORD t114 = t6 ^ t10;
+    DES_BS_WORD t115 = x2 & t114;
+    DES_BS_WORD t116 = t6 ^ t115;
+    DES_BS_WORD t117 = t7 ^ t9;
+    DES_BS_WORD t118 = x2 & t117;
+    DES_BS_WORD t119 = t7 ^ t118;
+    DES_BS_WORD t120 = t7 ^ t10;
+    DES_BS_WORD t121 = x2 & t120;
+    DES_BS_WORD t122 = t7 ^ t121;
+    DES_BS_WORD t123 = x2 ^ t9;
+    DES_BS_WORD t124 = t6 ^ t21;
+    DES_BS_WORD t125 = t116 ^ t119;
+    DES_BS_WORD t126 = x5 & t125;
+    DES_BS_WORD t127 = t116 ^ t126;
+    DES_BS_WORD t128 = t22 ^ t122;
+    DES_BS_WORD t129 = x5 & t128;
+    DES_BS_WORD t130 = t122 ^ t129;
+    DES_BS_WORD t131 = t119 ^ t123;
+    DES_BS_WORD t132 = x5 & t131;
+    DES_BS_WORD t133 = t119 ^ t132;
+    DES_BS_WORD t134 = t30 ^ t124;
+    DES_BS_WORD t135 = x5 & t134;
+    DES_BS_WORD t136 = t124 ^ t135;
+    DES_BS_WORD t137 = t127 ^ t130;
+    DES_BS_WORD t138 = x1 & t137;
+    DES_BS_WORD t139 = t127 ^ t138;
+    DES_BS_WORD t140 = t133 ^ t136;
+    DES_BS_WORD t141 = x1 & t140;
+    DES_BS_WORD t142 = t133 ^ t141;
+    DES_BS_WORD t143 = t139 ^ t142;
+    DES_BS_WORD t144 = x0 & t143;
+    DES_BS_WORD t145 = t139 ^ t144;
+    *o0 = t51;
+    *o1 = t78;
+    *o2 = t113;
+    *o3 = t145;
+}
+
+// S8: 138 gates
+static inline void DES_BS_FN(s8)(DES_BS_WORD x0, DES_BS_WORD x1, DES_BS_WORD x2,
+                                 DES_BS_WORD x3, DES_BS_WORD x4, DES_BS_WORD x5,
+                                 DES_BS_WORD *o0, DES_BS_WORD *o1, DES_BS_WORD *o2, DES_BS_WORD *o3) {
+    DES_BS_WORD t6 = x1 & x3;
+    DES_BS_WORD t7 = ~t6;
+    DES_BS_WORD t8 = x1 ^ x3;
+    DES_BS_WORD t9 = ~t8;
+    DES_BS_WORD t10 = x1 | x3;
+    DES_BS_WORD t11 = x3 & ~x1;
+    DES_BS_WORD t12 = ~t10;
+    DES_BS_WORD t13 = x1 & ~x3;
+    DES_BS_WORD t14 = ~t13;
+    DES_BS_WORD t17 = x3 ^ t7;
+    DES_BS_WORD t18 = x2 & t17;
+    DES_BS_WORD t19 = t7 ^ t18;
+    DES_BS_WORD t20 = x2 ^ t6;
+    DES_BS_WORD t21 = x2 ^ t8;
+    DES_BS_WORD t22 = t10 ^ t11;
+    DES_BS_WORD t23 = x2 & t22;
+    DES_BS_WORD t24 = t10 ^ t23;
+    DES_BS_WORD t25 = x1 ^ t12;
+    DES_BS_WORD t26 = x2 & t25;
+    DES_BS_WORD t27 = x1 ^ t26;
+    DES_BS_WORD t28 = x2 ^ t14;
+    DES_BS_WORD t29 = x2 ^ t13;
+    DES_BS_WORD t30 = t19 ^ t20;
+    DES_BS_WORD t31 = x0 & t30;
+    DES_BS_WORD t32 = t19 ^ t31;
+    DES_BS_WORD t33 = t21 ^ t24;
+    DES_BS_WORD t34 = x0 & t33;
+    DES_BS_WORD t35 = t21 ^ t34;
+    DES_BS_WORD t36 = t9 ^ t27;
+    DES_BS_WORD t37 = x0 & t36;
+    DES_BS_WORD t38 = t27 ^ t37;
+    DES_BS_WORD t39 = t28 ^ t29;
+    DES_BS_WORD t40 = x0 & t39;
+    DES_BS_WORD t41 = t28 ^ t40;
+    DES_BS_WORD t42 = t32 ^ t35;
+    DES_BS_WORD t43 = x5 & t42;
+    DES_BS_WORD t44 = t32 ^ t43;
+    DES_BS_WORD t45 = t38 ^ t41;
+    DES_BS_WORD t46 = x5 & t45;
+    DES_BS_WORD t47 = t38 ^ t46;
+    DES_BS_WORD t48 = t44 ^ t47;
+    DES_BS_WORD t49 = x4 & t48;
+    DES_BS_WORD t50 = t44 ^ t49;
+    DES_BS_WORD t51 = ~t11;
+    DES_BS_WORD t52 = ~x1;
+    DES_BS_WORD t53 = ~x3;
+    DES_BS_WORD t54 = t12 ^ t51;
+    DES_BS_WORD t55 = x2 & t54;
+    DES_BS_WORD t56 = t12 ^ t55;
+    DES_BS_WORD t57 = t10 ^ t52;
+    DES_BS_WORD t58 = x2 & t57;
+    DES_BS_WORD t59 = t52 ^ t58;
+    DES_BS_WORD t60 = x3 ^ t9;
+    DES_BS_WORD t61 = x2 & t60;
+    DES_BS_WORD t62 = x3 ^ t61;
+    DES_BS_WORD t63 = t8 ^ t53;
+    DES_BS_WORD t64 = x2 & t63;
+    DES_BS_WORD t65 = t53 ^ t64;
+    DES_BS_WORD t66 = t56 ^ t59;
+    DES_BS_WORD t67 = x0 & t66;
+    DES_BS_WORD t68 = t56 ^ t67;
+    DES_BS_WORD t69 = t24 ^ t34;
+    DES_BS_WORD t70 = t27 ^ t62;
+    DES_BS_WORD t71 = x0 & t70;
+    DES_BS_WORD t72 = t62 ^ t71;
+    DES_BS_WORD t73 = t8 ^ t65;
+    DES_BS_WORD t74 = x0 & t73;
+    DES_BS_WORD t75 = t65 ^ t74;
+    DES_BS_WORD t76 = t68 ^ t69;
+    DES_BS_WORD t77 = x5 & t76;
+    DES_BS_WORD t78 = t68 ^ t77;
+    DES_BS_WORD t79 = t72 ^ t75;
+    DES_BS_WORD t80 = x5 & t79;
+    DES_BS_WORD t81 = t72 ^ t80;
+    DES_BS_WORD t82 = t78 ^ t81;
+    DES_BS_WORD t83 = x4 & t82;
+    DES_BS_WORD t84 = t78 ^ t83;
+    DES_BS_WORD t85 = x1 ^ x2;
+    DES_BS_WORD t86 = x2 ^ t9;
+    DES_BS_WORD t87 = t6 ^ t52;
+    DES_BS_WORD t88 = x2 & t87;
+    DES_BS_WORD t89 = t6 ^ t88;
+    DES_BS_WORD t90 = x1 ^ t7;
+    DES_BS_WORD t91 = x2 & t90;
+    DES_BS_WORD t92 = t7 ^ t91;
+    DES_BS_WORD t93 = t9 ^ t51;
+    DES_BS_WORD t94 = x2 & t93;
+    DES_BS_WORD t95 = t9 ^ t94;
+    DES_BS_WORD t96 = t9 ^ t11;
+    DES_BS_WORD t97 = x2 & t96;
+    DES_BS_WORD t98 = t11 ^ t97;
+    DES_BS_WORD t99 = t85 ^ t86;
+    DES_BS_WORD t100 = x0 & t99;
+    DES_BS_WORD t101 = t85 ^ t100;
+    DES_BS_WORD t102 = t89 ^ t92;
+    DES_BS_WORD t103 = x0 & t102;
+    DES_BS_WORD t104 = t89 ^ t103;
+    DES_BS_WORD t105 = t9 ^ t65;
+    DES_BS_WORD t106 = x0 & t105;
+    DES_BS_WORD t107 = t9 ^ t106;
+    DES_BS_WORD t108 = t95 ^ t98;
+    DES_BS_WORD t109 = x0 & t108;
+    DES_BS_WORD t110 = t95 ^ t109;
+    DES_BS_WORD t111 = t101 ^ t104;
+    DES_BS_WORD t112 = x5 & t111;
+    DES_BS_WORD t113 = t101 ^ t112;
+    DES_BS_WORD t114 = t107 ^ t110;
+    DES_BS_WORD t115 = x5 & t114;
+    DES_BS_WORD t116 = t107 ^ t115;
+    DES_BS_WORD t117 = t113 ^ t116;
+    DES_BS_WORD t118 = x4 & t117;
+    DES_BS_WORD t119 = t113 ^ t118;
+    DES_BS_WORD t120 = x3 ^ t52;
+    DES_BS_WORD t121 = x2 & t120;
+    DES_BS_WORD t122 = t52 ^ t121;
+    DES_BS_WORD t123 = x1 ^ t13;
+    DES_BS_WORD t124 = x2 & t123;
+    DES_BS_WORD t125 = x1 ^ t124;
+    DES_BS_WORD t126 = t51 ^ t55;
+    DES_BS_WORD t127 = t56 ^ t86;
+    DES_BS_WORD t128 = x0 & t127;
+    DES_BS_WORD t129 = t86 ^ t128;
+    DES_BS_WORD t130 = t122 ^ t125;
+    DES_BS_WORD t131 = x0 & t130;
+    DES_BS_WORD t132 = t122 ^ t131;
+    DES_BS_WORD t133 = t29 ^ t40;
+    DES_BS_WORD t134 = t59 ^ t126;
+    DES_BS_WORD t135 = x0 & t134;
+    DES_BS_WORD t136 = t126 ^ t135;
+    DES_BS_WORD t137 = t129 ^ t132;
+    DES_BS_WORD t138 = x5 & t137;
+    DES_BS_WORD t139 = t129 ^ t138;
+    DES_BS_WORD t140 = t133 ^ t136;
+    DES_BS_WORD t141 = x5 & t140;
+    DES_BS_WORD t142 = t133 ^ t141;
+    DES_BS_WORD t143 = t139 ^ t142;
+    DES_BS_WORD t144 = x4 & t143;
+    DES_BS_WORD t145 = t139 ^ t144;
+    *o0 = t50;
+    *o1 = t84;
+    *o2 = t119;
+    *o3 = t145;
+}
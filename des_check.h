@@ -0,0 +1,397 @@
+#ifndef DES_CHECK_H
+#define DES_CHECK_H
+
+// Keyword check on DES-CBC ciphertext for candidate keys.
+//
+// Block i of a CBC plaintext is D_k(C_i) ^ C_(i-1) (C_(-1) being the IV), so
+// it can be recovered without decrypting any other block. When the byte
+// offset of the keyword in the plaintext is known, only the blocks it spans
+// are decrypted, one at a time, and the check stops at the first block that
+// does not match: the cost per key no longer depends on the size of the
+// input.
+//
+// With an unknown offset and a keyword of at least 2 * 8 - 1 bytes, whatever
+// the keyword's alignment one plaintext block lies entirely inside it: the
+// 8 bytes of the keyword starting at index j, where j is the distance from
+// the keyword start to the next block boundary. These windows are
+// precomputed, single blocks are decrypted on their own and compared to them
+// as 64-bit words, and only a block that equals a window is checked against
+// the rest of the keyword. A keyword of 8 * k + 7 bytes covers k whole
+// blocks, so with 8 * k windows only every k-th block has to be decrypted.
+// Shorter keywords with an unknown offset fall back to decrypting the whole
+// text and scanning it with the keyword matcher (des_match.h). With
+// des_check_printable() those texts are first rejected if they hold a byte
+// outside 32..126, as solucion2 always did; a wrong key almost always
+// decrypts to such a byte within the first few, so the filter is cheaper
+// than the scan and keeps short keywords from matching random text.
+//
+// A check may have several keywords. The first one is the primary keyword:
+// --offset refers to it and the block checks above use it. With
+// DES_MATCH_ALL a key that passes them must also decrypt to a text holding
+// every other keyword. With DES_MATCH_ANY any keyword may be the one in
+// the text, so the whole text is decrypted and scanned for all of them.
+//
+// Every check counts, in a des_check_stats owned by the worker, the keys
+// that passed the first block or window compare and had to be verified in
+// full, and the time spent verifying them (or scanning the whole text,
+// which has no cheaper first stage: there the candidates are the texts that
+// passed the printable filter, or without it the texts that matched). Both are rare or cheap next to the
+// decryption, so the counters cost nothing measurable.
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <openssl/des.h>
+
+#include "des_bitslice.h"
+#include "des_match.h"
+
+#define DES_CHECK_ANYWHERE (-1L)
+
+// Shortest keyword that always covers a whole block
+#define DES_CHECK_MIN_ALIGNED (2 * DES_KEY_SZ - 1)
+
+// Most windows compared per block (so at most every 4th block is decrypted)
+#define DES_CHECK_MAX_WINDOWS 32
+
+// Work of the keyword checks of one worker
+struct des_check_stats {
+    uint64_t candidates;          // Keys verified in full after the first compare
+    uint64_t check_ns;            // Time verifying them, or scanning the whole text
+};
+
+static inline uint64_t des_check_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+struct des_check {
+    const uint8_t *ciphertext;   // Padded to whole blocks
+    size_t length;               // Plaintext length
+    DES_cblock iv;
+    const char *keyword;         // Primary keyword
+    size_t keyword_length;
+    const char *const *keywords; // All of them, the primary first
+    struct des_match match;      // All the keywords, for whole-text scans
+    int others;                  // Candidates must also hold the other keywords
+    int printable;               // Whole-text scans only accept printable ASCII texts
+    long offset;                 // Keyword position in the plaintext or DES_CHECK_ANYWHERE
+    size_t first_block;          // Blocks spanned by the keyword (offset mode)
+    size_t last_block;
+    // First spanned block as des_bs_match_keys arguments: the keyword bytes
+    // XORed with the previous ciphertext block, and which bytes to compare
+    uint8_t expected[DES_KEY_SZ];
+    uint8_t mask[DES_KEY_SZ];
+    // Unknown offset, keyword of at least DES_CHECK_MIN_ALIGNED bytes:
+    // windows[j] holds keyword bytes [j, j + 8) as a 64-bit word and
+    // targets[j] the same bytes in des_bs_target form
+    int aligned;
+    int window_count;
+    uint64_t windows[DES_CHECK_MAX_WINDOWS];
+    uint64_t targets[DES_CHECK_MAX_WINDOWS];
+    size_t blocks;               // Whole plaintext blocks
+    size_t step;                 // Decrypt every step-th block
+};
+
+static void des_check_free(struct des_check *check) {
+    des_match_free(&check->match);
+}
+
+// Sets up the check for count keywords (which must outlive it), keywords[0]
+// being the primary one. Returns -1 (after printing why) if the keywords
+// are invalid or the primary one does not fit in the text at offset.
+static int des_check_init(struct des_check *check, const uint8_t *ciphertext, size_t length, const DES_cblock *iv,
+                          const char *const *keywords, int count, enum des_match_mode mode, long offset) {
+    const char *keyword = keywords[0];
+    check->ciphertext = ciphertext;
+    check->length = length;
+    memcpy(check->iv, *iv, sizeof(DES_cblock));
+    check->keyword = keyword;
+    check->keyword_length = strlen(keyword);
+    check->keywords = keywords;
+    check->offset = offset;
+    check->aligned = 0;
+    check->printable = 0;
+    if (des_match_init(&check->match, keywords, count, mode) != 0) {
+        return -1;
+    }
+    check->others = count > 1 && mode == DES_MATCH_ALL;
+    if (count > 1 && mode == DES_MATCH_ANY) {
+        // No block check can rule a key out
+        if (offset != DES_CHECK_ANYWHERE) {
+            printf("Error: --offset needs a single keyword or --match=all\n");
+            des_check_free(check);
+            return -1;
+        }
+        return 0;
+    }
+    if (offset == DES_CHECK_ANYWHERE) {
+        if (check->keyword_length >= DES_CHECK_MIN_ALIGNED && length >= check->keyword_length) {
+            size_t usable = check->keyword_length - (DES_KEY_SZ - 1);
+            if (usable > DES_CHECK_MAX_WINDOWS) {
+                usable = DES_CHECK_MAX_WINDOWS;
+            }
+            check->aligned = 1;
+            check->step = usable / DES_KEY_SZ;
+            check->window_count = (int)(check->step * DES_KEY_SZ);
+            for (int j = 0; j < check->window_count; j++) {
+                memcpy(&check->windows[j], keyword + j, sizeof(uint64_t));
+                check->targets[j] = des_bs_target((const uint8_t *)keyword + j);
+            }
+            check->blocks = length / DES_KEY_SZ;
+        }
+        return 0;
+    }
+    if (offset < 0 || check->keyword_length == 0 || (size_t)offset + check->keyword_length > length) {
+        printf("Error: a %zu byte keyword does not fit at offset %ld of a %zu byte text\n",
+               check->keyword_length, offset, length);
+        des_check_free(check);
+        return -1;
+    }
+
+    check->first_block = (size_t)offset / DES_KEY_SZ;
+    check->last_block = ((size_t)offset + check->keyword_length - 1) / DES_KEY_SZ;
+
+    const uint8_t *chain = check->first_block == 0 ? check->iv
+                                                   : ciphertext + (check->first_block - 1) * DES_KEY_SZ;
+    for (size_t i = 0; i < DES_KEY_SZ; i++) {
+        size_t pos = check->first_block * DES_KEY_SZ + i;
+        int inside = pos >= (size_t)offset && pos < (size_t)offset + check->keyword_length;
+        check->expected[i] = inside ? (uint8_t)(keyword[pos - offset] ^ chain[i]) : 0;
+        check->mask[i] = inside ? 0xff : 0;
+    }
+    return 0;
+}
+
+// Makes the whole-text scans reject texts holding a byte outside 32..126
+static inline void des_check_printable(struct des_check *check) {
+    check->printable = 1;
+}
+
+// Whole-text scan of a decrypted text, counted in stats if not NULL
+static inline int des_check_match_text(const struct des_check *check, const uint8_t *text,
+                                       struct des_check_stats *stats) {
+    if (check->printable) {
+        for (size_t i = 0; i < check->length; i++) {
+            if (text[i] < 32 || text[i] > 126) {
+                return 0;
+            }
+        }
+    }
+    int found = des_match_scan(&check->match, text, check->length);
+    if (stats != NULL && (check->printable || found)) {
+        stats->candidates++;
+    }
+    return found;
+}
+
+// Decrypts plaintext block `block` into out
+static inline void des_check_decrypt_block(const struct des_check *check, DES_key_schedule *schedule, size_t block,
+                                           uint8_t out[DES_KEY_SZ]) {
+    const uint8_t *chain = block == 0 ? check->iv : check->ciphertext + (block - 1) * DES_KEY_SZ;
+    DES_ecb_encrypt((const_DES_cblock *)(check->ciphertext + block * DES_KEY_SZ), (DES_cblock *)out, schedule,
+                    DES_DECRYPT);
+    for (size_t i = 0; i < DES_KEY_SZ; i++) {
+        out[i] ^= chain[i];
+    }
+}
+
+// Decrypts the whole text into decrypted (des_check_scratch_bytes() bytes)
+// and scans it for the keywords
+static inline int des_check_text(const struct des_check *check, DES_key_schedule *schedule, uint8_t *decrypted) {
+    DES_cblock iv_copy;
+    memcpy(&iv_copy, check->iv, sizeof(DES_cblock));
+    DES_cbc_encrypt(check->ciphertext, decrypted, check->length, schedule, &iv_copy, DES_DECRYPT);
+    return des_check_match_text(check, decrypted, NULL);
+}
+
+// A key that holds the primary keyword: does the text hold the others?
+static inline int des_check_rest(const struct des_check *check, DES_key_schedule *schedule, uint8_t *decrypted) {
+    return !check->others || des_check_text(check, schedule, decrypted);
+}
+
+// Compares the keyword, assumed to start at byte begin, with the plaintext
+// blocks it spans from block `from` on. Stops at the first mismatch.
+static inline int des_check_at(const struct des_check *check, DES_key_schedule *schedule, size_t begin,
+                               size_t from) {
+    size_t end = begin + check->keyword_length;
+    size_t last = (end - 1) / DES_KEY_SZ;
+    for (size_t block = from; block <= last; block++) {
+        uint8_t plain[DES_KEY_SZ];
+        des_check_decrypt_block(check, schedule, block, plain);
+
+        size_t lo = block * DES_KEY_SZ < begin ? begin : block * DES_KEY_SZ;
+        size_t hi = (block + 1) * DES_KEY_SZ > end ? end : (block + 1) * DES_KEY_SZ;
+        if (memcmp(plain + (lo - block * DES_KEY_SZ), check->keyword + (lo - begin), hi - lo) != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Known offset: compares the first spanned block with the keyword bytes it
+// holds (expected already has the chaining block folded in)
+static inline int des_check_first(const struct des_check *check, DES_key_schedule *schedule) {
+    uint8_t out[DES_KEY_SZ];
+    DES_ecb_encrypt((const_DES_cblock *)(check->ciphertext + check->first_block * DES_KEY_SZ), (DES_cblock *)out,
+                    schedule, DES_DECRYPT);
+    for (size_t i = 0; i < DES_KEY_SZ; i++) {
+        if ((out[i] & check->mask[i]) != check->expected[i]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Plaintext block `block` (already decrypted into plain) may lie inside the
+// keyword: verify the rest of the keyword around it for every window it
+// equals
+static inline int des_check_window(const struct des_check *check, DES_key_schedule *schedule, size_t block,
+                                   uint64_t plain, uint8_t *decrypted, struct des_check_stats *stats) {
+    for (int j = 0; j < check->window_count; j++) {
+        if (plain != check->windows[j] || block * DES_KEY_SZ < (size_t)j) {
+            continue;
+        }
+        size_t begin = block * DES_KEY_SZ - j;
+        if (begin + check->keyword_length > check->length) {
+            continue;
+        }
+        uint64_t start = des_check_now_ns();
+        int found = des_check_at(check, schedule, begin, begin / DES_KEY_SZ)
+                    && des_check_rest(check, schedule, decrypted);
+        stats->candidates++;
+        stats->check_ns += des_check_now_ns() - start;
+        if (found) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Aligned mode: one block decryption per step blocks
+static inline int des_check_scan(const struct des_check *check, DES_key_schedule *schedule, uint8_t *decrypted,
+                                 struct des_check_stats *stats) {
+    for (size_t block = 0; block < check->blocks; block += check->step) {
+        uint64_t plain;
+        des_check_decrypt_block(check, schedule, block, (uint8_t *)&plain);
+        if (des_check_window(check, schedule, block, plain, decrypted, stats)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Returns 1 if the key with this schedule decrypts to a text holding the
+// keywords. decrypted holds des_check_scratch_bytes() bytes.
+static inline int des_check_schedule(const struct des_check *check, DES_key_schedule *schedule, uint8_t *decrypted,
+                                     struct des_check_stats *stats) {
+    if (check->offset != DES_CHECK_ANYWHERE) {
+        if (!des_check_first(check, schedule)) {
+            return 0;
+        }
+        uint64_t start = des_check_now_ns();
+        int found = des_check_at(check, schedule, (size_t)check->offset, check->first_block + 1)
+                    && des_check_rest(check, schedule, decrypted);
+        stats->candidates++;
+        stats->check_ns += des_check_now_ns() - start;
+        return found;
+    }
+    if (check->aligned) {
+        return des_check_scan(check, schedule, decrypted, stats);
+    }
+
+    DES_cblock iv_copy;
+    memcpy(&iv_copy, check->iv, sizeof(DES_cblock));
+    DES_cbc_encrypt(check->ciphertext, decrypted, check->length, schedule, &iv_copy, DES_DECRYPT);
+    uint64_t start = des_check_now_ns();
+    int found = des_check_match_text(check, decrypted, stats);
+    stats->check_ns += des_check_now_ns() - start;
+    return found;
+}
+
+// Scratch bytes per key needed by des_check_schedule (decrypted) and
+// des_check_keys (each lane): a whole text for the whole-text scan, or to
+// look for the other keywords
+static inline size_t des_check_scratch_bytes(const struct des_check *check) {
+    if ((check->offset != DES_CHECK_ANYWHERE || check->aligned) && !check->others) {
+        return 0;
+    }
+    return check->length;
+}
+
+// Bytes of the lanes buffer of des_check_keys for count keys. With a known
+// offset or in aligned mode the lanes only decrypt single blocks and the
+// surviving keys are verified one at a time, so one scratch text is enough;
+// the whole-text scan needs a text per key.
+static inline size_t des_check_lane_bytes(const struct des_check *check, int count) {
+    if (check->offset != DES_CHECK_ANYWHERE || check->aligned) {
+        return des_check_scratch_bytes(check);
+    }
+    return (size_t)count * check->length;
+}
+
+// Bitsliced version for count (<= des_bs_lanes()) keys. With a known offset
+// the first spanned block is matched for all lanes at once and only the
+// surviving keys decrypt the remaining blocks. In aligned mode the sampled
+// blocks are compared with the windows for all lanes at once. lanes holds
+// des_check_lane_bytes() bytes. Returns the first matching lane or -1.
+static inline int des_check_keys(const struct des_check *check, const DES_cblock *keys, int count, uint8_t *lanes,
+                                 struct des_check_stats *stats) {
+    if (check->offset != DES_CHECK_ANYWHERE) {
+        uint64_t hits[DES_BS_MAX_LANES / 64];
+        des_bs_match_keys(keys, count, check->ciphertext + check->first_block * DES_KEY_SZ, check->expected,
+                          check->mask, hits);
+        int first = des_bs_first_hit(hits, count);
+        if (first < 0) {
+            return -1;
+        }
+        int found = -1;
+        uint64_t start = des_check_now_ns();
+        for (int l = first; l < count && found < 0; l++) {
+            if (!((hits[l / 64] >> (l % 64)) & 1)) {
+                continue;
+            }
+            DES_key_schedule schedule;
+            DES_set_key_unchecked((DES_cblock *)&keys[l], &schedule);
+            stats->candidates++;
+            if (des_check_at(check, &schedule, (size_t)check->offset, check->first_block + 1)
+                    && des_check_rest(check, &schedule, lanes)) {
+                found = l;
+            }
+        }
+        stats->check_ns += des_check_now_ns() - start;
+        return found;
+    }
+
+    if (check->aligned) {
+        uint64_t hits[DES_BS_MAX_LANES / 64];
+        des_bs_match_any(keys, count, check->ciphertext, check->blocks, check->step, &check->iv, check->targets,
+                         check->window_count, hits);
+        for (int l = des_bs_first_hit(hits, count); l >= 0 && l < count; l++) {
+            if (!((hits[l / 64] >> (l % 64)) & 1)) {
+                continue;
+            }
+            DES_key_schedule schedule;
+            DES_set_key_unchecked((DES_cblock *)&keys[l], &schedule);
+            if (des_check_scan(check, &schedule, lanes, stats)) {
+                return l;
+            }
+        }
+        return -1;
+    }
+
+    size_t stride = check->length;
+    des_bs_decrypt_cbc(keys, count, check->ciphertext, check->length, &check->iv, lanes, stride);
+    int found = -1;
+    uint64_t start = des_check_now_ns();
+    for (int l = 0; l < count && found < 0; l++) {
+        if (des_check_match_text(check, lanes + l * stride, stats)) {
+            found = l;
+        }
+    }
+    stats->check_ns += des_check_now_ns() - start;
+    return found;
+}
+
+#endif
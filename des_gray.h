@@ -0,0 +1,98 @@
+#ifndef DES_GRAY_H
+#define DES_GRAY_H
+
+// Gray-code key traversal with incremental key schedule updates.
+//
+// Position i of the traversal tests the key counter gray(i) = i ^ (i >> 1)
+// (KEYSPACE_ORDER_GRAY in keyspace.h), so consecutive candidates differ in a
+// single counter bit. The DES key schedule is linear over GF(2) in the key
+// bits (it only permutes and rotates them), so flipping one key bit flips a
+// fixed set of schedule bits: the schedule is updated with one XOR against a
+// precomputed delta instead of calling DES_set_key for every key. With a key
+// mask (keyspace.h) the Gray code runs over the free bits only, so each step
+// still flips a single counter bit.
+
+#include <stdint.h>
+#include <openssl/des.h>
+
+#include "keyspace.h"
+
+// Schedule of the key with only counter bit b set, for b < KEYSPACE_BITS
+static DES_key_schedule des_gray_delta[KEYSPACE_BITS];
+static int des_gray_ready = 0;
+
+// Builds the delta table. Must run before any des_gray_walk is used (and
+// before worker threads are started).
+static void des_gray_init(void) {
+    if (des_gray_ready) {
+        return;
+    }
+    for (int b = 0; b < KEYSPACE_BITS; b++) {
+        DES_cblock key;
+        keyspace_counter_to_key(1ULL << b, &key);
+        // The parity bit of a single-bit key is set too, but DES ignores it
+        DES_set_key_unchecked(&key, &des_gray_delta[b]);
+    }
+    des_gray_ready = 1;
+}
+
+static inline void des_gray_flip(DES_key_schedule *schedule, int bit) {
+    for (int round = 0; round < 16; round++) {
+        schedule->ks[round].deslong[0] ^= des_gray_delta[bit].ks[round].deslong[0];
+        schedule->ks[round].deslong[1] ^= des_gray_delta[bit].ks[round].deslong[1];
+    }
+}
+
+// Walks the positions from first to last (inclusive, in either direction)
+struct des_gray_walk {
+    uint64_t position;
+    uint64_t last;
+    int started;
+    const struct keyspace_mask *mask; // Or NULL
+    uint64_t counter;              // Key counter tested at this position
+    DES_key_schedule schedule;     // Schedule of keyspace_counter_to_key(counter)
+};
+
+static inline void des_gray_walk_init(struct des_gray_walk *walk, uint64_t first, uint64_t last,
+                                      const struct keyspace_mask *mask) {
+    DES_cblock key;
+    walk->position = first;
+    walk->last = last;
+    walk->started = 0;
+    walk->mask = mask;
+    walk->counter = keyspace_gray_code(first);
+    if (mask != NULL) {
+        walk->counter = keyspace_mask_deposit(mask, walk->counter);
+    }
+    keyspace_counter_to_key(walk->counter, &key);
+    DES_set_key_unchecked(&key, &walk->schedule);
+}
+
+// Moves to the next position; returns 0 once last has been visited
+static inline int des_gray_walk_next(struct des_gray_walk *walk) {
+    if (!walk->started) {
+        walk->started = 1;
+        return 1;
+    }
+    if (walk->position == walk->last) {
+        return 0;
+    }
+
+    // gray(i) and gray(i + 1) differ in the lowest set bit of i + 1
+    int bit;
+    if (walk->position < walk->last) {
+        walk->position++;
+        bit = __builtin_ctzll(walk->position);
+    } else {
+        bit = __builtin_ctzll(walk->position);
+        walk->position--;
+    }
+    if (walk->mask != NULL) {
+        bit = walk->mask->bit[bit];
+    }
+    walk->counter ^= 1ULL << bit;
+    des_gray_flip(&walk->schedule, bit);
+    return 1;
+}
+
+#endif
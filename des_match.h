@@ -0,0 +1,175 @@
+#ifndef DES_MATCH_H
+#define DES_MATCH_H
+
+// Matcher for a set of keywords in decrypted text.
+//
+// The keywords are compiled once into an Aho-Corasick automaton, stored as
+// a full transition table (one row of 256 next states per state), so the
+// scan is a single pass with one table lookup per byte whatever the number
+// of keywords. Transitions into a state where some keyword ends carry
+// DES_MATCH_HIT, so the scan needs no second lookup per byte. A single
+// keyword is searched with memchr for its first byte and memcmp instead,
+// which skips through the text faster than any automaton. Either way the scan is bounded by the text
+// length and does not stop at NUL bytes, so it is safe on wrong-key output
+// and finds keywords in binary plaintexts. With DES_MATCH_ANY a text
+// matches once any keyword occurs in it, with DES_MATCH_ALL once every
+// keyword does.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "des_match_mode.h"
+
+// Most automaton states, which bounds the total keyword length
+#define DES_MATCH_MAX_STATES 32767
+
+// Flag of the transitions into a state where a keyword ends
+#define DES_MATCH_HIT 0x8000
+
+struct des_match {
+    enum des_match_mode mode;
+    int count;                    // Keywords
+    const char *keyword;          // The keyword when count is 1
+    size_t keyword_length;
+    uint64_t all;                 // Mask of all the keywords
+    int states;
+    uint16_t (*next)[256];        // Transition table, state 0 is the root
+    uint64_t *out;                // Keywords that end at each state
+};
+
+static void des_match_free(struct des_match *m) {
+    free(m->next);
+    free(m->out);
+    m->next = NULL;
+    m->out = NULL;
+}
+
+// Compiles count (1 to DES_MATCH_MAX_KEYWORDS) non-empty keywords. Returns
+// -1 (after printing why) if they are invalid or too long in total.
+static int des_match_init(struct des_match *m, const char *const *keywords, int count, enum des_match_mode mode) {
+    m->mode = mode;
+    m->count = count;
+    m->all = count == 64 ? ~0ULL : (1ULL << count) - 1;
+    m->keyword = keywords[0];
+    m->keyword_length = strlen(keywords[0]);
+    m->next = NULL;
+    m->out = NULL;
+
+    size_t total = 1;
+    for (int k = 0; k < count; k++) {
+        total += strlen(keywords[k]);
+        if (keywords[k][0] == '\0') {
+            printf("Error: empty keyword\n");
+            return -1;
+        }
+    }
+    if (count < 1 || count > DES_MATCH_MAX_KEYWORDS || total > DES_MATCH_MAX_STATES) {
+        printf("Error: 1 to %d keywords of at most %d bytes in total\n", DES_MATCH_MAX_KEYWORDS,
+               DES_MATCH_MAX_STATES - 1);
+        return -1;
+    }
+
+    m->next = calloc(total, sizeof(*m->next));
+    m->out = calloc(total, sizeof(*m->out));
+    uint16_t *fail = calloc(total, sizeof(*fail));
+    uint16_t *queue = calloc(total, sizeof(*queue));
+    if (m->next == NULL || m->out == NULL || fail == NULL || queue == NULL) {
+        printf("Error: Failed to allocate the keyword matcher.\n");
+        des_match_free(m);
+        free(fail);
+        free(queue);
+        return -1;
+    }
+
+    // Trie of the keywords; 0 doubles as "no edge" since no edge leads
+    // back to the root
+    m->states = 1;
+    for (int k = 0; k < count; k++) {
+        int state = 0;
+        for (const uint8_t *c = (const uint8_t *)keywords[k]; *c != '\0'; c++) {
+            if (m->next[state][*c] == 0) {
+                m->next[state][*c] = (uint16_t)m->states++;
+            }
+            state = m->next[state][*c];
+        }
+        m->out[state] |= 1ULL << k;
+    }
+
+    // Breadth-first, turn the trie into the full automaton: a missing edge
+    // goes where the failure state's edge goes
+    int head = 0, tail = 0;
+    for (int c = 0; c < 256; c++) {
+        if (m->next[0][c] != 0) {
+            fail[m->next[0][c]] = 0;
+            queue[tail++] = m->next[0][c];
+        }
+    }
+    while (head < tail) {
+        int state = queue[head++];
+        m->out[state] |= m->out[fail[state]];
+        for (int c = 0; c < 256; c++) {
+            int child = m->next[state][c];
+            if (child != 0) {
+                fail[child] = m->next[fail[state]][c];
+                queue[tail++] = (uint16_t)child;
+            } else {
+                m->next[state][c] = m->next[fail[state]][c];
+            }
+        }
+    }
+
+    // Every output is final now, so the hit flags can go in
+    for (int state = 0; state < m->states; state++) {
+        for (int c = 0; c < 256; c++) {
+            if (m->out[m->next[state][c]] != 0) {
+                m->next[state][c] |= DES_MATCH_HIT;
+            }
+        }
+    }
+    free(fail);
+    free(queue);
+    return 0;
+}
+
+// Returns 1 if the length bytes of text match the set
+static inline int des_match_scan(const struct des_match *m, const uint8_t *text, size_t length) {
+    if (m->count == 1) {
+        size_t n = m->keyword_length;
+        const uint8_t *end = text + length;
+        for (const uint8_t *p = text; (size_t)(end - p) >= n; p++) {
+            p = memchr(p, m->keyword[0], (size_t)(end - p) - n + 1);
+            if (p == NULL) {
+                return 0;
+            }
+            if (memcmp(p + 1, m->keyword + 1, n - 1) == 0) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+    unsigned state = 0;
+    if (m->mode == DES_MATCH_ANY) {
+        for (size_t i = 0; i < length; i++) {
+            state = m->next[state][text[i]];
+            if (state & DES_MATCH_HIT) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < length; i++) {
+        state = m->next[state & ~DES_MATCH_HIT][text[i]];
+        if (state & DES_MATCH_HIT) {
+            seen |= m->out[state & ~DES_MATCH_HIT];
+            if (seen == m->all) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+#endif
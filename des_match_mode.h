@@ -0,0 +1,15 @@
+#ifndef DES_MATCH_MODE_H
+#define DES_MATCH_MODE_H
+
+// Limits and modes of the keyword matcher (des_match.h), apart from its
+// code so that the option parser can name them without compiling it.
+
+// Most keywords in a set (one bit each in a uint64_t mask)
+#define DES_MATCH_MAX_KEYWORDS 64
+
+enum des_match_mode {
+    DES_MATCH_ANY,
+    DES_MATCH_ALL
+};
+
+#endif
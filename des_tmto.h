@@ -0,0 +1,320 @@
+#ifndef DES_TMTO_H
+#define DES_TMTO_H
+
+// Rainbow tables for one known plaintext block (bruteforce --tmto-build
+// and --tmto-lookup).
+//
+// A chain starts at a key position, encrypts the plaintext block with that
+// key and reduces the ciphertext to the next position, with a reduction
+// that differs from column to column. Only the first and last positions of
+// each chain are stored, sorted by the last, and chains that end at the
+// same position are kept once (they merged, so they hold the same keys from
+// there on). To recover the key of a ciphertext, assume it is in column i:
+// reduce it and walk to the end of the chain, and look that end up. On a
+// match the chain is rebuilt from its start up to column i and the key is
+// checked against the ciphertext, because another chain that merely merges
+// into a stored one reaches the same end (a false alarm). A table of m
+// chains of length t holds most of m * t keys, and a lookup costs about
+// t^2 / 2 encryptions per table instead of a sweep of the key space. A few
+// tables with different reductions cover the keys one table misses.
+//
+// Positions are those of keyspace.h over 2^bits keys, spread over the free
+// bits of the --key-pattern mask if there is one. Tables are written in the
+// machine's byte order, for the nodes that built them.
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <openssl/des.h>
+
+#include "keyspace.h"
+
+#define DES_TMTO_MAGIC "des-tmto 1"
+
+// Most tables in a set
+#define DES_TMTO_MAX_TABLES 64
+
+// Most threads building chains
+#define DES_TMTO_MAX_THREADS 1024
+
+struct des_tmto {
+    DES_cblock plaintext;
+    int bits;                     // Of the positions
+    uint64_t positions;           // 2^bits - 1
+    const struct keyspace_mask *mask; // Or NULL
+    uint64_t length;              // Keys per chain (t)
+    uint64_t chains;              // Chains per table before merges are dropped (m)
+    int tables;
+};
+
+struct des_tmto_chain {
+    uint64_t start;
+    uint64_t end;
+};
+
+// Chains of one table, sorted by end
+struct des_tmto_table {
+    size_t count;
+    struct des_tmto_chain *chains;
+};
+
+// On-disk header of a table file, followed for each table by its chain
+// count and chains
+struct des_tmto_header {
+    char magic[16];
+    uint64_t plaintext;
+    uint64_t bits;
+    uint64_t free;                // Mask bits, 0 without a mask
+    uint64_t fixed;
+    uint64_t length;
+    uint64_t chains;
+    uint64_t tables;
+    uint64_t part;                // Process that built the file
+    uint64_t parts;               // Processes that built the set
+};
+
+static void des_tmto_init(struct des_tmto *tmto, const DES_cblock *plaintext, int bits,
+                          const struct keyspace_mask *mask, uint64_t length, uint64_t chains, int tables) {
+    memcpy(tmto->plaintext, plaintext, sizeof(DES_cblock));
+    tmto->bits = bits;
+    tmto->positions = bits == 64 ? ~0ULL : (1ULL << bits) - 1;
+    tmto->mask = mask;
+    tmto->length = length;
+    tmto->chains = chains;
+    tmto->tables = tables;
+}
+
+static inline uint64_t des_tmto_counter(const struct des_tmto *tmto, uint64_t position) {
+    return tmto->mask != NULL ? keyspace_mask_deposit(tmto->mask, position) : position;
+}
+
+// The plaintext block encrypted with the key at position, as a big-endian
+// integer
+static inline uint64_t des_tmto_encrypt(const struct des_tmto *tmto, uint64_t position) {
+    DES_cblock key, out;
+    DES_key_schedule schedule;
+    keyspace_counter_to_key(des_tmto_counter(tmto, position), &key);
+    DES_set_key_unchecked(&key, &schedule);
+    DES_ecb_encrypt((DES_cblock *)&tmto->plaintext, &out, &schedule, DES_ENCRYPT);
+    uint64_t c = 0;
+    for (int i = 0; i < 8; i++) {
+        c = (c << 8) | out[i];
+    }
+    return c;
+}
+
+// Reduction of column of table: the ciphertext xor-ed with a constant of
+// the two, cut down to a position
+static inline uint64_t des_tmto_reduce(const struct des_tmto *tmto, int table, uint64_t column, uint64_t c) {
+    uint64_t salt = (column + 1) * 0x9E3779B97F4A7C15ULL + (uint64_t)table * 0xD1B54A32D192ED03ULL;
+    return (c ^ salt ^ (salt >> 29)) & tmto->positions;
+}
+
+// Position at column to of the chain through position at column from
+static inline uint64_t des_tmto_walk(const struct des_tmto *tmto, int table, uint64_t position, uint64_t from,
+                                     uint64_t to) {
+    for (uint64_t column = from; column < to; column++) {
+        position = des_tmto_reduce(tmto, table, column, des_tmto_encrypt(tmto, position));
+    }
+    return position;
+}
+
+static int des_tmto_compare(const void *a, const void *b) {
+    const struct des_tmto_chain *x = a, *y = b;
+    return x->end < y->end ? -1 : x->end > y->end ? 1 : x->start < y->start ? -1 : x->start > y->start;
+}
+
+struct des_tmto_job {
+    const struct des_tmto *tmto;
+    int table;
+    uint64_t first;               // Chain number, which is also its start
+    uint64_t count;
+    struct des_tmto_chain *out;
+};
+
+static void *des_tmto_job_run(void *arg) {
+    struct des_tmto_job *job = arg;
+    for (uint64_t j = 0; j < job->count; j++) {
+        uint64_t start = (job->first + j) & job->tmto->positions;
+        job->out[j].start = start;
+        job->out[j].end = des_tmto_walk(job->tmto, job->table, start, 0, job->tmto->length);
+    }
+    return NULL;
+}
+
+// Builds chains first..first + count - 1 of table with threads threads,
+// sorted by end and without merged chains. Returns -1 (after printing why)
+// if they cannot be stored.
+static int des_tmto_build(const struct des_tmto *tmto, int table, uint64_t first, uint64_t count, int threads,
+                          struct des_tmto_table *out) {
+    out->count = 0;
+    out->chains = malloc((count ? count : 1) * sizeof(struct des_tmto_chain));
+    if (out->chains == NULL) {
+        printf("Error: Failed to allocate %llu chains.\n", (unsigned long long)count);
+        return -1;
+    }
+    struct des_tmto_job jobs[DES_TMTO_MAX_THREADS];
+    pthread_t ids[DES_TMTO_MAX_THREADS];
+    int running[DES_TMTO_MAX_THREADS];
+    for (int t = 0; t < threads; t++) {
+        uint64_t lo = count * (uint64_t)t / (uint64_t)threads;
+        uint64_t hi = count * (uint64_t)(t + 1) / (uint64_t)threads;
+        jobs[t] = (struct des_tmto_job){tmto, table, first + lo, hi - lo, out->chains + lo};
+        running[t] = t > 0 && pthread_create(&ids[t], NULL, des_tmto_job_run, &jobs[t]) == 0;
+    }
+    // The first slice, and any whose thread could not start, run here
+    for (int t = 0; t < threads; t++) {
+        if (!running[t]) {
+            des_tmto_job_run(&jobs[t]);
+        }
+    }
+    for (int t = 0; t < threads; t++) {
+        if (running[t]) {
+            pthread_join(ids[t], NULL);
+        }
+    }
+
+    qsort(out->chains, count, sizeof(struct des_tmto_chain), des_tmto_compare);
+    for (uint64_t j = 0; j < count; j++) {
+        if (out->count == 0 || out->chains[out->count - 1].end != out->chains[j].end) {
+            out->chains[out->count++] = out->chains[j];
+        }
+    }
+    return 0;
+}
+
+static void des_tmto_table_free(struct des_tmto_table *table) {
+    free(table->chains);
+    table->chains = NULL;
+    table->count = 0;
+}
+
+// Index of the chain of table ending at end, or -1
+static inline long des_tmto_find(const struct des_tmto_table *table, uint64_t end) {
+    size_t lo = 0, hi = table->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (table->chains[mid].end < end) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo < table->count && table->chains[lo].end == end ? (long)lo : -1;
+}
+
+// Checks whether column of chain holds a key giving ciphertext c, and
+// stores its counter if so. Returns 0 on a false alarm.
+static inline int des_tmto_check(const struct des_tmto *tmto, int table, const struct des_tmto_chain *chain,
+                                 uint64_t column, uint64_t c, uint64_t *counter) {
+    uint64_t position = des_tmto_walk(tmto, table, chain->start, 0, column);
+    if (des_tmto_encrypt(tmto, position) != c) {
+        return 0;
+    }
+    *counter = des_tmto_counter(tmto, position);
+    return 1;
+}
+
+// End of the chain that has the key of ciphertext c in column, for a lookup
+static inline uint64_t des_tmto_end(const struct des_tmto *tmto, int table, uint64_t column, uint64_t c) {
+    uint64_t position = des_tmto_reduce(tmto, table, column, c);
+    return des_tmto_walk(tmto, table, position, column + 1, tmto->length);
+}
+
+static void des_tmto_header_fill(struct des_tmto_header *h, const struct des_tmto *tmto, int part, int parts) {
+    memset(h, 0, sizeof(*h));
+    strncpy(h->magic, DES_TMTO_MAGIC, sizeof(h->magic) - 1);
+    for (int i = 0; i < 8; i++) {
+        h->plaintext = (h->plaintext << 8) | tmto->plaintext[i];
+    }
+    h->bits = (uint64_t)tmto->bits;
+    h->free = tmto->mask != NULL ? tmto->mask->free : 0;
+    h->fixed = tmto->mask != NULL ? tmto->mask->fixed : 0;
+    h->length = tmto->length;
+    h->chains = tmto->chains;
+    h->tables = (uint64_t)tmto->tables;
+    h->part = (uint64_t)part;
+    h->parts = (uint64_t)parts;
+}
+
+// Writes the tables of one process to file, through a temporary file.
+// Returns -1 (after printing why) on failure.
+static int des_tmto_write(const char *file, const struct des_tmto *tmto, const struct des_tmto_table *tables,
+                          int part, int parts) {
+    char temp[4112];
+    snprintf(temp, sizeof(temp), "%s.tmp", file);
+    struct des_tmto_header h;
+    des_tmto_header_fill(&h, tmto, part, parts);
+    FILE *out = fopen(temp, "wb");
+    int ok = out != NULL && fwrite(&h, sizeof(h), 1, out) == 1;
+    for (int t = 0; ok && t < tmto->tables; t++) {
+        uint64_t count = tables[t].count;
+        ok = fwrite(&count, sizeof(count), 1, out) == 1
+             && fwrite(tables[t].chains, sizeof(struct des_tmto_chain), count, out) == count;
+    }
+    if (out != NULL) {
+        ok = fclose(out) == 0 && ok;
+    }
+    ok = ok && rename(temp, file) == 0;
+    if (!ok) {
+        printf("Error: cannot write table %s\n", file);
+        return -1;
+    }
+    return 0;
+}
+
+// Reads the header of file. Returns -1 (after printing why) if it is not a
+// table file.
+static int des_tmto_read_header(const char *file, struct des_tmto_header *h) {
+    FILE *in = fopen(file, "rb");
+    int ok = in != NULL && fread(h, sizeof(*h), 1, in) == 1
+             && strncmp(h->magic, DES_TMTO_MAGIC, sizeof(h->magic)) == 0 && h->tables >= 1
+             && h->tables <= DES_TMTO_MAX_TABLES && h->parts >= 1 && h->bits >= 1 && h->bits <= KEYSPACE_BITS;
+    if (in != NULL) {
+        fclose(in);
+    }
+    if (!ok) {
+        printf("Error: %s is missing or not a table file\n", file);
+        return -1;
+    }
+    return 0;
+}
+
+// Reads the tables of file, which must have header h (from another file
+// of the set). Returns -1 (after printing why) on failure.
+static int des_tmto_read(const char *file, const struct des_tmto_header *h, struct des_tmto_table *tables) {
+    FILE *in = fopen(file, "rb");
+    struct des_tmto_header own;
+    int ok = in != NULL && fread(&own, sizeof(own), 1, in) == 1;
+    ok = ok && memcmp(&own, h, offsetof(struct des_tmto_header, part)) == 0 && own.parts == h->parts;
+    for (uint64_t t = 0; t < h->tables; t++) {
+        tables[t].count = 0;
+        tables[t].chains = NULL;
+    }
+    for (uint64_t t = 0; ok && t < h->tables; t++) {
+        uint64_t count;
+        ok = fread(&count, sizeof(count), 1, in) == 1 && count <= h->chains;
+        if (ok) {
+            tables[t].chains = malloc((count ? count : 1) * sizeof(struct des_tmto_chain));
+            ok = tables[t].chains != NULL
+                 && fread(tables[t].chains, sizeof(struct des_tmto_chain), count, in) == count;
+            tables[t].count = count;
+        }
+    }
+    if (in != NULL) {
+        fclose(in);
+    }
+    if (!ok) {
+        printf("Error: table %s is missing, damaged or from another set\n", file);
+        for (uint64_t t = 0; t < h->tables; t++) {
+            des_tmto_table_free(&tables[t]);
+        }
+        return -1;
+    }
+    return 0;
+}
+
+#endif
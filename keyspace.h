@@ -0,0 +1,320 @@
+#ifndef KEYSPACE_H
+#define KEYSPACE_H
+
+// Mapping between search counters and DES keys.
+//
+// DES only uses the upper 7 bits of every key byte; the lowest bit is a
+// parity bit that the cipher ignores. Counters in [0, KEYSPACE_SIZE) are
+// spread 7 bits per byte (byte 7 holds the least significant 7 bits) and the
+// parity bit is set to odd parity, so every counter is a distinct key and
+// every one of the 2^56 effective keys has exactly one counter.
+
+#include <stdint.h>
+#include <string.h>
+#include <openssl/des.h>
+
+#define KEYSPACE_BITS 56
+#define KEYSPACE_SIZE (1ULL << KEYSPACE_BITS)
+
+// Sets the low bit of a key byte so the byte has an odd number of ones
+static inline uint8_t keyspace_odd_parity(uint8_t byte) {
+    return (uint8_t)((byte & 0xFE) | !__builtin_parity(byte & 0xFE));
+}
+
+static inline void keyspace_counter_to_key(uint64_t counter, DES_cblock *key) {
+    for (int i = 7; i >= 0; i--) {
+        (*key)[i] = keyspace_odd_parity((uint8_t)((counter & 0x7F) << 1));
+        counter >>= 7;
+    }
+}
+
+// Inverse of keyspace_counter_to_key (parity bits are ignored)
+static inline uint64_t keyspace_key_to_counter(const DES_cblock *key) {
+    uint64_t counter = 0;
+    for (int i = 0; i < 8; i++) {
+        counter = (counter << 7) | ((*key)[i] >> 1);
+    }
+    return counter;
+}
+
+// Order in which a range of search positions visits key counters
+enum keyspace_order {
+    KEYSPACE_ORDER_LINEAR,   // Position i tests counter i
+    KEYSPACE_ORDER_GRAY      // Position i tests counter i ^ (i >> 1), see des_gray.h
+};
+
+static inline uint64_t keyspace_gray_code(uint64_t position) {
+    return position ^ (position >> 1);
+}
+
+static inline uint64_t keyspace_position_to_counter(enum keyspace_order order, uint64_t position) {
+    if (order == KEYSPACE_ORDER_GRAY) {
+        return keyspace_gray_code(position);
+    }
+    return position;
+}
+
+// Which way each process walks its positions and, for the last three, which
+// counter each position stands for. Every traversal is a bijection on the
+// searched range [begin, end), so the processes still cover it completely
+// and without overlap; only the time at which each key is reached changes.
+enum keyspace_traversal {
+    KEYSPACE_TRAVERSAL_FORWARD,       // Every process walks its positions upwards
+    KEYSPACE_TRAVERSAL_REVERSE,       // Every process walks its positions downwards
+    KEYSPACE_TRAVERSAL_BIDIRECTIONAL, // Even processes upwards, odd ones downwards
+    KEYSPACE_TRAVERSAL_INTERLEAVED,   // Process r of N tests begin + r, begin + r + N, ...
+    KEYSPACE_TRAVERSAL_BIT_REVERSED,  // Position i tests the counter with i's bits reversed
+    KEYSPACE_TRAVERSAL_RANDOM         // Position i tests a keyed pseudo-random permutation of i
+};
+
+// Rounds of the random traversal
+#define KEYSPACE_SHUFFLE_ROUNDS 4
+
+// Known and unknown counter bits (--key-pattern). The positions then only
+// enumerate the free bits: the i-th bit of a position goes to the i-th free
+// bit of the counter, so 2^bits positions cover every key matching the
+// pattern, whether or not the free bits are contiguous.
+struct keyspace_mask {
+    uint64_t free;                // Counter bits the positions enumerate
+    uint64_t fixed;               // Value of the other counter bits
+    int bits;                     // Free bits
+    uint8_t bit[KEYSPACE_BITS];   // Counter bit of each free bit, lowest first
+    // Per 7-bit digit of the counter: its free bits, where they start in
+    // a position, and the digit each combination of them spreads to
+    uint8_t digit_bits[8];
+    uint8_t digit_shift[8];
+    uint8_t digit[8][128];
+};
+
+// Sets up the mask of the free counter bits free (the others are taken from
+// fixed)
+static inline void keyspace_mask_init(struct keyspace_mask *mask, uint64_t free, uint64_t fixed) {
+    mask->free = free & (KEYSPACE_SIZE - 1);
+    mask->fixed = fixed & ~mask->free & (KEYSPACE_SIZE - 1);
+    mask->bits = 0;
+    for (int d = 0; d < 8; d++) {
+        uint8_t digit_free = (uint8_t)((mask->free >> (7 * d)) & 0x7F);
+        mask->digit_shift[d] = (uint8_t)mask->bits;
+        mask->digit_bits[d] = (uint8_t)__builtin_popcount(digit_free);
+        for (int b = 0; b < 7; b++) {
+            if ((digit_free >> b) & 1) {
+                mask->bit[mask->bits++] = (uint8_t)(7 * d + b);
+            }
+        }
+        for (int v = 0; v < (1 << mask->digit_bits[d]); v++) {
+            uint8_t spread = 0;
+            for (int b = 0, used = 0; b < 7; b++) {
+                if ((digit_free >> b) & 1) {
+                    spread |= (uint8_t)(((v >> used++) & 1) << b);
+                }
+            }
+            mask->digit[d][v] = spread;
+        }
+    }
+}
+
+// Counter of the x-th key matching the mask (x < 2^bits)
+static inline uint64_t keyspace_mask_deposit(const struct keyspace_mask *mask, uint64_t x) {
+    uint64_t counter = mask->fixed;
+    for (int d = 0; d < 8; d++) {
+        uint64_t v = (x >> mask->digit_shift[d]) & ((1u << mask->digit_bits[d]) - 1);
+        counter |= (uint64_t)mask->digit[d][v] << (7 * d);
+    }
+    return counter;
+}
+
+// Counter of the key after counter in the enumeration order of the mask
+static inline uint64_t keyspace_mask_next(const struct keyspace_mask *mask, uint64_t counter) {
+    return (((counter | ~mask->free) + 1) & mask->free) | mask->fixed;
+}
+
+// Position to counter map of a search: the interleaved, bit-reversed and
+// random traversals over [begin, end), then the key mask if there is one.
+// Bit-reversed and random permute the offsets from begin within the
+// smallest power of two holding the range and, while the result falls
+// outside it, permute again (cycle walking); that stays a bijection on the
+// range, and takes under two steps on average.
+struct keyspace_map {
+    enum keyspace_traversal traversal;
+    const struct keyspace_mask *mask; // NULL: positions are counters
+    uint64_t begin;
+    uint64_t size;                // end - begin
+    int bits;                     // Of the power of two holding the range
+    uint64_t wrap;                // 2^bits - 1
+    uint64_t ways;                // Interleaved: processes
+    uint64_t share;               // Interleaved: positions per process (the static split)
+    uint64_t add[KEYSPACE_SHUFFLE_ROUNDS]; // Random: round keys
+    uint64_t mul[KEYSPACE_SHUFFLE_ROUNDS]; // Random: odd round multipliers
+    int shift;                    // Random: xorshift of every round
+};
+
+// Returns 1 if the process with this rank walks its positions downwards
+static inline int keyspace_traversal_down(enum keyspace_traversal traversal, int rank) {
+    return traversal == KEYSPACE_TRAVERSAL_REVERSE || (traversal == KEYSPACE_TRAVERSAL_BIDIRECTIONAL && rank % 2 != 0);
+}
+
+// Returns 1 if positions and counters differ under traversal
+static inline int keyspace_traversal_shuffles(enum keyspace_traversal traversal) {
+    return traversal >= KEYSPACE_TRAVERSAL_INTERLEAVED;
+}
+
+// Returns 1 if map changes which counter a position tests
+static inline int keyspace_map_active(const struct keyspace_map *map) {
+    return keyspace_traversal_shuffles(map->traversal) || map->mask != NULL;
+}
+
+static inline uint64_t keyspace_splitmix(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Sets up the map of traversal over [begin, end) (end <= KEYSPACE_SIZE) for
+// ways processes, followed by mask (NULL for none, else it must outlive
+// the map); seed keys the random traversal
+static inline void keyspace_map_init(struct keyspace_map *map, enum keyspace_traversal traversal, uint64_t begin,
+                                     uint64_t end, int ways, uint64_t seed, const struct keyspace_mask *mask) {
+    map->traversal = traversal;
+    map->mask = mask;
+    map->begin = begin;
+    map->size = end - begin;
+    map->bits = 1;
+    while (map->bits < KEYSPACE_BITS && (1ULL << map->bits) < map->size) {
+        map->bits++;
+    }
+    map->wrap = (1ULL << map->bits) - 1;
+    map->ways = (uint64_t)ways;
+    map->share = map->size / map->ways;
+    map->shift = map->bits / 2 + 1;
+    for (int r = 0; r < KEYSPACE_SHUFFLE_ROUNDS; r++) {
+        map->add[r] = keyspace_splitmix(&seed) & map->wrap;
+        map->mul[r] = (keyspace_splitmix(&seed) | 1) & map->wrap;
+    }
+}
+
+// One step of the bit-reversed or random permutation of [0, 2^bits). Each
+// round of the random one is invertible modulo 2^bits: adding a key,
+// multiplying by an odd number and xor-ing in the value shifted right.
+static inline uint64_t keyspace_map_step(const struct keyspace_map *map, uint64_t x) {
+    if (map->traversal == KEYSPACE_TRAVERSAL_BIT_REVERSED) {
+        x = ((x >> 1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) << 1);
+        x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+        x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+        return __builtin_bswap64(x) >> (64 - map->bits);
+    }
+    for (int r = 0; r < KEYSPACE_SHUFFLE_ROUNDS; r++) {
+        x = ((x + map->add[r]) * map->mul[r]) & map->wrap;
+        x ^= x >> map->shift;
+    }
+    return x;
+}
+
+// Position of the masked space tested at position (in [begin, end)) under
+// the traversal
+static inline uint64_t keyspace_map_position(const struct keyspace_map *map, uint64_t position) {
+    uint64_t x = position - map->begin;
+    switch (map->traversal) {
+    case KEYSPACE_TRAVERSAL_INTERLEAVED:
+        // Process r's share of the static split holds r, r + N, ...; the
+        // remainder, which the last process also gets, stays in place
+        if (map->share != 0 && x < map->share * map->ways) {
+            x = (x % map->share) * map->ways + x / map->share;
+        }
+        return map->begin + x;
+    case KEYSPACE_TRAVERSAL_BIT_REVERSED:
+    case KEYSPACE_TRAVERSAL_RANDOM:
+        do {
+            x = keyspace_map_step(map, x);
+        } while (x >= map->size);
+        return map->begin + x;
+    default:
+        return position;
+    }
+}
+
+// Counter tested at position under order and, if not NULL, map. A
+// shuffling traversal is never combined with the Gray order (des_gray.h
+// walks consecutive positions); a mask applies after either.
+static inline uint64_t keyspace_search_counter(enum keyspace_order order, const struct keyspace_map *map,
+                                               uint64_t position) {
+    if (map == NULL) {
+        return keyspace_position_to_counter(order, position);
+    }
+    uint64_t x = keyspace_traversal_shuffles(map->traversal) ? keyspace_map_position(map, position)
+                                                             : keyspace_position_to_counter(order, position);
+    return map->mask != NULL ? keyspace_mask_deposit(map->mask, x) : x;
+}
+
+// Walks the counters of [lower, upper] in order, producing each key by
+// incrementing the previous one instead of converting the counter again
+struct keyspace_iter {
+    uint64_t counter;
+    uint64_t upper;
+    DES_cblock key;
+    int started;
+};
+
+static inline void keyspace_iter_init(struct keyspace_iter *it, uint64_t lower, uint64_t upper) {
+    it->counter = lower;
+    it->upper = upper;
+    it->started = 0;
+    keyspace_counter_to_key(lower, &it->key);
+}
+
+// Returns 0 once the range is exhausted
+static inline int keyspace_iter_next(struct keyspace_iter *it) {
+    if (!it->started) {
+        it->started = 1;
+        return it->counter <= it->upper;
+    }
+    if (it->counter >= it->upper) {
+        return 0;
+    }
+    it->counter++;
+
+    // Add one to the 7-bit digits, carrying towards byte 0
+    for (int i = 7; i >= 0; i--) {
+        uint8_t digit = (uint8_t)(((it->key[i] >> 1) + 1) & 0x7F);
+        it->key[i] = keyspace_odd_parity((uint8_t)(digit << 1));
+        if (digit != 0) {
+            break;
+        }
+    }
+    return 1;
+}
+
+// Fills keys with the count keys tested at positions [base, base + count)
+// under order and map (NULL for none)
+static inline void keyspace_fill(enum keyspace_order order, const struct keyspace_map *map, uint64_t base,
+                                 int count, DES_cblock *keys) {
+    if (map != NULL && map->mask != NULL && order == KEYSPACE_ORDER_LINEAR
+        && !keyspace_traversal_shuffles(map->traversal)) {
+        // Consecutive positions: step through the free bits directly
+        uint64_t counter = keyspace_mask_deposit(map->mask, base);
+        for (int l = 0; l < count; l++) {
+            keyspace_counter_to_key(counter, &keys[l]);
+            counter = keyspace_mask_next(map->mask, counter);
+        }
+        return;
+    }
+    if (map != NULL) {
+        for (int l = 0; l < count; l++) {
+            keyspace_counter_to_key(keyspace_search_counter(order, map, base + l), &keys[l]);
+        }
+        return;
+    }
+    if (order == KEYSPACE_ORDER_LINEAR) {
+        struct keyspace_iter it;
+        keyspace_iter_init(&it, base, base + count - 1);
+        for (int l = 0; keyspace_iter_next(&it); l++) {
+            memcpy(keys[l], it.key, sizeof(DES_cblock));
+        }
+        return;
+    }
+    for (int l = 0; l < count; l++) {
+        keyspace_counter_to_key(keyspace_position_to_counter(order, base + l), &keys[l]);
+    }
+}
+
+#endif
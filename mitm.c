@@ -0,0 +1,350 @@
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <mpi.h>
+#include <openssl/des.h>
+
+#include "des_bitslice.h"
+#include "des_gray.h"
+#include "keyspace.h"
+#include "search_file.h"
+#include "search_mitm.h"
+#include "search_options.h"
+
+// Flags this program accepts (search_options.h)
+#define PROGRAM_OPTIONS (SEARCH_OPT_BACKEND | SEARCH_OPT_ORDER | SEARCH_OPT_TRAVERSAL | SEARCH_OPT_RANGE \
+                         | SEARCH_OPT_MITM)
+
+// DES key size
+#define DES_KEY_SIZE 8
+
+// Function to decrypt using OpenSSL DES in CBC mode
+void decrypt_with_key(const uint8_t *ciphertext, uint8_t *plaintext, const DES_cblock *key, const DES_cblock *iv,size_t length) {
+    DES_key_schedule schedule;
+    DES_set_key(key, &schedule);  // Set up the key schedule
+
+    // Decrypt the cipher using DES in CBC mode
+    DES_cbc_encrypt(ciphertext, plaintext, length, &schedule, (DES_cblock *)iv, DES_DECRYPT);
+}
+
+// Function to encrypt using OpenSSL DES in CBC mode
+void encrypt_with_key(const uint8_t *plaintext, uint8_t *ciphertext, const DES_cblock *key, const DES_cblock *iv,size_t length) {
+    DES_key_schedule schedule;
+    DES_set_key(key, &schedule);  // Set up the key schedule
+
+    // Encrypt the plaintext using DES in CBC mode
+    DES_cbc_encrypt(plaintext, ciphertext, length, &schedule, (DES_cblock *)iv, DES_ENCRYPT);
+}
+
+void print_key(const uint8_t *key, int size) {
+    printf("Key: ");
+    for (int i = 0; i < size; i++) {
+        printf("%02x ", key[i]);
+    }
+    printf("\n");
+}
+
+void long_to_des_key(unsigned long long key, DES_cblock *des_key) {
+    // Spread the 56 key bits over the 7 used bits of each byte, skipping the
+    // parity bits DES ignores (see keyspace.h)
+    keyspace_counter_to_key(key, des_key);
+}
+
+// Encrypts (or decrypts) the padded text with both keys of the cipher
+void chained_cbc(enum search_cipher cipher, const uint8_t *in, uint8_t *out, uint8_t *scratch, size_t length,
+                 DES_cblock *key1, DES_cblock *key2, int enc) {
+    DES_cblock iv = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    if (cipher == SEARCH_CIPHER_3DES2) {
+        DES_key_schedule schedule1, schedule2;
+        DES_set_key_unchecked(key1, &schedule1);
+        DES_set_key_unchecked(key2, &schedule2);
+        DES_ede2_cbc_encrypt(in, out, (long)length, &schedule1, &schedule2, &iv, enc);
+    } else if (enc == DES_ENCRYPT) {
+        encrypt_with_key(in, scratch, key1, &iv, length);
+        encrypt_with_key(scratch, out, key2, &iv, length);
+    } else {
+        decrypt_with_key(in, scratch, key2, &iv, length);
+        decrypt_with_key(scratch, out, key1, &iv, length);
+    }
+}
+
+// The two sides of the search. With 2des the table holds the first block
+// encrypted with each key1 and the probes decrypt the first ciphertext
+// block with each key2 (the IV is zero, so both are the block between the
+// layers). Two-key triple DES has no block between two single-DES layers,
+// so the chosen-plaintext attack of Merkle and Hellman is used: the table
+// holds D_j(0) for each key2 j; the probe for key1 i asks the encryption
+// oracle for the ciphertext c of D_i(0), whose first layer then gives 0,
+// and decrypts it once more, D_i(c), which is D_j(0) for the right pair.
+// This program plays the oracle with the keys it was given.
+enum mitm_side {
+    MITM_TABLE,
+    MITM_PROBE
+};
+
+struct mitm_target {
+    enum search_cipher cipher;
+    enum search_backend backend;
+    enum keyspace_order order;
+    const struct keyspace_map *map;
+    const uint8_t *plaintext;
+    size_t length;
+    const uint8_t *ciphertext;
+    size_t padded_length;
+    DES_key_schedule oracle[2];   // 3des2: schedules of the keys being searched
+    uint8_t *decrypted;           // Verification buffers, padded_length bytes each
+    uint8_t *scratch;
+    DES_cblock *keys;             // Bitslice lanes
+    uint8_t *blocks;
+};
+
+static inline uint64_t mitm_block_value(const uint8_t *block) {
+    uint64_t value = 0;
+    for (int i = 0; i < DES_KEY_SIZE; i++) {
+        value = (value << 8) | block[i];
+    }
+    return value;
+}
+
+static inline void mitm_key(const struct mitm_target *t, uint64_t position, DES_cblock *key) {
+    long_to_des_key(keyspace_search_counter(t->order, t->map, position), key);
+}
+
+// Value of side for the key with schedule
+static inline uint64_t mitm_value(const struct mitm_target *t, enum mitm_side side, DES_key_schedule *schedule) {
+    static const DES_cblock zero = {0};
+    DES_cblock out, middle;
+    if (t->cipher == SEARCH_CIPHER_2DES) {
+        if (side == MITM_TABLE) {
+            DES_ecb_encrypt((DES_cblock *)t->plaintext, &out, schedule, DES_ENCRYPT);
+        } else {
+            DES_ecb_encrypt((DES_cblock *)t->ciphertext, &out, schedule, DES_DECRYPT);
+        }
+    } else {
+        DES_ecb_encrypt((DES_cblock *)&zero, &out, schedule, DES_DECRYPT);
+        if (side == MITM_PROBE) {
+            DES_ecb3_encrypt(&out, &middle, (DES_key_schedule *)&t->oracle[0], (DES_key_schedule *)&t->oracle[1],
+                             (DES_key_schedule *)&t->oracle[0], DES_ENCRYPT);
+            DES_ecb_encrypt(&middle, &out, schedule, DES_DECRYPT);
+        }
+    }
+    return mitm_block_value(out);
+}
+
+static void mitm_values(struct mitm_target *t, enum mitm_side side, uint64_t base, int count, uint64_t *values) {
+    // A side that is one decryption of a fixed block runs through the
+    // bitsliced kernel
+    int decrypts = t->cipher == SEARCH_CIPHER_2DES ? side == MITM_PROBE : side == MITM_TABLE;
+    if (t->backend == SEARCH_BACKEND_BITSLICE && decrypts) {
+        static const DES_cblock zero = {0};
+        const uint8_t *block = t->cipher == SEARCH_CIPHER_2DES ? t->ciphertext : zero;
+        int lanes = des_bs_lanes();
+        for (int i = 0; i < count; i += lanes) {
+            int n = count - i < lanes ? count - i : lanes;
+            keyspace_fill(t->order, t->map, base + (uint64_t)i, n, t->keys);
+            des_bs_decrypt_cbc(t->keys, n, block, DES_KEY_SIZE, &zero, t->blocks, DES_KEY_SIZE);
+            for (int l = 0; l < n; l++) {
+                values[i + l] = mitm_block_value(t->blocks + (size_t)l * DES_KEY_SIZE);
+            }
+        }
+        return;
+    }
+    if (t->order == KEYSPACE_ORDER_GRAY) {
+        struct des_gray_walk walk;
+        des_gray_walk_init(&walk, base, base + (uint64_t)count - 1, t->map->mask);
+        for (int i = 0; des_gray_walk_next(&walk); i++) {
+            values[i] = mitm_value(t, side, &walk.schedule);
+        }
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        DES_cblock key;
+        DES_key_schedule schedule;
+        mitm_key(t, base + (uint64_t)i, &key);
+        DES_set_key_unchecked(&key, &schedule);
+        values[i] = mitm_value(t, side, &schedule);
+    }
+}
+
+static void mitm_table_values(void *arg, uint64_t base, int count, uint64_t *values) {
+    mitm_values(arg, MITM_TABLE, base, count, values);
+}
+
+static void mitm_probe_values(void *arg, uint64_t base, int count, uint64_t *values) {
+    mitm_values(arg, MITM_PROBE, base, count, values);
+}
+
+// Counters of key1 and key2 from the positions of a table entry and a probe
+static void mitm_pair(const struct mitm_target *t, uint64_t table_position, uint64_t probe_position,
+                      unsigned long long *key1, unsigned long long *key2) {
+    unsigned long long table = keyspace_search_counter(t->order, t->map, table_position);
+    unsigned long long probe = keyspace_search_counter(t->order, t->map, probe_position);
+    *key1 = t->cipher == SEARCH_CIPHER_2DES ? table : probe;
+    *key2 = t->cipher == SEARCH_CIPHER_2DES ? probe : table;
+}
+
+// Decrypts the whole text with the candidate pair
+static int mitm_verify(void *arg, uint64_t table_position, uint64_t probe_position) {
+    struct mitm_target *t = arg;
+    unsigned long long key1, key2;
+    DES_cblock des_key1, des_key2;
+    mitm_pair(t, table_position, probe_position, &key1, &key2);
+    long_to_des_key(key1, &des_key1);
+    long_to_des_key(key2, &des_key2);
+    chained_cbc(t->cipher, t->ciphertext, t->decrypted, t->scratch, t->padded_length, &des_key1, &des_key2,
+                DES_DECRYPT);
+    return memcmp(t->decrypted, t->plaintext, t->length) == 0;
+}
+
+int main(int argc, char *argv[]) {
+    struct search_options opts;
+    if (parse_search_options(&argc, argv, PROGRAM_OPTIONS, &opts) != 0 || argc != 4) {
+        printf("Usage: %s [options] <plaintext_file> <key1> <key2>\n", argv[0]);
+        print_search_options(PROGRAM_OPTIONS);
+        return 1;
+    }
+    des_gray_init();
+    if (des_bs_init(opts.simd) != 0) {
+        return 1;
+    }
+
+    const char *plaintext_file = argv[1];
+    unsigned long long key1, key2;
+    if (parse_search_key(argv[2], &key1) != 0 || parse_search_key(argv[3], &key2) != 0) {
+        return 1;
+    }
+
+    size_t plaintext_length;
+    uint8_t *plaintext = read_plaintext_from_file(plaintext_file, &plaintext_length);
+    if (plaintext == NULL) {
+        return 1;
+    }
+
+    int N, id;
+    MPI_Comm comm = MPI_COMM_WORLD;
+    MPI_Init(&argc, &argv);
+    MPI_Comm_size(comm, &N);
+    MPI_Comm_rank(comm, &id);
+
+    if (opts.end - opts.start < (unsigned long long)N) {
+        if (id == 0) {
+            printf("Error: the key range holds fewer keys than there are processes\n");
+        }
+        free(plaintext);
+        MPI_Finalize();
+        return 1;
+    }
+
+    // The first block must be known whole: the table side encrypts it
+    size_t padded_length = (plaintext_length + DES_KEY_SIZE - 1) / DES_KEY_SIZE * DES_KEY_SIZE;
+    uint8_t *padded = (uint8_t *)calloc(padded_length, 1);
+    uint8_t *ciphertext = (uint8_t *)calloc(padded_length, 1);
+    uint8_t *decrypted = (uint8_t *)malloc(padded_length + 1);
+    uint8_t *scratch = (uint8_t *)malloc(padded_length);
+    if (padded == NULL || ciphertext == NULL || decrypted == NULL || scratch == NULL) {
+        printf("Error: Failed to allocate memory.\n");
+        MPI_Abort(comm, EXIT_FAILURE);
+    }
+    memcpy(padded, plaintext, plaintext_length);
+
+    DES_cblock des_key1, des_key2;
+    long_to_des_key(key1, &des_key1);
+    long_to_des_key(key2, &des_key2);
+
+    if (id == 0) {
+        // Process 0 will perform the encryption
+        printf("Plaintext: %.*s\n", (int)plaintext_length, plaintext);
+        printf("Encrypting with %s, keys:\n", opts.cipher == SEARCH_CIPHER_2DES ? "double DES" : "two-key triple DES");
+        print_key((uint8_t *)&des_key1, DES_KEY_SIZE);
+        print_key((uint8_t *)&des_key2, DES_KEY_SIZE);
+
+        chained_cbc(opts.cipher, padded, ciphertext, scratch, padded_length, &des_key1, &des_key2, DES_ENCRYPT);
+
+        printf("Ciphertext: ");
+        for (size_t i = 0; i < padded_length; i++) {
+            printf("%02x ", ciphertext[i]);
+        }
+        printf("\n");
+    }
+
+    // Broadcast the ciphertext to all processes
+    MPI_Bcast(ciphertext, padded_length, MPI_UNSIGNED_CHAR, 0, comm);
+
+    enum keyspace_traversal traversal = search_traversal(&opts, KEYSPACE_TRAVERSAL_FORWARD);
+    struct keyspace_map map;
+    struct keyspace_mask mask;
+    keyspace_map_init(&map, traversal, opts.start, opts.end, N, opts.seed, search_key_mask(&opts, &mask));
+
+    struct mitm_target target = {
+        .cipher = opts.cipher,
+        .backend = opts.backend,
+        .order = opts.order,
+        .map = &map,
+        .plaintext = padded,
+        .length = plaintext_length,
+        .ciphertext = ciphertext,
+        .padded_length = padded_length,
+        .decrypted = decrypted,
+        .scratch = scratch,
+        .keys = malloc(DES_BS_MAX_LANES * sizeof(DES_cblock)),
+        .blocks = malloc(DES_BS_MAX_LANES * DES_KEY_SIZE),
+    };
+    if (target.keys == NULL || target.blocks == NULL) {
+        printf("Error: Failed to allocate memory.\n");
+        MPI_Abort(comm, EXIT_FAILURE);
+    }
+    DES_set_key_unchecked(&des_key1, &target.oracle[0]);
+    DES_set_key_unchecked(&des_key2, &target.oracle[1]);
+
+    struct search_mitm mitm;
+    search_mitm_init(&mitm, comm, opts.start, opts.end, opts.memory, mitm_table_values, mitm_probe_values,
+                     mitm_verify, &target);
+
+    printf("Process %d: Computing the values of keys from %llx to %llx\n", id, (unsigned long long)mitm.lower,
+           (unsigned long long)mitm.upper - 1);
+    if (id == 0) {
+        if (opts.backend == SEARCH_BACKEND_BITSLICE) {
+            printf("Bitslice kernel: %s (%d keys per pass)\n", des_bs_kernel_name(), des_bs_lanes());
+        }
+        if (opts.masked) {
+            printf("Key pattern: %d unknown bits\n", opts.key_bits);
+        }
+        if (opts.cipher == SEARCH_CIPHER_3DES2) {
+            printf("Chosen plaintext: each probe asks for the encryption of one block under the keys above\n");
+        }
+        printf("Table split into %d passes of %llu MB per process\n", mitm.passes, opts.memory >> 20);
+    }
+
+    double start_time = MPI_Wtime();
+    search_mitm_run(&mitm);
+    double elapsed_time = MPI_Wtime() - start_time;
+    search_mitm_report(&mitm, elapsed_time);
+
+    if (id == 0 && !mitm.found) {
+        printf("Key pair not found\n");
+        printf("Time taken to search the key space: %f seconds\n", elapsed_time);
+    } else if (id == 0) {
+        unsigned long long found1, found2;
+        DES_cblock found_key1, found_key2;
+        mitm_pair(&target, mitm.table_position, mitm.probe_position, &found1, &found2);
+        long_to_des_key(found1, &found_key1);
+        long_to_des_key(found2, &found_key2);
+        chained_cbc(opts.cipher, ciphertext, decrypted, scratch, padded_length, &found_key1, &found_key2,
+                    DES_DECRYPT);
+        decrypted[plaintext_length] = '\0';
+
+        printf("Keys found: %llu %llu\nDecrypted: %s\n", found1, found2, decrypted);
+        printf("Time taken to find the keys: %f seconds\n", elapsed_time);
+    }
+
+    free(target.keys);
+    free(target.blocks);
+    free(scratch);
+    free(decrypted);
+    free(ciphertext);
+    free(padded);
+    free(plaintext);
+    MPI_Barrier(comm);
+    MPI_Finalize();
+    return 0;
+}
@@ -5,6 +5,14 @@
 #include <time.h>
 #include <stdlib.h>
 
+#include "des_bitslice.h"
+#include "des_gray.h"
+#include "keyspace.h"
+#include "search_options.h"
+
+// Flags this program accepts (search_options.h)
+#define PROGRAM_OPTIONS (SEARCH_OPT_BACKEND | SEARCH_OPT_ORDER)
+
 // DES key size
 #define DES_KEY_SIZE 8
 
@@ -39,33 +47,76 @@ int decrypt_with_key(const uint8_t *ciphertext, uint8_t *plaintext, const DES_cb
 }
 
 void long_to_des_key(unsigned long long key, DES_cblock *des_key) {
-    // We have to split the key into bytes and copy it into the DES_cblock (8 bytes).
-    for (int i = 0; i < 7; ++i) {
-        (*des_key)[7 - i] = (unsigned char)((key >> (i * 8)) & 0xFF);  // Big-endian byte order
+    // Spread the 56 key bits over the 7 used bits of each byte, skipping the
+    // parity bits DES ignores (see keyspace.h)
+    keyspace_counter_to_key(key, des_key);
+}
+
+// Test the keys at traversal positions [base, base + count), count <=
+// des_bs_lanes(), with the bitsliced backend. Returns the offset of the key
+// whose decryption equals correct_plaintext or -1.
+int try_keys_bitslice(uint64_t base, int count, enum keyspace_order order, const uint8_t *ciphertext, const uint8_t *correct_plaintext, const DES_cblock *iv) {
+    DES_cblock keys[DES_BS_MAX_LANES];
+    keyspace_fill(order, NULL, base, count, keys);
+
+    uint8_t expected[DES_KEY_SIZE], mask[DES_KEY_SIZE];
+    for (int i = 0; i < DES_KEY_SIZE; i++) {
+        expected[i] = correct_plaintext[i] ^ (*iv)[i];
+        mask[i] = 0xFF;
     }
-    (*des_key)[0] = 0x00;  // Ensure that the highest byte is zero for 56-bit key
+
+    uint64_t hits[DES_BS_MAX_LANES / 64];
+    des_bs_match_keys(keys, count, ciphertext, expected, mask, hits);
+    return des_bs_first_hit(hits, count);
 }
 
 // Function to brute-force the DES key
-void brute_force_des(const uint8_t *ciphertext, const uint8_t *correct_plaintext, int key_bits, const DES_cblock *iv) {
+void brute_force_des(const uint8_t *ciphertext, const uint8_t *correct_plaintext, int key_bits, const DES_cblock *iv, enum search_backend backend, enum keyspace_order order) {
     uint8_t key[DES_KEY_SIZE] = {0};
     uint8_t decrypted[DES_KEY_SIZE];
     uint64_t max_key = (1ULL << key_bits);  // Limit based on key size
     uint64_t i;
     
+    int lanes_per_pass = des_bs_lanes();
     struct timespec start_time, end_time;
     clock_gettime(CLOCK_MONOTONIC, &start_time);
     
+    struct des_gray_walk walk;
+    des_gray_walk_init(&walk, 0, max_key - 1, NULL);
+
     // Start brute-forcing keys
     for (i = 0; i < max_key; i++) {
         DES_cblock des_key;
-        long_to_des_key(i, &des_key);  // Copy only the relevant part of i to the key buffer
+
+        if (backend == SEARCH_BACKEND_BITSLICE) {
+            // Test des_bs_lanes() keys at once and only fall through on a hit
+            int count = (max_key - i < (unsigned long long)lanes_per_pass) ? (int)(max_key - i) : lanes_per_pass;
+            int lane = try_keys_bitslice(i, count, order, ciphertext, correct_plaintext, iv);
+            if (lane < 0) {
+                i += count - 1;
+                continue;
+            }
+            i += lane;
+        } else if (order == KEYSPACE_ORDER_GRAY) {
+            // The schedule follows the walk with one XOR per key; only fall
+            // through on a hit
+            des_gray_walk_next(&walk);
+            DES_cblock iv_copy;
+            memcpy(&iv_copy, iv, sizeof(DES_cblock));
+            DES_cbc_encrypt(ciphertext, decrypted, DES_KEY_SIZE, &walk.schedule, &iv_copy, DES_DECRYPT);
+            if (memcmp(decrypted, correct_plaintext, DES_KEY_SIZE) != 0) {
+                continue;
+            }
+        }
+        uint64_t counter = keyspace_position_to_counter(order, i);
+        long_to_des_key(counter, &des_key);  // Copy only the relevant part of i to the key buffer
+        memcpy(key, des_key, DES_KEY_SIZE);
 
         DES_cblock iv_copy;
         memcpy(&iv_copy, iv, sizeof(DES_cblock));
 
         // print_key(key, DES_KEY_SIZE);
-        decrypt_with_key(ciphertext, decrypted, (DES_cblock *)key, &iv_copy);
+        decrypt_with_key(ciphertext, decrypted, &des_key, &iv_copy);
 
         // printf("Decrypted: ");
         // for (int i = 0; i < DES_KEY_SIZE; i++) {
@@ -77,7 +128,7 @@ void brute_force_des(const uint8_t *ciphertext, const uint8_t *correct_plaintext
         if (memcmp(decrypted, correct_plaintext, DES_KEY_SIZE) == 0) {
             clock_gettime(CLOCK_MONOTONIC, &end_time);
             double time_taken = get_time_diff(start_time, end_time);
-            printf("Key found: %llx\n", (unsigned long long)i);
+            printf("Key found: %llx\n", (unsigned long long)counter);
             print_key(key, DES_KEY_SIZE);  // Print the found key
             printf("Decrypted: ");
             for (int i = 0; i < DES_KEY_SIZE; i++) {
@@ -96,7 +147,18 @@ void brute_force_des(const uint8_t *ciphertext, const uint8_t *correct_plaintext
 
 
 
-int main() {
+int main(int argc, char *argv[]) {
+    struct search_options opts;
+    if (parse_search_options(&argc, argv, PROGRAM_OPTIONS, &opts) != 0 || argc != 1) {
+        printf("Usage: %s [options]\n", argv[0]);
+        print_search_options(PROGRAM_OPTIONS);
+        return 1;
+    }
+    des_gray_init();
+    if (des_bs_init(opts.simd) != 0) {
+        return 1;
+    }
+
     const uint8_t plaintext[DES_KEY_SIZE] = {0x48, 0x65, 0x6C, 0x6C, 0x6F, 0x57, 0x72, 0x6C};  // Example: "HelloWrl"
     uint8_t ciphertext[DES_KEY_SIZE];
     DES_cblock iv = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};  // IV initialization
@@ -105,11 +167,8 @@ int main() {
     for (int key_bits = 8; key_bits <= 56; key_bits += 8) { 
         printf("Trying key length %d\n", key_bits);
 
-        memset(generated_key, 0, DES_KEY_SIZE); 
-        
-        for (int i = 0; i < key_bits/8;++i){
-            generated_key[DES_KEY_SIZE - 1 - i] = 0xff;
-        }
+        // Last key of the key_bits-wide space (every effective bit set)
+        long_to_des_key((1ULL << key_bits) - 1, (DES_cblock *)generated_key);
 
         print_key(generated_key, DES_KEY_SIZE); 
 
@@ -127,7 +186,7 @@ int main() {
         printf("\n");
 
         // Brute-force DES to recover the key
-        brute_force_des(ciphertext, plaintext, key_bits, &iv);
+        brute_force_des(ciphertext, plaintext, key_bits, &iv, opts.backend, opts.order);
     }
 
     return 0;
@@ -5,6 +5,16 @@
 #include <time.h>
 #include <stdlib.h>
 
+#include "des_bitslice.h"
+#include "des_gray.h"
+#include "des_match.h"
+#include "keyspace.h"
+#include "search_file.h"
+#include "search_options.h"
+
+// Flags this program accepts (search_options.h)
+#define PROGRAM_OPTIONS (SEARCH_OPT_BACKEND | SEARCH_OPT_ORDER | SEARCH_OPT_KEYWORDS)
+
 
 // DES key size
 #define DES_KEY_SIZE 8
@@ -40,40 +50,94 @@ int decrypt_with_key(const uint8_t *ciphertext, uint8_t *plaintext, const DES_cb
 }
 
 void long_to_des_key(unsigned long long key, DES_cblock *des_key) {
-    // We have to split the key into bytes and copy it into the DES_cblock (8 bytes).
-    for (int i = 0; i < 7; ++i) {
-        (*des_key)[7 - i] = (unsigned char)((key >> (i * 8)) & 0xFF);  // Big-endian byte order
+    // Spread the 56 key bits over the 7 used bits of each byte, skipping the
+    // parity bits DES ignores (see keyspace.h)
+    keyspace_counter_to_key(key, des_key);
+}
+
+// Test the keys at traversal positions [base, base + count), count <=
+// des_bs_lanes(), with the bitsliced backend. lanes holds count buffers of
+// length + 1 bytes. Returns the offset of the key whose decryption matches
+// the keywords or -1.
+int try_keys_bitslice(uint64_t base, int count, enum keyspace_order order, const uint8_t *ciphertext, const struct des_match *match, const DES_cblock *iv, size_t length, uint8_t *lanes) {
+    DES_cblock keys[DES_BS_MAX_LANES];
+    keyspace_fill(order, NULL, base, count, keys);
+
+    des_bs_decrypt_cbc(keys, count, ciphertext, length, iv, lanes, length + 1);
+
+    for (int l = 0; l < count; l++) {
+        if (des_match_scan(match, lanes + l * (length + 1), length)) {
+            return l;
+        }
     }
-    (*des_key)[0] = 0x00;  // Ensure that the highest byte is zero for 56-bit key
+    return -1;
 }
 
 // Function to brute-force the DES key
-void brute_force_des(const uint8_t *ciphertext, const char *keyword, int key_bits, const DES_cblock *iv, size_t length) {
+void brute_force_des(const uint8_t *ciphertext, const struct des_match *match, int key_bits, const DES_cblock *iv, size_t length, enum search_backend backend, enum keyspace_order order) {
     uint8_t key[DES_KEY_SIZE] = {0};
-    uint8_t *decrypted = malloc(length);  // Decrypted buffer for the entire plaintext
+    uint8_t *decrypted = malloc(length + 1);  // Decrypted buffer for the entire plaintext
+    uint8_t *lanes = NULL;
+    if (backend == SEARCH_BACKEND_BITSLICE) {
+        lanes = malloc((size_t)des_bs_lanes() * (length + 1));
+    }
+    if (decrypted == NULL || (backend == SEARCH_BACKEND_BITSLICE && lanes == NULL)) {
+        printf("Error: Failed to allocate memory.\n");
+        free(decrypted);
+        free(lanes);
+        return;
+    }
     uint64_t max_key = (1ULL << key_bits);  // Limit based on key size
     uint64_t i;
 
+    int lanes_per_pass = des_bs_lanes();
     struct timespec start_time, end_time;
     clock_gettime(CLOCK_MONOTONIC, &start_time);
     
+    struct des_gray_walk walk;
+    des_gray_walk_init(&walk, 0, max_key - 1, NULL);
+
     // Start brute-forcing keys
     for (i = 0; i < max_key; i++) {
        DES_cblock des_key; 
-       long_to_des_key(i, &des_key);  // Copy only the relevant part of i to the key buffer
+
+        if (backend == SEARCH_BACKEND_BITSLICE) {
+            // Test des_bs_lanes() keys at once and only fall through on a hit
+            int count = (max_key - i < (unsigned long long)lanes_per_pass) ? (int)(max_key - i) : lanes_per_pass;
+            int lane = try_keys_bitslice(i, count, order, ciphertext, match, iv, length, lanes);
+            if (lane < 0) {
+                i += count - 1;
+                continue;
+            }
+            i += lane;
+        } else if (order == KEYSPACE_ORDER_GRAY) {
+            // The schedule follows the walk with one XOR per key; only fall
+            // through on a hit
+            des_gray_walk_next(&walk);
+            DES_cblock iv_copy;
+            memcpy(&iv_copy, iv, sizeof(DES_cblock));
+            DES_cbc_encrypt(ciphertext, decrypted, length, &walk.schedule, &iv_copy, DES_DECRYPT);
+            if (!des_match_scan(match, decrypted, length)) {
+                continue;
+            }
+        }
+        uint64_t counter = keyspace_position_to_counter(order, i);
+       long_to_des_key(counter, &des_key);  // Copy only the relevant part of i to the key buffer
         DES_cblock iv_copy;
         memcpy(&iv_copy, iv, sizeof(DES_cblock));
 
         decrypt_with_key(ciphertext, decrypted, des_key, &iv_copy, length);
-        // Check if the keyword exists in the decrypted text
-        if (strstr(decrypted, keyword) != NULL) {
+        // Check if the keywords are in the decrypted text
+        if (des_match_scan(match, decrypted, length)) {
+            decrypted[length] = '\0';
             clock_gettime(CLOCK_MONOTONIC, &end_time);
             double time_taken = get_time_diff(start_time, end_time);
-            printf("Key found: %llx\n", (unsigned long long)i);
+            printf("Key found: %llx\n", (unsigned long long)counter);
             print_key(des_key, DES_KEY_SIZE);  // Print the found key
             printf("Decrypted: %s\n", decrypted);  // Print the decrypted text
             printf("Time taken for key size %d bits: %f seconds\n", key_bits, time_taken);
             free(decrypted);
+            free(lanes);
             return;
         }
     }
@@ -83,56 +147,27 @@ void brute_force_des(const uint8_t *ciphertext, const char *keyword, int key_bit
     double time_taken = get_time_diff(start_time, end_time);
     printf("Key not found (key size: %d bits) in %f seconds.\n", key_bits, time_taken);
     free(decrypted);
+    free(lanes);
 }
 
 
-// Function to read the entire plaintext from a file
-uint8_t* read_plaintext_from_file(const char *filename, size_t *length) {
-    FILE *file = fopen(filename, "rb");
-    if (file == NULL) {
-        perror("Failed to open file");
-        return NULL;
-    }
-
-    // Get the file size
-    fseek(file, 0, SEEK_END);
-    long file_size = ftell(file);
-    rewind(file);
-
-    if (file_size <= 0) {
-        printf("Error: File is empty or has invalid size.\n");
-        fclose(file);
-        return NULL;
-    }
-
-    // Allocate memory for the file contents
-    uint8_t *buffer = (uint8_t *)malloc(file_size);
-    if (buffer == NULL) {
-        printf("Error: Failed to allocate memory.\n");
-        fclose(file);
-        return NULL;
-    }
-
-    // Read the entire file into the buffer
-    size_t bytes_read = fread(buffer, 1, file_size, file);
-    if (bytes_read != file_size) {
-        printf("Error: Failed to read entire file.\n");
-        free(buffer);
-        fclose(file);
-        return NULL;
-    }
-
-    *length = file_size;  // Set the length of the plaintext
-    fclose(file);
-    return buffer;
-}
-
 int main(int argc, char *argv[]) {
-    if (argc != 2) {
-        printf("Usage: %s <plaintext_file>\n", argv[0]);
+    struct search_options opts;
+    if (parse_search_options(&argc, argv, PROGRAM_OPTIONS, &opts) != 0 || argc != 2) {
+        printf("Usage: %s [options] <plaintext_file>\n", argv[0]);
+        print_search_options(PROGRAM_OPTIONS);
+        return 1;
+    }
+    des_gray_init();
+    if (des_bs_init(opts.simd) != 0) {
         return 1;
     }
     const char keyword[] = "una prueba del";
+    const char *keywords[SEARCH_MAX_KEYWORDS];
+    struct des_match match;
+    if (des_match_init(&match, keywords, search_keywords(&opts, keyword, keywords), opts.match) != 0) {
+        return 1;
+    }
 
 
     const char *plaintext_file = argv[1];
@@ -142,17 +177,17 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
-    uint8_t *ciphertext = (uint8_t *)malloc(plaintext_length);  // Buffer for ciphertext
+    // DES_cbc_encrypt writes whole blocks, so round the buffer up
+    size_t padded_length = (plaintext_length + DES_KEY_SIZE - 1) / DES_KEY_SIZE * DES_KEY_SIZE;
+    uint8_t *ciphertext = (uint8_t *)calloc(padded_length, 1);  // Buffer for ciphertext
     DES_cblock iv = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};  // IV initialization
     uint8_t generated_key[DES_KEY_SIZE];
     
     for (int key_bits = 8; key_bits <= 9; key_bits += 8) { 
         printf("Trying key length %d\n", key_bits);
 
-        memset(generated_key, 0, DES_KEY_SIZE);
-        for (int i = 0; i < key_bits/8;++i){
-            generated_key[DES_KEY_SIZE - 1 - i] = 0xff;
-        }
+        // Last key of the key_bits-wide space (every effective bit set)
+        long_to_des_key((1ULL << key_bits) - 1, (DES_cblock *)generated_key);
         print_key(generated_key, DES_KEY_SIZE);
 
         // Encrypt the entire plaintext using the generated key
@@ -165,10 +200,11 @@ int main(int argc, char *argv[]) {
         printf("\n");
 
         // Brute-force DES to recover the key
-        brute_force_des(ciphertext, keyword, key_bits, &iv, plaintext_length);
+        brute_force_des(ciphertext, &match, key_bits, &iv, plaintext_length, opts.backend, opts.order);
     }
 
     free(plaintext);  // Free allocated memory
     free(ciphertext);  // Free allocated memory
+    des_match_free(&match);
     return 0;
 }
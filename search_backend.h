@@ -0,0 +1,12 @@
+#ifndef SEARCH_BACKEND_H
+#define SEARCH_BACKEND_H
+
+// How a search context decrypts its keys (--backend), apart from
+// search_options.h so that search_context.h can name it without the parser.
+
+enum search_backend {
+    SEARCH_BACKEND_OPENSSL,   // DES_set_key + DES_cbc_encrypt per key
+    SEARCH_BACKEND_BITSLICE   // des_bitslice.h, 64 to 512 keys per pass
+};
+
+#endif
@@ -0,0 +1,262 @@
+#ifndef SEARCH_CHECKPOINT_H
+#define SEARCH_CHECKPOINT_H
+
+// Checkpoints of the searched part of the key space.
+//
+// With --checkpoint=PATH every process writes the traversal positions its
+// workers have completed to PATH.<rank> on its local disk, every
+// --checkpoint-interval seconds and once more when it stops. Positions are
+// global (the same for every rank count and distribution), so a file is
+// just a list of intervals plus a fingerprint of the search it belongs to.
+// Each write goes to a temporary file that is renamed over the previous
+// checkpoint, so a crash while writing leaves the old one intact.
+//
+// With --resume rank 0 reads PATH.0, which says how many processes the run
+// had, and the files of the other processes, then broadcasts the union. The
+// pool never hands out those positions, so the new run may use any number
+// of processes. Rank 0 includes the resumed positions in its own
+// checkpoints, so nothing is lost if the new run is interrupted too. Files
+// copied from other nodes only have to be placed next to PATH.0. Every file
+// with the right fingerprint records keys that really were searched, so a
+// stale or missing file can only cost repeated work, never a skipped key.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <mpi.h>
+
+#include "des_check.h"
+#include "search_coverage.h"
+#include "search_options.h"
+#include "search_pool.h"
+
+#define SEARCH_CHECKPOINT_MAGIC "des-search-checkpoint 1"
+
+struct search_checkpoint {
+    const char *path;             // Prefix of the files, NULL = no checkpoints
+    MPI_Comm comm;
+    int id;
+    int size;
+    double interval;              // Seconds between writes
+    double written_at;            // MPI_Wtime() of the last write
+    uint64_t fingerprint;         // Of the text, keywords, IV, offset, order, traversal and range
+    struct search_coverage resumed; // Positions searched by the resumed run
+};
+
+static uint64_t search_checkpoint_hash(uint64_t hash, const void *data, size_t length) {
+    const uint8_t *bytes = (const uint8_t *)data;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ULL;  // FNV-1a
+    }
+    return hash;
+}
+
+static uint64_t search_checkpoint_fingerprint(const struct des_check *check, enum keyspace_order order,
+                                              const struct keyspace_map *map, uint64_t start, uint64_t end) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    uint64_t length = check->length;
+    uint64_t offset = (uint64_t)check->offset;
+    uint64_t ord = (uint64_t)order;
+    hash = search_checkpoint_hash(hash, &length, sizeof(length));
+    hash = search_checkpoint_hash(hash, check->ciphertext, check->length);
+    hash = search_checkpoint_hash(hash, check->iv, sizeof(DES_cblock));
+    hash = search_checkpoint_hash(hash, check->keyword, check->keyword_length);
+    if (check->match.count > 1) {
+        // Checkpoints of single-keyword searches keep their fingerprint
+        uint64_t mode = (uint64_t)check->match.mode;
+        for (int k = 1; k < check->match.count; k++) {
+            hash = search_checkpoint_hash(hash, check->keywords[k], strlen(check->keywords[k]) + 1);
+        }
+        hash = search_checkpoint_hash(hash, &mode, sizeof(mode));
+    }
+    hash = search_checkpoint_hash(hash, &offset, sizeof(offset));
+    hash = search_checkpoint_hash(hash, &ord, sizeof(ord));
+    if (keyspace_traversal_shuffles(map->traversal)) {
+        // Positions stand for other counters. The direction of the walk
+        // does not matter, so the other traversals keep the fingerprint.
+        uint64_t traversal = (uint64_t)map->traversal;
+        hash = search_checkpoint_hash(hash, &traversal, sizeof(traversal));
+        if (map->traversal == KEYSPACE_TRAVERSAL_INTERLEAVED) {
+            hash = search_checkpoint_hash(hash, &map->ways, sizeof(map->ways));
+        } else if (map->traversal == KEYSPACE_TRAVERSAL_RANDOM) {
+            hash = search_checkpoint_hash(hash, map->add, sizeof(map->add));
+            hash = search_checkpoint_hash(hash, map->mul, sizeof(map->mul));
+        }
+    }
+    if (map->mask != NULL) {
+        // Positions only enumerate the free bits
+        hash = search_checkpoint_hash(hash, &map->mask->free, sizeof(map->mask->free));
+        hash = search_checkpoint_hash(hash, &map->mask->fixed, sizeof(map->mask->fixed));
+    }
+    if (start != 0) {
+        // Searches of the whole space or of --key-bits keep their fingerprint
+        hash = search_checkpoint_hash(hash, &start, sizeof(start));
+    }
+    return search_checkpoint_hash(hash, &end, sizeof(end));
+}
+
+// Adds the intervals of one checkpoint file to the resumed set and stores
+// the process count it was written with. Returns -1 (after printing why) if
+// the file cannot be read or belongs to another search.
+static int search_checkpoint_read(struct search_checkpoint *ckpt, const char *file, int *processes) {
+    FILE *in = fopen(file, "r");
+    if (in == NULL) {
+        printf("Error: cannot open checkpoint %s\n", file);
+        return -1;
+    }
+
+    char magic[64];
+    unsigned long long fingerprint, count, lo, hi;
+    int rank;
+    int ok = fgets(magic, sizeof(magic), in) != NULL
+             && strncmp(magic, SEARCH_CHECKPOINT_MAGIC, strlen(SEARCH_CHECKPOINT_MAGIC)) == 0
+             && fscanf(in, " fingerprint %llx process %d of %d intervals %llu", &fingerprint, &rank, processes,
+                       &count) == 4
+             && *processes > 0;
+    if (ok && fingerprint != ckpt->fingerprint) {
+        printf("Error: checkpoint %s belongs to another search (text, keywords, offset, --order, --traversal or --key-pattern)\n", file);
+        fclose(in);
+        return -1;
+    }
+    for (unsigned long long i = 0; ok && i < count; i++) {
+        ok = fscanf(in, " %llx %llx", &lo, &hi) == 2 && lo <= hi
+             && search_coverage_add(&ckpt->resumed, lo, hi) == 0;
+    }
+    fclose(in);
+    if (!ok) {
+        printf("Error: checkpoint %s is damaged\n", file);
+        return -1;
+    }
+    return 0;
+}
+
+// Rank 0: reads PATH.0 and the files of the other processes it names
+static int search_checkpoint_load(struct search_checkpoint *ckpt) {
+    char file[4096];
+    int processes;
+    snprintf(file, sizeof(file), "%s.0", ckpt->path);
+    if (search_checkpoint_read(ckpt, file, &processes) != 0) {
+        return -1;
+    }
+    for (int rank = 1; rank < processes; rank++) {
+        int ignored;
+        snprintf(file, sizeof(file), "%s.%d", ckpt->path, rank);
+        if (access(file, F_OK) != 0) {
+            printf("Warning: checkpoint %s is missing, its keys will be searched again\n", file);
+            continue;
+        }
+        if (search_checkpoint_read(ckpt, file, &ignored) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Collective. With --resume, rank 0 loads the checkpoint and every process
+// receives the positions to skip. Returns -1 on every process (after rank 0
+// printed why) if the checkpoint cannot be used.
+static int search_checkpoint_init(struct search_checkpoint *ckpt, MPI_Comm comm, const struct search_options *opts,
+                                  const struct des_check *check, const struct keyspace_map *map) {
+    ckpt->path = opts->checkpoint;
+    ckpt->comm = comm;
+    MPI_Comm_rank(comm, &ckpt->id);
+    MPI_Comm_size(comm, &ckpt->size);
+    ckpt->interval = opts->checkpoint_interval;
+    ckpt->written_at = MPI_Wtime();
+    ckpt->fingerprint = search_checkpoint_fingerprint(check, opts->order, map, opts->start, opts->end);
+    search_coverage_init(&ckpt->resumed);
+    if (!opts->resume) {
+        return 0;
+    }
+
+    int status = 0;
+    if (ckpt->id == 0) {
+        status = search_checkpoint_load(ckpt);
+    }
+    MPI_Bcast(&status, 1, MPI_INT, 0, comm);
+    if (status != 0) {
+        search_coverage_free(&ckpt->resumed);
+        return -1;
+    }
+
+    unsigned long long count = ckpt->resumed.count;
+    MPI_Bcast(&count, 1, MPI_UNSIGNED_LONG_LONG, 0, comm);
+    if (ckpt->id != 0) {
+        ckpt->resumed.items = malloc((count ? count : 1) * sizeof(struct search_interval));
+        if (ckpt->resumed.items == NULL) {
+            printf("Error: Failed to allocate the resumed checkpoint.\n");
+            MPI_Abort(comm, EXIT_FAILURE);
+        }
+        ckpt->resumed.count = count;
+        ckpt->resumed.capacity = count;
+    }
+    MPI_Bcast(ckpt->resumed.items, (int)(2 * count), MPI_UINT64_T, 0, comm);
+    if (ckpt->id == 0) {
+        printf("Resuming from %s: %llu keys already searched\n", ckpt->path,
+               (unsigned long long)search_coverage_total(&ckpt->resumed));
+    }
+    return 0;
+}
+
+// Writes this process's checkpoint: its completed chunks and, on rank 0,
+// the resumed positions
+static void search_checkpoint_save(struct search_checkpoint *ckpt, struct search_pool *pool) {
+    if (ckpt->path == NULL) {
+        return;
+    }
+    ckpt->written_at = MPI_Wtime();
+
+    struct search_coverage done;
+    search_coverage_init(&done);
+    if ((ckpt->id == 0 && search_coverage_merge(&done, &ckpt->resumed) != 0) || search_pool_done(pool, &done) != 0) {
+        printf("Warning: process %d skipped a checkpoint, out of memory\n", ckpt->id);
+        search_coverage_free(&done);
+        return;
+    }
+
+    char file[4096], temp[4112];
+    snprintf(file, sizeof(file), "%s.%d", ckpt->path, ckpt->id);
+    snprintf(temp, sizeof(temp), "%s.tmp", file);
+    FILE *out = fopen(temp, "w");
+    int ok = out != NULL;
+    if (ok) {
+        fprintf(out, "%s\nfingerprint %016llx\nprocess %d of %d\nintervals %zu\n", SEARCH_CHECKPOINT_MAGIC,
+                (unsigned long long)ckpt->fingerprint, ckpt->id, ckpt->size, done.count);
+        for (size_t i = 0; i < done.count; i++) {
+            fprintf(out, "%llx %llx\n", (unsigned long long)done.items[i].lo, (unsigned long long)done.items[i].hi);
+        }
+        ok = fflush(out) == 0 && fsync(fileno(out)) == 0;
+        ok = fclose(out) == 0 && ok;
+        ok = ok && rename(temp, file) == 0;
+    }
+    if (!ok) {
+        printf("Warning: process %d could not write checkpoint %s\n", ckpt->id, file);
+    }
+    search_coverage_free(&done);
+}
+
+// Makes the pool record its completed chunks and skip the resumed
+// positions, and writes a first checkpoint. Call before feeding the pool.
+static void search_checkpoint_attach(struct search_checkpoint *ckpt, struct search_pool *pool) {
+    if (ckpt->path == NULL && ckpt->resumed.count == 0) {
+        return;
+    }
+    search_pool_track(pool, ckpt->resumed.count ? &ckpt->resumed : NULL);
+    search_checkpoint_save(ckpt, pool);
+}
+
+// Called regularly by the thread that polls MPI; writes a checkpoint every
+// interval seconds
+static inline void search_checkpoint_tick(struct search_checkpoint *ckpt, struct search_pool *pool) {
+    if (ckpt->path != NULL && MPI_Wtime() - ckpt->written_at >= ckpt->interval) {
+        search_checkpoint_save(ckpt, pool);
+    }
+}
+
+// Frees the resumed positions; the pool using them must have been joined
+static void search_checkpoint_free(struct search_checkpoint *ckpt) {
+    search_coverage_free(&ckpt->resumed);
+}
+
+#endif
@@ -0,0 +1,146 @@
+#ifndef SEARCH_CONTEXT_H
+#define SEARCH_CONTEXT_H
+
+// Per-worker state of the key search.
+//
+// Everything a worker touches per key (the key schedule, the bitslice key
+// lanes and the decrypt buffers) lives in one context set up before the
+// search loop, so testing a key does no heap allocation. Each worker (rank
+// or thread) owns its own context; the des_checks it points to are read-only
+// and can be shared.
+//
+// A context tests every key against a set of targets (ciphertext and
+// keyword pairs, bruteforce_partB --batch): the key schedule, or the
+// bitslice key lanes, are set up once per key and reused for every target
+// not solved yet, so the key setup is shared by the whole batch.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <openssl/des.h>
+
+#include "des_bitslice.h"
+#include "des_check.h"
+#include "keyspace.h"
+#include "search_backend.h"
+
+// Alignment of the decrypt buffers (one cache line, and the widest vector)
+#define SEARCH_CONTEXT_ALIGN 64
+
+// Most targets searched at once (one bit each in a uint64_t mask)
+#define SEARCH_TARGETS_MAX 64
+
+struct search_context {
+    const struct des_check *checks;         // One per target
+    int targets;
+    DES_key_schedule schedule;              // Schedule of the last key tried
+    DES_cblock keys[DES_BS_MAX_LANES];      // Keys of the last bitslice pass
+    uint8_t *decrypted;                     // Largest des_check_scratch_bytes() of the targets
+    uint8_t *lanes;                         // Largest des_check_lane_bytes() (bitslice backend), or NULL
+    struct des_check_stats stats;           // Candidates and time in the keyword check
+    int hit_lanes[SEARCH_TARGETS_MAX];      // Lane that matched each target (search_context_try_keys)
+};
+
+static inline size_t search_context_round(size_t bytes) {
+    return (bytes + SEARCH_CONTEXT_ALIGN - 1) / SEARCH_CONTEXT_ALIGN * SEARCH_CONTEXT_ALIGN;
+}
+
+// Sets up a context for targets (1 to SEARCH_TARGETS_MAX) checks. The
+// bitslice buffers are sized for the kernel des_bs_init() selected, which
+// must not be widened afterwards. Returns -1 (after printing why) if the
+// buffers cannot be allocated.
+static int search_context_init(struct search_context *ctx, const struct des_check *checks, int targets,
+                               enum search_backend backend) {
+    size_t scratch = 0, lanes = 0;
+    for (int t = 0; t < targets; t++) {
+        size_t bytes = des_check_scratch_bytes(&checks[t]);
+        scratch = bytes > scratch ? bytes : scratch;
+        if (backend == SEARCH_BACKEND_BITSLICE) {
+            bytes = des_check_lane_bytes(&checks[t], des_bs_lanes());
+            lanes = bytes > lanes ? bytes : lanes;
+        }
+    }
+    ctx->checks = checks;
+    ctx->targets = targets;
+    ctx->decrypted = aligned_alloc(SEARCH_CONTEXT_ALIGN, search_context_round(scratch + 1));
+    ctx->lanes = NULL;
+    ctx->stats.candidates = 0;
+    ctx->stats.check_ns = 0;
+    if (backend == SEARCH_BACKEND_BITSLICE) {
+        ctx->lanes = aligned_alloc(SEARCH_CONTEXT_ALIGN, search_context_round(lanes + 1));
+    }
+    if (ctx->decrypted == NULL || (backend == SEARCH_BACKEND_BITSLICE && ctx->lanes == NULL)) {
+        printf("Error: Failed to allocate the search buffers.\n");
+        free(ctx->decrypted);
+        free(ctx->lanes);
+        return -1;
+    }
+    return 0;
+}
+
+static void search_context_free(struct search_context *ctx) {
+    free(ctx->decrypted);
+    free(ctx->lanes);
+    ctx->decrypted = NULL;
+    ctx->lanes = NULL;
+}
+
+// Tests a key whose schedule the caller already has (Gray traversal)
+// against the targets not in solved. Returns the mask of the targets it
+// decrypts.
+static inline uint64_t search_context_try_schedule(struct search_context *ctx, DES_key_schedule *schedule,
+                                                   uint64_t solved) {
+    uint64_t hits = 0;
+    for (int t = 0; t < ctx->targets; t++) {
+        if (!((solved >> t) & 1)
+                && des_check_schedule(&ctx->checks[t], schedule, ctx->decrypted, &ctx->stats)) {
+            hits |= 1ULL << t;
+        }
+    }
+    return hits;
+}
+
+// Tests key against the targets not in solved
+static inline uint64_t search_context_try_cblock(struct search_context *ctx, DES_cblock *key,
+                                                 uint64_t solved) {
+    DES_set_key_unchecked(key, &ctx->schedule);
+    return search_context_try_schedule(ctx, &ctx->schedule, solved);
+}
+
+// Tests the key with this counter against the targets not in solved
+static inline uint64_t search_context_try_key(struct search_context *ctx, uint64_t counter, uint64_t solved) {
+    DES_cblock key;
+    keyspace_counter_to_key(counter, &key);
+    return search_context_try_cblock(ctx, &key, solved);
+}
+
+// Tests the first count (<= des_bs_lanes()) keys of ctx->keys with the
+// bitsliced backend against the targets not in solved. Returns the mask of
+// the targets some key decrypts; hit_lanes holds the offset of the first
+// such key for each of them.
+static inline uint64_t search_context_check_keys(struct search_context *ctx, int count, uint64_t solved) {
+    uint64_t hits = 0;
+    for (int t = 0; t < ctx->targets; t++) {
+        if ((solved >> t) & 1) {
+            continue;
+        }
+        int lane = des_check_keys(&ctx->checks[t], ctx->keys, count, ctx->lanes, &ctx->stats);
+        if (lane >= 0) {
+            ctx->hit_lanes[t] = lane;
+            hits |= 1ULL << t;
+        }
+    }
+    return hits;
+}
+
+// Tests the count (<= des_bs_lanes()) keys at traversal positions
+// [base, base + count) (under order and map, see keyspace_fill) like
+// search_context_check_keys
+static inline uint64_t search_context_try_keys(struct search_context *ctx, enum keyspace_order order,
+                                               const struct keyspace_map *map, uint64_t base, int count,
+                                               uint64_t solved) {
+    keyspace_fill(order, map, base, count, ctx->keys);
+    return search_context_check_keys(ctx, count, solved);
+}
+
+#endif
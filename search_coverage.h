@@ -0,0 +1,127 @@
+#ifndef SEARCH_COVERAGE_H
+#define SEARCH_COVERAGE_H
+
+// Set of traversal positions kept as sorted, disjoint, non-adjacent
+// intervals. The search pool records the chunks its workers complete in one
+// (search_checkpoint.h writes it to disk) and skips the positions of another
+// when resuming. Workers complete neighbouring chunks, so the list stays
+// short: about one interval per range or dynamic chunk, plus the chunks in
+// flight.
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Positions lo..hi, both included
+struct search_interval {
+    uint64_t lo;
+    uint64_t hi;
+};
+
+struct search_coverage {
+    struct search_interval *items;
+    size_t count;
+    size_t capacity;
+};
+
+static void search_coverage_init(struct search_coverage *c) {
+    c->items = NULL;
+    c->count = 0;
+    c->capacity = 0;
+}
+
+static void search_coverage_free(struct search_coverage *c) {
+    free(c->items);
+    search_coverage_init(c);
+}
+
+// Index of the first interval with hi >= pos (count if none)
+static size_t search_coverage_lower_bound(const struct search_coverage *c, uint64_t pos) {
+    size_t lo = 0, hi = c->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (c->items[mid].hi < pos) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Adds positions lo..hi, merging with the intervals they overlap or touch.
+// Returns -1 if the list cannot grow.
+static int search_coverage_add(struct search_coverage *c, uint64_t lo, uint64_t hi) {
+    // First interval that overlaps or touches lo..hi, and one past the last
+    size_t first = search_coverage_lower_bound(c, lo == 0 ? 0 : lo - 1);
+    size_t last = first;
+    while (last < c->count && (hi == UINT64_MAX || c->items[last].lo <= hi + 1)) {
+        last++;
+    }
+
+    if (first == last) {
+        if (c->count == c->capacity) {
+            size_t capacity = c->capacity ? 2 * c->capacity : 16;
+            struct search_interval *items = realloc(c->items, capacity * sizeof(*items));
+            if (items == NULL) {
+                return -1;
+            }
+            c->items = items;
+            c->capacity = capacity;
+        }
+        memmove(&c->items[first + 1], &c->items[first], (c->count - first) * sizeof(*c->items));
+        c->items[first].lo = lo;
+        c->items[first].hi = hi;
+        c->count++;
+        return 0;
+    }
+
+    if (c->items[first].lo < lo) {
+        lo = c->items[first].lo;
+    }
+    if (c->items[last - 1].hi > hi) {
+        hi = c->items[last - 1].hi;
+    }
+    c->items[first].lo = lo;
+    c->items[first].hi = hi;
+    memmove(&c->items[first + 1], &c->items[last], (c->count - last) * sizeof(*c->items));
+    c->count -= last - first - 1;
+    return 0;
+}
+
+// Adds every interval of other. Returns -1 if the list cannot grow.
+static int search_coverage_merge(struct search_coverage *c, const struct search_coverage *other) {
+    for (size_t i = 0; i < other->count; i++) {
+        if (search_coverage_add(c, other->items[i].lo, other->items[i].hi) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Length of the run of positions from pos on, walking downwards if down,
+// that are all covered (*covered = 1) or all uncovered (*covered = 0). An
+// uncovered run with no interval beyond it returns UINT64_MAX.
+static uint64_t search_coverage_run(const struct search_coverage *c, uint64_t pos, int down, int *covered) {
+    size_t i = search_coverage_lower_bound(c, pos);
+    if (i < c->count && c->items[i].lo <= pos) {
+        *covered = 1;
+        return down ? pos - c->items[i].lo + 1 : c->items[i].hi - pos + 1;
+    }
+    *covered = 0;
+    if (down) {
+        return i > 0 ? pos - c->items[i - 1].hi : UINT64_MAX;
+    }
+    return i < c->count ? c->items[i].lo - pos : UINT64_MAX;
+}
+
+// Number of positions covered
+static uint64_t search_coverage_total(const struct search_coverage *c) {
+    uint64_t total = 0;
+    for (size_t i = 0; i < c->count; i++) {
+        total += c->items[i].hi - c->items[i].lo + 1;
+    }
+    return total;
+}
+
+#endif
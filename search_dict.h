@@ -0,0 +1,114 @@
+#ifndef SEARCH_DICT_H
+#define SEARCH_DICT_H
+
+// Wordlist of candidate keys or passphrases (bruteforce_partB --dictionary).
+//
+// The file is memory-mapped read-only (search_dict_file.h), so a list far
+// larger than memory is streamed from the page cache as the workers go.
+// Search positions are byte offsets into the file: the candidate at a
+// position is the line that starts there, and positions inside a line test
+// nothing. A line belongs to
+// the range holding its first byte, so the static and dynamic
+// distributions split the list by byte offset without ever cutting a line
+// in two or trying it twice. Every line is tried with each selected
+// derivation (search_dict_derive).
+
+#include <stdint.h>
+#include <string.h>
+#include <openssl/des.h>
+
+#include "keyspace.h"
+
+// Ways to turn a line into a key
+enum search_dict_derive {
+    SEARCH_DERIVE_RAW = 1,        // The first 8 bytes, zero-padded, as the key
+    SEARCH_DERIVE_HEX = 2,        // 16 hex digits spelling the key; other lines are skipped
+    SEARCH_DERIVE_PARITY = 4,     // The first 8 bytes shifted into the key bits, odd parity (crypt(3))
+    SEARCH_DERIVE_STRING = 8      // DES_string_to_key() of the line
+};
+
+#define SEARCH_DERIVE_COUNT 4
+
+// Longest passphrase DES_string_to_key() sees; longer lines are truncated
+#define SEARCH_DICT_LINE_MAX 1024
+
+static const char *const search_dict_derive_names[SEARCH_DERIVE_COUNT] = {"raw", "hex", "parity", "string"};
+
+struct search_dict {
+    const uint8_t *data;
+    size_t size;
+    unsigned derive;              // Mask of search_dict_derive
+    int derivations;              // Keys tried per line at most
+};
+
+// First line start at or after position
+static inline uint64_t search_dict_line_start(const struct search_dict *dict, uint64_t position) {
+    if (position == 0 || position >= dict->size || dict->data[position - 1] == '\n') {
+        return position;
+    }
+    const uint8_t *eol = memchr(dict->data + position, '\n', dict->size - position);
+    return eol == NULL ? dict->size : (uint64_t)(eol - dict->data) + 1;
+}
+
+// Length of the line starting at position, without its line break
+static inline size_t search_dict_line_length(const struct search_dict *dict, uint64_t position) {
+    const uint8_t *line = dict->data + position;
+    const uint8_t *eol = memchr(line, '\n', dict->size - position);
+    size_t length = eol == NULL ? dict->size - position : (size_t)(eol - line);
+    if (length > 0 && line[length - 1] == '\r') {
+        length--;
+    }
+    return length;
+}
+
+static inline int search_dict_hex_digit(uint8_t c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c |= 0x20;
+    return c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+}
+
+// Derives the keys of a line of length bytes into keys (room for
+// dict->derivations). Returns how many it derived; empty lines give none.
+static inline int search_dict_keys(const struct search_dict *dict, const uint8_t *line, size_t length,
+                                   DES_cblock *keys) {
+    int count = 0;
+    if (length == 0) {
+        return 0;
+    }
+    size_t head = length < sizeof(DES_cblock) ? length : sizeof(DES_cblock);
+    if (dict->derive & SEARCH_DERIVE_RAW) {
+        memset(keys[count], 0, sizeof(DES_cblock));
+        memcpy(keys[count], line, head);
+        count++;
+    }
+    if ((dict->derive & SEARCH_DERIVE_HEX) && length == 2 * sizeof(DES_cblock)) {
+        int ok = 1;
+        for (size_t i = 0; i < sizeof(DES_cblock) && ok; i++) {
+            int high = search_dict_hex_digit(line[2 * i]);
+            int low = search_dict_hex_digit(line[2 * i + 1]);
+            ok = high >= 0 && low >= 0;
+            keys[count][i] = (uint8_t)(high << 4 | low);
+        }
+        count += ok;
+    }
+    if (dict->derive & SEARCH_DERIVE_PARITY) {
+        memset(keys[count], 0, sizeof(DES_cblock));
+        for (size_t i = 0; i < head; i++) {
+            keys[count][i] = keyspace_odd_parity((uint8_t)(line[i] << 1));
+        }
+        count++;
+    }
+    if (dict->derive & SEARCH_DERIVE_STRING) {
+        char passphrase[SEARCH_DICT_LINE_MAX + 1];
+        size_t n = length < SEARCH_DICT_LINE_MAX ? length : SEARCH_DICT_LINE_MAX;
+        memcpy(passphrase, line, n);
+        passphrase[n] = '\0';
+        DES_string_to_key(passphrase, &keys[count]);
+        count++;
+    }
+    return count;
+}
+
+#endif
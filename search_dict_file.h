@@ -0,0 +1,58 @@
+#ifndef SEARCH_DICT_FILE_H
+#define SEARCH_DICT_FILE_H
+
+// Opening and closing the wordlist of search_dict.h. Kept apart so that
+// only the program with --dictionary compiles the file handling, while the
+// pool and the option parser only need the wordlist format.
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "search_dict.h"
+
+// Maps the wordlist at path. Returns -1 (after printing why) if it cannot be
+// read or is empty.
+static int search_dict_open(struct search_dict *dict, const char *path, unsigned derive) {
+    dict->data = NULL;
+    dict->size = 0;
+    dict->derive = derive;
+    dict->derivations = __builtin_popcount(derive);
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        printf("Error: cannot open dictionary %s\n", path);
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+    if (st.st_size == 0) {
+        printf("Error: dictionary %s is empty\n", path);
+        close(fd);
+        return -1;
+    }
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        printf("Error: cannot map dictionary %s\n", path);
+        return -1;
+    }
+    // Each process reads its share front to back, once
+    madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+    dict->data = data;
+    dict->size = (size_t)st.st_size;
+    return 0;
+}
+
+static void search_dict_close(struct search_dict *dict) {
+    if (dict->data != NULL) {
+        munmap((void *)dict->data, dict->size);
+    }
+    dict->data = NULL;
+    dict->size = 0;
+}
+
+#endif
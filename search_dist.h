@@ -0,0 +1,782 @@
+#ifndef SEARCH_DIST_H
+#define SEARCH_DIST_H
+
+// Distribution of the key space between MPI processes.
+//
+// SEARCH_DIST_STATIC gives every process a fixed share up front (the
+// original upper / N split). SEARCH_DIST_DYNAMIC hands out chunks of
+// positions on demand instead: rank 0 keeps the unassigned part of the
+// space and its main thread, which only polls MPI while the workers search,
+// answers chunk requests from every process (itself included). A process
+// asks for the next chunk while it still has one queued, so faster
+// processes simply take more of the space and all of them finish at about
+// the same time. Processes that walk downwards take their chunks from the
+// top of the unassigned space, the others from the bottom.
+//
+// Every request is answered, with an empty chunk once the space is
+// exhausted or the search stopped, and every process reports to rank 0
+// before leaving, so no message is left unmatched at the final barrier.
+//
+// With --lease=S every chunk rank 0 hands to another process is a lease.
+// The process confirms each chunk once its pool recorded every position of
+// it, and sends a heartbeat every S / SEARCH_DIST_BEATS seconds while it
+// holds any and its workers tested keys since the last one; either renews
+// all its leases. Keys are counted as they are tested, so a process busy on
+// one large chunk or a slow check keeps its leases, while one whose workers
+// stall loses them even if the thread that polls MPI still runs. When a
+// lease goes S seconds without that, rank 0 gives up on the process: its
+// unconfirmed chunks are reissued to the next processes that ask, and the
+// stop no longer waits for its report (search_stop_lose). A request that
+// finds the space exhausted while leases are still outstanding is held
+// back instead of answered, so the healthy processes stay around to take
+// the chunks that expire, and the search only ends once every chunk is
+// confirmed. The collectives at the end would wait forever for a process
+// given up on, so then rank 0 prints the outcome and ends the job
+// (search_dist_abandon). A process that dies takes the MPI job down on its
+// own; leases protect against the ones that hang.
+//
+// SEARCH_DIST_WEIGHTED needs no coordinator: before the search every
+// process times its own search for --calibration seconds
+// (search_dist_calibrate), the rates are gathered everywhere, and each
+// process takes a contiguous share in proportion to its rate
+// (search_dist_share), so all of them should finish together. With
+// --rebalance every process also reports, every S seconds, its current
+// rate and the positions it has not handed to its workers yet, in one
+// MPI_Iallgather; from the same reports every process computes the same
+// plan, and the processes that fell behind give the far end of their
+// newest range to those that are ahead. The pools stay open until an
+// exchange shows every backlog empty; all processes see the same reports,
+// so they all close after the same one and post the same number of
+// exchanges, however far the calibration was off. If the workers of a process already
+// took part of a range it gives away, that part is searched twice, once by
+// each process; no position is ever left out.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mpi.h>
+
+#include "des_check.h"
+#include "keyspace.h"
+#include "search_options.h"
+#include "search_pool.h"
+#include "search_stop.h"
+
+// Tags of the distributor messages (search_stop.h uses 4 and 5)
+#define SEARCH_DIST_TAG_REQUEST 1
+#define SEARCH_DIST_TAG_CHUNK 2
+#define SEARCH_DIST_TAG_DONE 3
+#define SEARCH_DIST_TAG_CONFIRM 6
+#define SEARCH_DIST_TAG_BEAT 7
+
+// Chunks a process keeps queued in its pool
+#define SEARCH_DIST_PREFETCH 2
+
+// Leased chunks a process may hold unconfirmed
+#define SEARCH_DIST_HELD (2 * SEARCH_DIST_PREFETCH)
+
+// Heartbeats per lease time
+#define SEARCH_DIST_BEATS 4
+
+// Speed of every process, for the weighted distribution
+struct search_dist_weights {
+    double *rates;                // Keys per second of each process, NULL for the other distributions
+    double rebalance;             // Seconds between rebalances, 0 = never
+};
+
+// What a process tells the others at a rebalance
+struct search_dist_report {
+    double rate;                  // Positions handed out per second since the last one, 0 if unknown
+    uint64_t backlog;             // Positions queued and not handed out
+    struct search_range tail;     // Part of the newest range not handed out
+    uint64_t spare;               // Its size
+    int32_t slots;                // Free queue slots
+    int32_t open;                 // Still searching
+};
+
+// A chunk rank 0 leased to another process
+struct search_dist_lease {
+    uint64_t first;
+    uint64_t count;
+    int owner;                    // -1 once expired, until it is reissued
+    double deadline;              // MPI_Wtime() by which the owner must show progress
+};
+
+struct search_dist {
+    MPI_Comm comm;
+    int id;
+    int size;
+    enum search_distribution mode;
+    uint64_t chunk;
+    int down;                     // This process walks its chunks downwards
+    int closed;                   // No more chunks for this process
+    uint64_t assigned;            // Positions this process received
+    // Rank 0: positions [low, high) are still unassigned
+    uint64_t low;
+    uint64_t high;
+    int stopped;                  // Answer every request with an empty chunk
+    int done;                     // Processes that reported they are leaving
+    // Other ranks: outstanding chunk request
+    int waiting;
+    MPI_Request reply_req;
+    uint64_t reply[2];            // First position and count (0 = nothing left)
+    // Dynamic with --lease
+    double lease;                 // Seconds without progress before a lease expires, 0 = no leases
+    int lost;                     // Rank 0: processes given up on
+    struct search_dist_lease *leases; // Rank 0: chunks not confirmed yet
+    int leased;
+    int *pending;                 // Rank 0: direction of each process's held back request, -1 = none
+    unsigned char *gone;          // Rank 0: processes given up on
+    uint64_t reissued;            // Rank 0: positions of expired leases handed out again
+    struct search_range held[SEARCH_DIST_HELD]; // Other ranks: unconfirmed chunks, upwards
+    int holding;
+    double beat_at;               // Other ranks: MPI_Wtime() of the last heartbeat
+    uint64_t beat_tested;         // search_pool_tested() then
+    // Weighted: rebalances
+    double *rates;                // Latest rate of every process
+    double interval;              // Seconds between rebalances
+    int rebalancing;              // Reports go on until every backlog is empty
+    int epoch;                    // Rebalances posted so far
+    int exchanging;               // The reports of the last one are in flight
+    // Duplicate of comm for the reports: rank 0 posts the stop broadcast
+    // (search_stop.h) after the others, so on comm the collectives would
+    // not start in the same order everywhere
+    MPI_Comm reports_comm;
+    MPI_Request exchange;
+    double started_at;            // MPI_Wtime() of the start of the search
+    double since;                 // MPI_Wtime() of the last report (or the start)
+    uint64_t handed;              // search_pool_handed() then
+    struct search_dist_report report;
+    struct search_dist_report *reports;
+    uint64_t *plan;               // Per process: positions to give, to take
+};
+
+// Collective. With --distribution=weighted, times the search of the start
+// of this process's even share for opts->calibration seconds and gathers
+// the rates of every process into weights (the keys tested on the way are
+// searched again by the real run). Other distributions only clear weights.
+// Returns -1 (after printing why) if the workers cannot be started.
+static int search_dist_calibrate(struct search_dist_weights *weights, MPI_Comm comm,
+                                 const struct search_options *opts, const struct des_check *checks, int targets,
+                                 const struct keyspace_map *map, uint64_t begin, uint64_t end) {
+    weights->rates = NULL;
+    weights->rebalance = opts->rebalance;
+    if (opts->distribution != SEARCH_DIST_WEIGHTED) {
+        return 0;
+    }
+    int id, size;
+    MPI_Comm_rank(comm, &id);
+    MPI_Comm_size(comm, &size);
+    weights->rates = malloc((size_t)size * sizeof(double));
+    if (weights->rates == NULL) {
+        printf("Error: Failed to allocate the process rates.\n");
+        return -1;
+    }
+
+    uint64_t share = (end - begin) / (uint64_t)size;
+    uint64_t lower = begin + share * (uint64_t)id;
+    uint64_t upper = id == size - 1 ? end - 1 : lower + share - 1;
+    struct search_pool pool;
+    if (search_pool_start(&pool, checks, targets, opts->backend, opts->order, opts->threads) != 0) {
+        return -1;
+    }
+    search_pool_map(&pool, map);
+    search_pool_feed(&pool, lower, upper);
+    search_pool_close(&pool);
+    double start = MPI_Wtime();
+    while (search_pool_running(&pool) && MPI_Wtime() - start < opts->calibration) {
+        search_pool_nap();
+    }
+    search_pool_stop(&pool);
+    double seconds = MPI_Wtime() - start;
+    while (search_pool_running(&pool)) {
+        search_pool_nap();
+    }
+    struct search_pool_counters counters;
+    search_pool_counters(&pool, &counters);
+    search_pool_join(&pool);
+    double rate = seconds > 0 ? (double)counters.tested / seconds : 0;
+    MPI_Allgather(&rate, 1, MPI_DOUBLE, weights->rates, 1, MPI_DOUBLE, comm);
+
+    // A process too quick to time gets the slowest measured rate
+    double slowest = 0;
+    for (int r = 0; r < size; r++) {
+        if (weights->rates[r] > 0 && (slowest == 0 || weights->rates[r] < slowest)) {
+            slowest = weights->rates[r];
+        }
+    }
+    for (int r = 0; r < size; r++) {
+        if (!(weights->rates[r] > 0)) {
+            weights->rates[r] = slowest > 0 ? slowest : 1;
+        }
+        if (id == 0) {
+            printf("Calibration: process %d searches %.0f keys/s\n", r, weights->rates[r]);
+        }
+    }
+    return 0;
+}
+
+static void search_dist_weights_free(struct search_dist_weights *weights) {
+    free(weights->rates);
+    weights->rates = NULL;
+}
+
+// This process's share lower..upper of positions [begin, end) (at least one
+// position per process): the even split, or with weights one position per
+// process plus a share of the rest in proportion to its rate
+static void search_dist_share(const struct search_dist_weights *weights, int id, int size, uint64_t begin,
+                              uint64_t end, unsigned long long *lower, unsigned long long *upper) {
+    if (weights == NULL || weights->rates == NULL) {
+        uint64_t range_per_node = (end - begin) / size;  // Divide the range by all N workers
+        *lower = begin + range_per_node * id;  // Start range for this process
+        *upper = (id == size - 1) ? end - 1 : begin + range_per_node * (id + 1) - 1;  // Last process gets the remaining keys
+        return;
+    }
+    double total = 0, before = 0;
+    for (int r = 0; r < size; r++) {
+        total += weights->rates[r];
+        before += r < id ? weights->rates[r] : 0;
+    }
+    uint64_t rest = end - begin - (uint64_t)size;
+    *lower = begin + (uint64_t)id + (uint64_t)((long double)rest * before / total);
+    *upper = id == size - 1 ? end - 1
+                            : begin + (uint64_t)id + (uint64_t)((long double)rest * (before + weights->rates[id]) / total);
+}
+
+// Queues positions first..first + count - 1 in this process's direction.
+// Every caller leaves a free queue slot first; if none is left anyway the
+// positions would never be searched, so the job is aborted.
+static void search_dist_feed(struct search_dist *dist, struct search_pool *pool, uint64_t first, uint64_t count) {
+    dist->assigned += count;
+    int fed = dist->down ? search_pool_feed(pool, first + count - 1, first)
+                         : search_pool_feed(pool, first, first + count - 1);
+    if (fed != 0) {
+        printf("Error: Process %d has no queue slot for keys %llu to %llu.\n", dist->id,
+               (unsigned long long)first, (unsigned long long)(first + count - 1));
+        MPI_Abort(dist->comm, EXIT_FAILURE);
+    }
+}
+
+// Sets up the distribution of positions [begin, end) over the processes of
+// comm. A static or weighted distribution feeds this process's share
+// (lower..upper, from search_dist_share) right away and, unless weights
+// asks for rebalances, closes the pool. A dynamic one leases its chunks to
+// the other processes if lease (seconds) is positive.
+static void search_dist_init(struct search_dist *dist, struct search_pool *pool, MPI_Comm comm,
+                             enum search_distribution mode, uint64_t chunk, double lease, int down,
+                             uint64_t begin, uint64_t end, uint64_t lower, uint64_t upper,
+                             const struct search_dist_weights *weights) {
+    dist->comm = comm;
+    MPI_Comm_rank(comm, &dist->id);
+    MPI_Comm_size(comm, &dist->size);
+    dist->mode = mode;
+    dist->chunk = chunk;
+    dist->down = down;
+    dist->closed = 0;
+    dist->assigned = 0;
+    dist->low = begin;
+    dist->high = end;
+    dist->stopped = 0;
+    dist->done = 0;
+    dist->waiting = 0;
+    dist->rates = NULL;
+    dist->rebalancing = 0;
+    dist->epoch = 0;
+    dist->exchanging = 0;
+    dist->reports = NULL;
+    dist->plan = NULL;
+    dist->lease = mode == SEARCH_DIST_DYNAMIC ? lease : 0;
+    dist->lost = 0;
+    dist->leases = NULL;
+    dist->leased = 0;
+    dist->pending = NULL;
+    dist->gone = NULL;
+    dist->reissued = 0;
+    dist->holding = 0;
+
+    if (dist->lease > 0 && dist->id == 0) {
+        dist->leases = malloc((size_t)dist->size * SEARCH_DIST_HELD * sizeof(struct search_dist_lease));
+        dist->pending = malloc((size_t)dist->size * sizeof(int));
+        dist->gone = calloc((size_t)dist->size, 1);
+        if (dist->leases == NULL || dist->pending == NULL || dist->gone == NULL) {
+            printf("Error: Failed to allocate the lease table.\n");
+            MPI_Abort(comm, EXIT_FAILURE);
+        }
+        for (int r = 0; r < dist->size; r++) {
+            dist->pending[r] = -1;
+        }
+    } else if (dist->lease > 0) {
+        search_pool_record(pool);
+        dist->beat_at = MPI_Wtime();
+        dist->beat_tested = 0;
+    }
+
+    if (mode == SEARCH_DIST_STATIC || mode == SEARCH_DIST_WEIGHTED) {
+        search_dist_feed(dist, pool, lower, upper - lower + 1);
+    }
+    if (mode == SEARCH_DIST_WEIGHTED && weights->rebalance > 0) {
+        dist->interval = weights->rebalance;
+        dist->rebalancing = 1;
+        dist->rates = malloc((size_t)dist->size * sizeof(double));
+        dist->reports = malloc((size_t)dist->size * sizeof(struct search_dist_report));
+        dist->plan = malloc(2 * (size_t)dist->size * sizeof(uint64_t));
+        if (dist->rates == NULL || dist->reports == NULL || dist->plan == NULL) {
+            printf("Error: Failed to allocate the rebalancing buffers.\n");
+            MPI_Abort(comm, EXIT_FAILURE);
+        }
+        memcpy(dist->rates, weights->rates, (size_t)dist->size * sizeof(double));
+        MPI_Comm_dup(comm, &dist->reports_comm);
+        dist->started_at = MPI_Wtime();
+        dist->since = dist->started_at;
+        dist->handed = search_pool_handed(pool);
+    }
+    if (mode != SEARCH_DIST_DYNAMIC && !dist->rebalancing) {
+        search_pool_close(pool);
+        dist->closed = 1;
+    }
+}
+
+// Fills dist->report with the state of this process's pool
+static void search_dist_report(struct search_dist *dist, struct search_pool *pool) {
+    struct search_dist_report *report = &dist->report;
+    memset(report, 0, sizeof(*report));
+    int slots;
+    report->backlog = search_pool_backlog(pool, &report->tail, &report->spare, &slots);
+    report->slots = slots;
+    report->open = !search_pool_stopped(pool);
+
+    // A process that ran out of work did not search at full speed
+    double now = MPI_Wtime();
+    uint64_t handed = search_pool_handed(pool);
+    if (report->backlog > 0 && now > dist->since) {
+        report->rate = (double)(handed - dist->handed) / (now - dist->since);
+    }
+    dist->since = now;
+    dist->handed = handed;
+}
+
+// Moves positions as the reports of every process say. Every process
+// computes the same plan: each gets a share of all the backlogs in
+// proportion to its rate, and those holding more than a chunk over their
+// share give the far end of their newest range, in rank order, to those
+// lacking more than a chunk.
+static void search_dist_apply(struct search_dist *dist, struct search_pool *pool) {
+    int n = dist->size;
+    const struct search_dist_report *reports = dist->reports;
+
+    // The measured rates replace the previous ones only when every process
+    // could measure one, so all of them stay in the same unit
+    int measured = 1;
+    for (int r = 0; r < n; r++) {
+        measured &= !reports[r].open || reports[r].rate > 0;
+    }
+    double total = 0;
+    uint64_t backlog = 0;
+    for (int r = 0; r < n; r++) {
+        if (reports[r].open) {
+            dist->rates[r] = measured ? reports[r].rate : dist->rates[r];
+            total += dist->rates[r];
+            backlog += reports[r].backlog;
+        }
+    }
+    if (backlog == 0 || !(total > 0)) {
+        return;
+    }
+
+    uint64_t *give = dist->plan, *take = dist->plan + n;
+    for (int r = 0; r < n; r++) {
+        uint64_t share = reports[r].open ? (uint64_t)((long double)backlog * dist->rates[r] / total) : 0;
+        uint64_t has = reports[r].backlog;
+        give[r] = reports[r].open && has > share + SEARCH_POOL_CHUNK ? has - share : 0;
+        give[r] = give[r] < reports[r].spare ? give[r] : reports[r].spare;
+        take[r] = reports[r].open && reports[r].slots > 0 && share > has + SEARCH_POOL_CHUNK ? share - has : 0;
+    }
+
+    // A receiver gets one range from each donor at most, and no more than
+    // its free queue slots
+    uint64_t moved = 0;
+    int g = 0, slots = g < n ? reports[g].slots : 0;
+    for (int r = 0; r < n; r++) {
+        const struct search_range *tail = &reports[r].tail;
+        int down = tail->first > tail->last;
+        uint64_t cursor = tail->last;
+        uint64_t given = 0;
+        while (give[r] > 0) {
+            while (g < n && (take[g] == 0 || slots == 0)) {
+                g++;
+                slots = g < n ? reports[g].slots : 0;
+            }
+            if (g == n) {
+                break;
+            }
+            uint64_t count = give[r] < take[g] ? give[r] : take[g];
+            uint64_t first = down ? cursor : cursor - (count - 1);
+            cursor = down ? cursor + count : cursor - count;
+            if (g == dist->id) {
+                search_dist_feed(dist, pool, first, count);
+            }
+            give[r] -= count;
+            take[g] -= count;
+            slots--;
+            given += count;
+        }
+        if (r == dist->id && given > 0) {
+            dist->assigned -= search_pool_trim(pool, given);
+        }
+        moved += given;
+    }
+    if (dist->id == 0 && moved > 0) {
+        printf("Rebalance %d: moved %llu positions\n", dist->epoch, (unsigned long long)moved);
+    }
+}
+
+// Weighted: 1 if the last reports show no position left to hand out
+static int search_dist_settled(const struct search_dist *dist) {
+    for (int r = 0; r < dist->size; r++) {
+        if (dist->reports[r].backlog > 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Weighted: posts this process's report when the next rebalance is due and
+// applies the plan once every report is in. The pool is closed once the
+// reports show every backlog empty.
+static void search_dist_rebalance(struct search_dist *dist, struct search_pool *pool) {
+    if (dist->exchanging) {
+        int flag;
+        MPI_Test(&dist->exchange, &flag, MPI_STATUS_IGNORE);
+        if (!flag) {
+            return;
+        }
+        dist->exchanging = 0;
+        if (search_dist_settled(dist)) {
+            dist->rebalancing = 0;
+            search_pool_close(pool);
+            dist->closed = 1;
+        } else {
+            search_dist_apply(dist, pool);
+        }
+    }
+    if (!dist->closed && MPI_Wtime() >= dist->started_at + (dist->epoch + 1) * dist->interval) {
+        search_dist_report(dist, pool);
+        MPI_Iallgather(&dist->report, sizeof(dist->report), MPI_BYTE, dist->reports, sizeof(dist->report),
+                       MPI_BYTE, dist->reports_comm, &dist->exchange);
+        dist->epoch++;
+        dist->exchanging = 1;
+    }
+}
+
+// Rank 0: takes the next chunk for a process walking in direction down,
+// the chunk of an expired lease if there is one. Returns its size (0 when
+// nothing is left for now).
+static uint64_t search_dist_take(struct search_dist *dist, int down, uint64_t *first) {
+    for (int l = 0; !dist->stopped && l < dist->leased; l++) {
+        if (dist->leases[l].owner < 0) {
+            uint64_t count = dist->leases[l].count;
+            *first = dist->leases[l].first;
+            dist->leases[l] = dist->leases[--dist->leased];
+            dist->reissued += count;
+            return count;
+        }
+    }
+    if (dist->stopped || dist->low >= dist->high) {
+        *first = 0;
+        return 0;
+    }
+    uint64_t count = dist->high - dist->low < dist->chunk ? dist->high - dist->low : dist->chunk;
+    if (down) {
+        dist->high -= count;
+        *first = dist->high;
+    } else {
+        *first = dist->low;
+        dist->low += count;
+    }
+    return count;
+}
+
+// Rank 0: nothing will be left to hand out, now or after a lease expires
+static inline int search_dist_drained(const struct search_dist *dist) {
+    return dist->stopped || (dist->low >= dist->high && dist->leased == 0);
+}
+
+// Rank 0: the owner of some leases showed progress
+static void search_dist_renew(struct search_dist *dist, int owner) {
+    double deadline = MPI_Wtime() + dist->lease;
+    for (int l = 0; l < dist->leased; l++) {
+        if (dist->leases[l].owner == owner) {
+            dist->leases[l].deadline = deadline;
+        }
+    }
+}
+
+// Rank 0: drops the lease of a confirmed chunk, whoever holds it now
+static void search_dist_confirm(struct search_dist *dist, uint64_t first, uint64_t count) {
+    for (int l = 0; l < dist->leased; l++) {
+        if (dist->leases[l].first == first && dist->leases[l].count == count) {
+            dist->leases[l] = dist->leases[--dist->leased];
+            return;
+        }
+    }
+}
+
+// Rank 0: gives up on the owners of expired leases. Their chunks wait in
+// the table for the next requests, and the stop no longer waits for them.
+static void search_dist_expire(struct search_dist *dist, struct search_stop *stop) {
+    double now = MPI_Wtime();
+    for (int l = 0; l < dist->leased; l++) {
+        int owner = dist->leases[l].owner;
+        if (owner < 0 || dist->leases[l].deadline > now) {
+            continue;
+        }
+        int chunks = 0;
+        for (int m = 0; m < dist->leased; m++) {
+            if (dist->leases[m].owner == owner) {
+                dist->leases[m].owner = -1;
+                chunks++;
+            }
+        }
+        dist->gone[owner] = 1;
+        dist->pending[owner] = -1;
+        dist->lost++;
+        printf("Process %d sent nothing for %.1f seconds: reissuing its %d chunks\n", owner, dist->lease,
+               chunks);
+        search_stop_lose(stop, dist->gone);
+    }
+}
+
+// Rank 0, with leases: answers the held back requests that can be, with
+// a chunk or, once the space is drained, with an empty one
+static void search_dist_grant(struct search_dist *dist) {
+    for (int r = 1; r < dist->size; r++) {
+        if (dist->pending[r] < 0 || dist->leased == dist->size * SEARCH_DIST_HELD) {
+            continue;
+        }
+        uint64_t reply[2];
+        reply[1] = search_dist_take(dist, dist->pending[r], &reply[0]);
+        if (reply[1] == 0 && !search_dist_drained(dist)) {
+            continue;
+        }
+        if (reply[1] > 0) {
+            struct search_dist_lease *lease = &dist->leases[dist->leased++];
+            lease->first = reply[0];
+            lease->count = reply[1];
+            lease->owner = r;
+            lease->deadline = MPI_Wtime() + dist->lease;
+        }
+        MPI_Send(reply, 2, MPI_UINT64_T, r, SEARCH_DIST_TAG_CHUNK, dist->comm);
+        dist->pending[r] = -1;
+    }
+}
+
+// Rank 0: answers the pending chunk requests and counts leaving processes.
+// With leases the requests are held back until search_dist_grant() can
+// answer them; requests of processes given up on never are.
+static void search_dist_serve(struct search_dist *dist) {
+    int pending;
+    MPI_Status st;
+
+    MPI_Iprobe(MPI_ANY_SOURCE, SEARCH_DIST_TAG_REQUEST, dist->comm, &pending, &st);
+    while (pending) {
+        int down;
+        uint64_t reply[2];
+        MPI_Recv(&down, 1, MPI_INT, st.MPI_SOURCE, SEARCH_DIST_TAG_REQUEST, dist->comm, MPI_STATUS_IGNORE);
+        if (dist->lease > 0) {
+            dist->pending[st.MPI_SOURCE] = dist->gone[st.MPI_SOURCE] ? -1 : down;
+        } else {
+            reply[1] = search_dist_take(dist, down, &reply[0]);
+            MPI_Send(reply, 2, MPI_UINT64_T, st.MPI_SOURCE, SEARCH_DIST_TAG_CHUNK, dist->comm);
+        }
+        MPI_Iprobe(MPI_ANY_SOURCE, SEARCH_DIST_TAG_REQUEST, dist->comm, &pending, &st);
+    }
+
+    if (dist->lease > 0) {
+        MPI_Iprobe(MPI_ANY_SOURCE, SEARCH_DIST_TAG_CONFIRM, dist->comm, &pending, &st);
+        while (pending) {
+            uint64_t chunk[2];
+            MPI_Recv(chunk, 2, MPI_UINT64_T, st.MPI_SOURCE, SEARCH_DIST_TAG_CONFIRM, dist->comm, MPI_STATUS_IGNORE);
+            search_dist_confirm(dist, chunk[0], chunk[1]);
+            search_dist_renew(dist, st.MPI_SOURCE);
+            MPI_Iprobe(MPI_ANY_SOURCE, SEARCH_DIST_TAG_CONFIRM, dist->comm, &pending, &st);
+        }
+        MPI_Iprobe(MPI_ANY_SOURCE, SEARCH_DIST_TAG_BEAT, dist->comm, &pending, &st);
+        while (pending) {
+            MPI_Recv(NULL, 0, MPI_BYTE, st.MPI_SOURCE, SEARCH_DIST_TAG_BEAT, dist->comm, MPI_STATUS_IGNORE);
+            search_dist_renew(dist, st.MPI_SOURCE);
+            MPI_Iprobe(MPI_ANY_SOURCE, SEARCH_DIST_TAG_BEAT, dist->comm, &pending, &st);
+        }
+        search_dist_grant(dist);
+    }
+
+    MPI_Iprobe(MPI_ANY_SOURCE, SEARCH_DIST_TAG_DONE, dist->comm, &pending, &st);
+    while (pending) {
+        MPI_Recv(NULL, 0, MPI_BYTE, st.MPI_SOURCE, SEARCH_DIST_TAG_DONE, dist->comm, MPI_STATUS_IGNORE);
+        dist->done++;
+        MPI_Iprobe(MPI_ANY_SOURCE, SEARCH_DIST_TAG_DONE, dist->comm, &pending, &st);
+    }
+}
+
+// Other ranks, with leases: confirms the chunks the pool completed and
+// sends a heartbeat when one is due, some chunk is still held and the
+// workers tested keys since the last
+static void search_dist_beat(struct search_dist *dist, struct search_pool *pool) {
+    for (int h = 0; h < dist->holding; ) {
+        if (search_pool_covered(pool, dist->held[h].first, dist->held[h].last)) {
+            uint64_t chunk[2] = {dist->held[h].first, dist->held[h].last - dist->held[h].first + 1};
+            MPI_Send(chunk, 2, MPI_UINT64_T, 0, SEARCH_DIST_TAG_CONFIRM, dist->comm);
+            dist->held[h] = dist->held[--dist->holding];
+        } else {
+            h++;
+        }
+    }
+    double now = MPI_Wtime();
+    if (now - dist->beat_at >= dist->lease / SEARCH_DIST_BEATS) {
+        uint64_t tested = search_pool_tested(pool);
+        if (dist->holding > 0 && tested != dist->beat_tested) {
+            MPI_Send(NULL, 0, MPI_BYTE, 0, SEARCH_DIST_TAG_BEAT, dist->comm);
+        }
+        dist->beat_at = now;
+        dist->beat_tested = tested;
+    }
+}
+
+// Called regularly by the thread that polls MPI while the pool searches:
+// keeps SEARCH_DIST_PREFETCH chunks queued and, on rank 0, serves the
+// other processes. With leases rank 0 also gives up on the processes whose
+// leases expired until stop announces the outcome; from then on it hands
+// out no more chunks and waits for every process still counted.
+static void search_dist_progress(struct search_dist *dist, struct search_pool *pool, struct search_stop *stop) {
+    if (dist->mode == SEARCH_DIST_WEIGHTED && dist->rebalancing) {
+        search_dist_rebalance(dist, pool);
+        return;
+    }
+    if (dist->mode != SEARCH_DIST_DYNAMIC) {
+        return;
+    }
+    if (dist->id == 0 && dist->lease > 0) {
+        dist->stopped |= stop->posted;
+        if (!dist->stopped) {
+            search_dist_expire(dist, stop);
+        } else {
+            int late = search_stop_overdue(stop, dist->lease);
+            if (late > 0) {
+                dist->lost += late;
+                printf("%d processes did not report within %.1f seconds of the outcome\n", late, dist->lease);
+            }
+        }
+    }
+    if (dist->id == 0) {
+        search_dist_serve(dist);
+    } else if (dist->lease > 0) {
+        search_dist_beat(dist, pool);
+    }
+
+    if (dist->waiting) {
+        int flag;
+        MPI_Test(&dist->reply_req, &flag, MPI_STATUS_IGNORE);
+        if (!flag) {
+            return;
+        }
+        dist->waiting = 0;
+        if (dist->reply[1] == 0) {
+            search_pool_close(pool);
+            dist->closed = 1;
+        } else {
+            search_dist_feed(dist, pool, dist->reply[0], dist->reply[1]);
+            if (dist->lease > 0) {
+                struct search_range *chunk = &dist->held[dist->holding++];
+                chunk->first = dist->reply[0];
+                chunk->last = dist->reply[0] + dist->reply[1] - 1;
+            }
+        }
+    }
+
+    while (!dist->closed && !dist->waiting && !search_pool_stopped(pool)
+           && search_pool_queued(pool) < SEARCH_DIST_PREFETCH
+           && (dist->lease == 0 || dist->holding < SEARCH_DIST_HELD)) {
+        if (dist->id == 0) {
+            uint64_t first;
+            uint64_t count = search_dist_take(dist, dist->down, &first);
+            if (count == 0 && !search_dist_drained(dist)) {
+                break;  // Leases are outstanding; one may expire
+            }
+            if (count == 0) {
+                search_pool_close(pool);
+                dist->closed = 1;
+            } else {
+                search_dist_feed(dist, pool, first, count);
+            }
+        } else {
+            MPI_Send(&dist->down, 1, MPI_INT, 0, SEARCH_DIST_TAG_REQUEST, dist->comm);
+            MPI_Irecv(dist->reply, 2, MPI_UINT64_T, 0, SEARCH_DIST_TAG_CHUNK, dist->comm, &dist->reply_req);
+            dist->waiting = 1;
+        }
+    }
+}
+
+// Called once the pool has been joined. Rank 0 keeps answering requests
+// (with empty chunks) until every other process has reported it is leaving,
+// unless it gave up on some of them. With rebalances that did not settle
+// (the search stopped), this process posts empty reports until the other
+// ones have left too.
+static void search_dist_finish(struct search_dist *dist) {
+    if (dist->mode == SEARCH_DIST_WEIGHTED) {
+        if (dist->exchanging) {
+            MPI_Wait(&dist->exchange, MPI_STATUS_IGNORE);
+            dist->exchanging = 0;
+            dist->rebalancing = !search_dist_settled(dist);
+        }
+        memset(&dist->report, 0, sizeof(dist->report));
+        while (dist->rebalancing) {
+            MPI_Iallgather(&dist->report, sizeof(dist->report), MPI_BYTE, dist->reports, sizeof(dist->report),
+                           MPI_BYTE, dist->reports_comm, &dist->exchange);
+            MPI_Wait(&dist->exchange, MPI_STATUS_IGNORE);
+            dist->epoch++;
+            dist->rebalancing = !search_dist_settled(dist);
+        }
+        if (dist->reports != NULL) {
+            MPI_Comm_free(&dist->reports_comm);
+        }
+        free(dist->rates);
+        free(dist->reports);
+        free(dist->plan);
+        return;
+    }
+    if (dist->mode == SEARCH_DIST_STATIC) {
+        return;
+    }
+    if (dist->id == 0) {
+        dist->stopped = 1;
+        while (dist->lost == 0 && dist->done < dist->size - 1) {
+            search_dist_serve(dist);
+            search_pool_nap();
+        }
+        if (dist->reissued > 0) {
+            printf("Reissued %llu positions of expired leases\n", (unsigned long long)dist->reissued);
+        }
+        free(dist->leases);
+        free(dist->pending);
+        free(dist->gone);
+        return;
+    }
+    if (dist->waiting) {
+        MPI_Wait(&dist->reply_req, MPI_STATUS_IGNORE);
+        dist->waiting = 0;
+    }
+    MPI_Send(NULL, 0, MPI_BYTE, 0, SEARCH_DIST_TAG_DONE, dist->comm);
+}
+
+// Rank 0, after printing the outcome: if the last search gave up on lost
+// processes (search_dist.lost), they never reach the collectives at the
+// end of the run, so the job ends here
+static void search_dist_abandon(MPI_Comm comm, int lost) {
+    if (lost > 0) {
+        printf("Aborting: %d processes stopped answering\n", lost);
+        fflush(stdout);
+        MPI_Abort(comm, EXIT_FAILURE);
+    }
+}
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef SEARCH_FILE_H
+#define SEARCH_FILE_H
+
+// Reading the plaintext file every program takes as its first argument.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Reads the entire plaintext from a file. Returns a malloc'd buffer and its
+// length, or NULL (after printing why) if it cannot be read or is empty.
+static uint8_t *read_plaintext_from_file(const char *filename, size_t *length) {
+    FILE *file = fopen(filename, "rb");
+    if (file == NULL) {
+        perror("Failed to open file");
+        return NULL;
+    }
+
+    // Get the file size
+    fseek(file, 0, SEEK_END);
+    long file_size = ftell(file);
+    rewind(file);
+
+    if (file_size <= 0) {
+        printf("Error: File is empty or has invalid size.\n");
+        fclose(file);
+        return NULL;
+    }
+
+    // Allocate memory for the file contents
+    uint8_t *buffer = (uint8_t *)malloc(file_size);
+    if (buffer == NULL) {
+        printf("Error: Failed to allocate memory.\n");
+        fclose(file);
+        return NULL;
+    }
+
+    // Read the entire file into the buffer
+    size_t bytes_read = fread(buffer, 1, file_size, file);
+    if (bytes_read != (size_t)file_size) {
+        printf("Error: Failed to read entire file.\n");
+        free(buffer);
+        fclose(file);
+        return NULL;
+    }
+
+    *length = file_size;  // Set the length of the plaintext
+    fclose(file);
+    return buffer;
+}
+
+#endif
@@ -0,0 +1,336 @@
+#ifndef SEARCH_MITM_H
+#define SEARCH_MITM_H
+
+// Meet-in-the-middle search of two chained DES keys (mitm).
+//
+// A cipher made of two DES layers is attacked one layer from each side: for
+// every key of the first layer, the table side computes the value in the
+// middle (say the plaintext block encrypted once), and for every key of the
+// second layer the probe side computes the same value from the other end
+// (the ciphertext block decrypted once). The right pair of keys meets on
+// the same value, so the search costs two sweeps of the key space plus a
+// table of one entry per key instead of one sweep per pair. Every match is
+// only a candidate (64-bit values of 2^k keys collide by chance) and is
+// verified against the whole text.
+//
+// The table is sharded across the processes by hash prefix: the top 32
+// bits of a hash of the value pick the process that owns it. Each process
+// computes the values of its static share of the positions, in rounds of
+// SEARCH_MITM_ROUND positions, and sends every entry to its owner with one
+// MPI_Alltoallv per round; the owner sorts what it received and answers the
+// probes, which are routed the same way. When the table does not fit in
+// --memory, the next 16 hash bits split it into passes: pass p keeps only
+// the entries of its slice of hashes, then probes only with values of that
+// slice, and both sides are recomputed for every pass. Every process runs
+// the same number of rounds, so the collectives line up, and a found pair
+// stops every process at the end of the round.
+//
+// Only the main thread of each process runs, and it calls MPI: the values
+// are produced by the callbacks of the program, per round.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mpi.h>
+
+// Positions whose values each process computes per round
+#define SEARCH_MITM_ROUND (1 << 16)
+
+// Most passes (the hash bits that pick one)
+#define SEARCH_MITM_MAX_PASSES (1 << 16)
+
+struct search_mitm_entry {
+    uint64_t value;
+    uint64_t position;
+};
+
+// Fills values with the values of positions [base, base + count) on one side
+typedef void (*search_mitm_values)(void *arg, uint64_t base, int count, uint64_t *values);
+
+// Returns 1 if the keys at table_position and probe_position are the ones
+typedef int (*search_mitm_verify)(void *arg, uint64_t table_position, uint64_t probe_position);
+
+struct search_mitm {
+    MPI_Comm comm;
+    int id;
+    int size;
+    uint64_t begin;               // Positions of both sides: [begin, end)
+    uint64_t end;
+    uint64_t lower;               // This process's share
+    uint64_t upper;
+    uint64_t rounds;              // Per pass and side, the same on every process
+    int passes;
+    search_mitm_values table_values;
+    search_mitm_values probe_values;
+    search_mitm_verify verify;
+    void *arg;
+
+    struct search_mitm_entry *table; // Entries this process owns in the current pass, sorted by value
+    size_t count;
+    size_t capacity;
+
+    // Counters of this process
+    uint64_t computed;            // Values computed, both sides, all passes
+    uint64_t largest;             // Most table entries held at once
+    uint64_t candidates;          // Probes that met a table entry
+
+    int found;                    // On every process after search_mitm_run
+    uint64_t table_position;
+    uint64_t probe_position;
+};
+
+static inline uint64_t search_mitm_hash(uint64_t value) {
+    return value * 0x9E3779B97F4A7C15ULL;
+}
+
+// Process owning value: the top 32 hash bits, scaled to the processes
+static inline int search_mitm_owner(const struct search_mitm *mitm, uint64_t hash) {
+    return (int)(((hash >> 32) * (uint64_t)mitm->size) >> 32);
+}
+
+// Pass holding value: the next 16 hash bits, scaled to the passes
+static inline int search_mitm_pass(const struct search_mitm *mitm, uint64_t hash) {
+    return (int)((((hash >> 16) & 0xFFFF) * (uint64_t)mitm->passes) >> 16);
+}
+
+// Sets up the search of positions [begin, end) on both sides with at most
+// memory bytes of table per process (the passes it takes follow from it)
+static void search_mitm_init(struct search_mitm *mitm, MPI_Comm comm, uint64_t begin, uint64_t end,
+                             uint64_t memory, search_mitm_values table_values, search_mitm_values probe_values,
+                             search_mitm_verify verify, void *arg) {
+    memset(mitm, 0, sizeof(*mitm));
+    mitm->comm = comm;
+    MPI_Comm_rank(comm, &mitm->id);
+    MPI_Comm_size(comm, &mitm->size);
+    mitm->begin = begin;
+    mitm->end = end;
+
+    // The static split of the other programs; the last process gets the
+    // remainder, so its share sets the rounds
+    uint64_t share = (end - begin) / (uint64_t)mitm->size;
+    mitm->lower = begin + share * (uint64_t)mitm->id;
+    mitm->upper = mitm->id == mitm->size - 1 ? end : mitm->lower + share;
+    uint64_t largest = end - begin - share * (uint64_t)(mitm->size - 1);
+    mitm->rounds = (largest + SEARCH_MITM_ROUND - 1) / SEARCH_MITM_ROUND;
+
+    // Leave a quarter of the budget for uneven hashes
+    uint64_t bytes = (end - begin) / (uint64_t)mitm->size * sizeof(struct search_mitm_entry);
+    uint64_t usable = memory / 4 * 3;
+    uint64_t passes = usable == 0 ? SEARCH_MITM_MAX_PASSES : (bytes + usable - 1) / usable;
+    mitm->passes = passes < 1 ? 1 : passes > SEARCH_MITM_MAX_PASSES ? SEARCH_MITM_MAX_PASSES : (int)passes;
+
+    mitm->table_values = table_values;
+    mitm->probe_values = probe_values;
+    mitm->verify = verify;
+    mitm->arg = arg;
+}
+
+static int search_mitm_compare(const void *a, const void *b) {
+    const struct search_mitm_entry *x = a, *y = b;
+    if (x->value != y->value) {
+        return x->value < y->value ? -1 : 1;
+    }
+    return x->position < y->position ? -1 : x->position > y->position;
+}
+
+// Buffers of one round
+struct search_mitm_round {
+    uint64_t *values;
+    struct search_mitm_entry *send;
+    struct search_mitm_entry *receive;
+    size_t received;              // Capacity of receive
+    int *send_counts;             // In bytes, per process
+    int *send_displs;
+    int *receive_counts;
+    int *receive_displs;
+};
+
+static void search_mitm_fail(const struct search_mitm *mitm) {
+    printf("Error: Failed to allocate the meet-in-the-middle buffers.\n");
+    MPI_Abort(mitm->comm, EXIT_FAILURE);
+}
+
+static void search_mitm_round_init(const struct search_mitm *mitm, struct search_mitm_round *round) {
+    size_t n = (size_t)mitm->size;
+    round->values = malloc(SEARCH_MITM_ROUND * sizeof(uint64_t));
+    round->send = malloc(SEARCH_MITM_ROUND * sizeof(struct search_mitm_entry));
+    round->receive = NULL;
+    round->received = 0;
+    round->send_counts = malloc(4 * n * sizeof(int));
+    if (round->values == NULL || round->send == NULL || round->send_counts == NULL) {
+        search_mitm_fail(mitm);
+    }
+    round->send_displs = round->send_counts + n;
+    round->receive_counts = round->send_counts + 2 * n;
+    round->receive_displs = round->send_counts + 3 * n;
+}
+
+static void search_mitm_round_free(struct search_mitm_round *round) {
+    free(round->values);
+    free(round->send);
+    free(round->receive);
+    free(round->send_counts);
+}
+
+// Computes the values of round r of one side, keeps those of pass and
+// routes them to their owners. Returns the entries this process received.
+static size_t search_mitm_exchange(struct search_mitm *mitm, struct search_mitm_round *round,
+                                   search_mitm_values values, uint64_t r, int pass) {
+    uint64_t base = mitm->lower + r * SEARCH_MITM_ROUND;
+    int count = 0;
+    if (base < mitm->upper) {
+        count = mitm->upper - base < SEARCH_MITM_ROUND ? (int)(mitm->upper - base) : SEARCH_MITM_ROUND;
+        values(mitm->arg, base, count, round->values);
+        mitm->computed += (uint64_t)count;
+    }
+
+    // Counting sort of the kept entries by owner
+    int n = mitm->size;
+    memset(round->send_counts, 0, (size_t)n * sizeof(int));
+    for (int i = 0; i < count; i++) {
+        uint64_t hash = search_mitm_hash(round->values[i]);
+        if (search_mitm_pass(mitm, hash) == pass) {
+            round->send_counts[search_mitm_owner(mitm, hash)]++;
+        }
+    }
+    int total = 0;
+    for (int p = 0; p < n; p++) {
+        round->send_displs[p] = total;
+        total += round->send_counts[p];
+    }
+    for (int i = 0; i < count; i++) {
+        uint64_t hash = search_mitm_hash(round->values[i]);
+        if (search_mitm_pass(mitm, hash) == pass) {
+            struct search_mitm_entry *entry = &round->send[round->send_displs[search_mitm_owner(mitm, hash)]++];
+            entry->value = round->values[i];
+            entry->position = base + (uint64_t)i;
+        }
+    }
+    for (int p = 0; p < n; p++) {
+        round->send_displs[p] -= round->send_counts[p];
+    }
+
+    MPI_Alltoall(round->send_counts, 1, MPI_INT, round->receive_counts, 1, MPI_INT, mitm->comm);
+    size_t received = 0;
+    for (int p = 0; p < n; p++) {
+        round->receive_displs[p] = (int)(received * sizeof(struct search_mitm_entry));
+        received += (size_t)round->receive_counts[p];
+        round->receive_counts[p] *= (int)sizeof(struct search_mitm_entry);
+        round->send_counts[p] *= (int)sizeof(struct search_mitm_entry);
+        round->send_displs[p] *= (int)sizeof(struct search_mitm_entry);
+    }
+    if (received > round->received) {
+        free(round->receive);
+        round->receive = malloc(received * sizeof(struct search_mitm_entry));
+        if (round->receive == NULL) {
+            search_mitm_fail(mitm);
+        }
+        round->received = received;
+    }
+    MPI_Alltoallv(round->send, round->send_counts, round->send_displs, MPI_BYTE, round->receive,
+                  round->receive_counts, round->receive_displs, MPI_BYTE, mitm->comm);
+    return received;
+}
+
+// Appends entries to the table of the pass
+static void search_mitm_store(struct search_mitm *mitm, const struct search_mitm_entry *entries, size_t count) {
+    if (mitm->count + count > mitm->capacity) {
+        size_t capacity = mitm->capacity == 0 ? SEARCH_MITM_ROUND : mitm->capacity;
+        while (capacity < mitm->count + count) {
+            capacity *= 2;
+        }
+        struct search_mitm_entry *table = realloc(mitm->table, capacity * sizeof(struct search_mitm_entry));
+        if (table == NULL) {
+            search_mitm_fail(mitm);
+        }
+        mitm->table = table;
+        mitm->capacity = capacity;
+    }
+    memcpy(mitm->table + mitm->count, entries, count * sizeof(struct search_mitm_entry));
+    mitm->count += count;
+}
+
+// Verifies every table entry the probe meets; returns 1 on the right pair
+static int search_mitm_probe(struct search_mitm *mitm, const struct search_mitm_entry *probe) {
+    size_t low = 0, high = mitm->count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (mitm->table[middle].value < probe->value) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    for (size_t i = low; i < mitm->count && mitm->table[i].value == probe->value; i++) {
+        mitm->candidates++;
+        if (mitm->verify(mitm->arg, mitm->table[i].position, probe->position)) {
+            mitm->table_position = mitm->table[i].position;
+            mitm->probe_position = probe->position;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Collective. Runs the passes until a pair is verified or every pass is
+// done; found, table_position and probe_position are then the same on
+// every process.
+static void search_mitm_run(struct search_mitm *mitm) {
+    struct search_mitm_round round;
+    search_mitm_round_init(mitm, &round);
+
+    int found = 0;
+    for (int pass = 0; pass < mitm->passes && !found; pass++) {
+        mitm->count = 0;
+        for (uint64_t r = 0; r < mitm->rounds; r++) {
+            size_t received = search_mitm_exchange(mitm, &round, mitm->table_values, r, pass);
+            search_mitm_store(mitm, round.receive, received);
+        }
+        qsort(mitm->table, mitm->count, sizeof(struct search_mitm_entry), search_mitm_compare);
+        if (mitm->count > mitm->largest) {
+            mitm->largest = mitm->count;
+        }
+
+        for (uint64_t r = 0; r < mitm->rounds && !found; r++) {
+            size_t received = search_mitm_exchange(mitm, &round, mitm->probe_values, r, pass);
+            for (size_t i = 0; i < received && !mitm->found; i++) {
+                mitm->found = search_mitm_probe(mitm, &round.receive[i]);
+            }
+            MPI_Allreduce(&mitm->found, &found, 1, MPI_INT, MPI_MAX, mitm->comm);
+        }
+    }
+    search_mitm_round_free(&round);
+    free(mitm->table);
+    mitm->table = NULL;
+    mitm->count = 0;
+    mitm->capacity = 0;
+
+    // The lowest process that verified a pair tells the others
+    int winner = mitm->found ? mitm->id : mitm->size;
+    int first;
+    MPI_Allreduce(&winner, &first, 1, MPI_INT, MPI_MIN, mitm->comm);
+    mitm->found = first < mitm->size;
+    if (mitm->found) {
+        uint64_t pair[2] = {mitm->table_position, mitm->probe_position};
+        MPI_Bcast(pair, 2, MPI_UINT64_T, first, mitm->comm);
+        mitm->table_position = pair[0];
+        mitm->probe_position = pair[1];
+    }
+}
+
+// Collective. Rank 0 prints the totals of the search.
+static void search_mitm_report(const struct search_mitm *mitm, double seconds) {
+    uint64_t local[2] = {mitm->computed, mitm->candidates}, total[2];
+    uint64_t largest;
+    MPI_Reduce(local, total, 2, MPI_UINT64_T, MPI_SUM, 0, mitm->comm);
+    MPI_Reduce(&mitm->largest, &largest, 1, MPI_UINT64_T, MPI_MAX, 0, mitm->comm);
+    if (mitm->id == 0) {
+        printf("Meet in the middle: %d passes, at most %llu table entries per process, %llu values computed, "
+               "%llu candidates, %f seconds\n",
+               mitm->passes, (unsigned long long)largest, (unsigned long long)total[0],
+               (unsigned long long)total[1], seconds);
+    }
+}
+
+#endif
@@ -0,0 +1,596 @@
+#ifndef SEARCH_OPTIONS_H
+#define SEARCH_OPTIONS_H
+
+// Optional "--name=value" flags shared by the search programs. They may be
+// given anywhere on the command line; parse_search_options() removes them
+// from argv so the positional arguments keep their original meaning.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "des_match_mode.h"
+#include "keyspace.h"
+#include "search_backend.h"
+#include "search_dict.h"
+
+enum search_distribution {
+    SEARCH_DIST_STATIC,       // Fixed share of the key space per process
+    SEARCH_DIST_DYNAMIC,      // Chunks handed out on demand by rank 0 (search_dist.h)
+    SEARCH_DIST_WEIGHTED      // Shares in proportion to the measured speed of each process
+};
+
+// Groups of flags, one bit each; every program passes the groups it
+// supports to parse_search_options(), which rejects the flags of the others
+enum search_option_set {
+    SEARCH_OPT_BACKEND = 1 << 0,       // --backend, --simd
+    SEARCH_OPT_ORDER = 1 << 1,         // --order
+    SEARCH_OPT_TRAVERSAL = 1 << 2,     // --traversal, --seed
+    SEARCH_OPT_OFFSET = 1 << 3,        // --offset
+    SEARCH_OPT_THREADS = 1 << 4,       // --threads
+    SEARCH_OPT_DISTRIBUTION = 1 << 5,  // --distribution, --chunk, --calibration, --rebalance, --lease
+    SEARCH_OPT_RANGE = 1 << 6,         // --key-bits, --key-pattern, --start, --end
+    SEARCH_OPT_CHECKPOINT = 1 << 7,    // --checkpoint, --checkpoint-interval, --resume
+    SEARCH_OPT_KEYWORDS = 1 << 8,      // --keyword, --match
+    SEARCH_OPT_BATCH = 1 << 9,         // --batch
+    SEARCH_OPT_TMTO = 1 << 10,         // --tmto-build, --tmto-lookup, --chains, --chain-length, --tables, --ciphertext
+    SEARCH_OPT_DICTIONARY = 1 << 11,   // --dictionary, --derive
+    SEARCH_OPT_MITM = 1 << 12          // --cipher, --memory
+};
+
+// Chained DES of mitm
+enum search_cipher {
+    SEARCH_CIPHER_2DES,       // DES-CBC with key1, then DES-CBC with key2
+    SEARCH_CIPHER_3DES2       // Two-key triple DES (EDE, key1 key2 key1) in CBC mode
+};
+
+// Default --chunk, in keys
+#define SEARCH_DEFAULT_CHUNK (1ULL << 24)
+
+// Most keywords per search: the one on the command line plus --keyword flags
+#define SEARCH_MAX_KEYWORDS DES_MATCH_MAX_KEYWORDS
+
+// Default --tables
+#define SEARCH_DEFAULT_TABLES 4
+
+// Default --memory, in MB
+#define SEARCH_DEFAULT_MEMORY 1024
+
+// Default --calibration, in seconds
+#define SEARCH_DEFAULT_CALIBRATION 0.5
+
+// Default --checkpoint-interval, in seconds
+#define SEARCH_DEFAULT_CHECKPOINT_INTERVAL 60.0
+
+struct search_options {
+    enum search_backend backend;
+    const char *simd;         // Bitsliced kernel: "auto" or a des_bitslice.h kernel name
+    enum keyspace_order order;
+    enum keyspace_traversal traversal;
+    int traversal_given;      // --traversal was given; otherwise each program picks its own
+    unsigned long long seed;  // Key of --traversal=random
+    long offset;              // Keyword position in the plaintext, -1 = anywhere
+    int threads;              // Worker threads per process (search_pool.h)
+    enum search_distribution distribution;
+    unsigned long long chunk; // Keys per chunk with the dynamic distribution
+    double calibration;       // Seconds each process times its search with the weighted distribution
+    double rebalance;         // Seconds between rebalances of the weighted distribution, 0 = never
+    double lease;             // Seconds a dynamic chunk may go without progress before it is reissued, 0 = never
+    const char *checkpoint;   // Checkpoint path prefix (search_checkpoint.h), NULL = none
+    double checkpoint_interval; // Seconds between checkpoints
+    int resume;               // Skip the keys recorded in the checkpoint
+    int key_bits;             // Search the counters (with --key-pattern, its positions) below 2^key_bits
+    int masked;               // --key-pattern was given
+    unsigned long long key_free;  // Counter bits the pattern leaves unknown
+    unsigned long long key_fixed; // Value of the known counter bits
+    unsigned long long start; // Search the counters in [start, end) (end defaults to 2^key_bits)
+    unsigned long long end;
+    const char *batch;        // File listing the targets of bruteforce_partB, NULL = one target
+    const char *tmto_build;   // Rainbow table set bruteforce builds (des_tmto.h), NULL = none
+    const char *tmto_lookup;  // Rainbow table set bruteforce looks the ciphertext up in, NULL = none
+    unsigned long long chains; // Chains per table, 0 = twice the keys over the chain length
+    unsigned long long chain_length; // Keys per chain, 0 = 2^ceil(key_bits / 3)
+    int tables;               // Tables with different reductions
+    int ciphertext_given;     // --ciphertext was given
+    unsigned char ciphertext[8]; // Block bruteforce --tmto-lookup recovers the key of
+    const char *dictionary;   // Wordlist bruteforce_partB tries before the key space, NULL = none
+    unsigned derive;          // Mask of search_dict_derive applied to each wordlist line
+    enum search_cipher cipher; // Cipher mitm attacks
+    unsigned long long memory; // Table bytes per process of mitm (search_mitm.h)
+    const char *keywords[SEARCH_MAX_KEYWORDS - 1]; // Extra keywords (--keyword)
+    int keyword_count;
+    enum des_match_mode match; // Any or all of the keywords must appear
+};
+
+// Prints the flags of the supported groups (search_option_set)
+static void print_search_options(unsigned supported) {
+    printf("Options:\n");
+    if (supported & SEARCH_OPT_BACKEND) {
+        printf("  --backend=openssl|bitslice   DES implementation used by the search loop (default: openssl)\n");
+        printf("  --simd=auto|scalar|sse2|avx2|avx512\n");
+        printf("                               register width of the bitslice backend (default: auto, chosen via CPUID)\n");
+    }
+    if (supported & SEARCH_OPT_ORDER) {
+        printf("  --order=linear|gray          key traversal; gray visits keys in Gray-code order and updates\n");
+        printf("                               the OpenSSL key schedule in place (default: linear)\n");
+    }
+    if (supported & SEARCH_OPT_TRAVERSAL) {
+        printf("  --traversal=forward|reverse|bidirectional|interleaved|bit-reversed|random\n");
+        printf("                               MPI programs: forward, reverse or bidirectional (odd processes\n");
+        printf("                               downwards) set the direction each process walks its range;\n");
+        printf("                               interleaved gives process r of N the keys r, r + N, ...;\n");
+        printf("                               bit-reversed and random permute the keys (default: bidirectional\n");
+        printf("                               in solucion1 and solucion2, forward elsewhere)\n");
+        printf("  --seed=N                     key of --traversal=random (default: 0)\n");
+    }
+    if (supported & SEARCH_OPT_OFFSET) {
+        printf("  --offset=N                   the keyword starts at byte N of the plaintext; only the blocks\n");
+        printf("                               it spans are decrypted per key (default: search the whole text)\n");
+    }
+    if (supported & SEARCH_OPT_THREADS) {
+        printf("  --threads=N                  worker threads searching each process's range (default: 1)\n");
+    }
+    if (supported & SEARCH_OPT_DISTRIBUTION) {
+        printf("  --distribution=static|dynamic|weighted\n");
+        printf("                               static splits the key space evenly between processes; dynamic\n");
+        printf("                               hands out chunks on demand from rank 0; weighted splits it in\n");
+        printf("                               proportion to the speed each process measures (default: static)\n");
+        printf("  --chunk=N                    keys per chunk with --distribution=dynamic (default: %llu)\n",
+               SEARCH_DEFAULT_CHUNK);
+        printf("  --calibration=S              seconds each process times its search before a weighted split\n");
+        printf("                               (default: %.1f)\n", SEARCH_DEFAULT_CALIBRATION);
+        printf("  --rebalance=S                with --distribution=weighted, move keys from the processes that\n");
+        printf("                               fell behind to those ahead every S seconds (default: never)\n");
+        printf("  --lease=S                    with --distribution=dynamic, hand the chunks of a process that\n");
+        printf("                               showed no progress for S seconds to the others and stop waiting\n");
+        printf("                               for it (default: never)\n");
+    }
+    if (supported & SEARCH_OPT_RANGE) {
+        printf("  --key-bits=N                 search only the 2^N keys with counters below 2^N (default: %d)\n",
+               KEYSPACE_BITS);
+        printf("  --key-pattern=B0:B1:...:B7   MPI programs: search only the keys matching a pattern of the 8 key\n");
+        printf("                               bytes, each two hex digits (known), ?? (unknown) or 8 bits of 0, 1\n");
+        printf("                               or ? from the most significant (the last one, parity, is ignored);\n");
+        printf("                               only the unknown bits are enumerated, --start and --end count them\n");
+        printf("  --start=N, --end=N           MPI programs: search only the counters in [N, M), split between the\n");
+        printf("                               processes like the whole space; decimal or 0x hex (default: 0 and\n");
+        printf("                               2^key-bits)\n");
+    }
+    if (supported & SEARCH_OPT_CHECKPOINT) {
+        printf("  --checkpoint=PATH            periodically record the searched keys in PATH.<rank>\n");
+        printf("  --checkpoint-interval=S      seconds between checkpoints (default: %.0f)\n",
+               SEARCH_DEFAULT_CHECKPOINT_INTERVAL);
+        printf("  --resume                     skip the keys recorded in the --checkpoint files, which may\n");
+        printf("                               come from a run with a different number of processes\n");
+    }
+    if (supported & SEARCH_OPT_KEYWORDS) {
+        printf("  --keyword=WORD               another keyword to look for; may be repeated\n");
+        printf("  --match=any|all              a key is right if the text holds any or all of the keywords\n");
+        printf("                               (default: any)\n");
+    }
+    if (supported & SEARCH_OPT_BATCH) {
+        printf("  --batch=FILE                 bruteforce_partB: search for every \"<file> <key> <keyword>\" line\n");
+        printf("                               of FILE at once, setting up each candidate key only once\n");
+    }
+    if (supported & SEARCH_OPT_TMTO) {
+        printf("  --tmto-build=PATH            bruteforce: build rainbow tables for its plaintext block, each process\n");
+        printf("                               writing its share of the chains to PATH.<rank>\n");
+        printf("  --tmto-lookup=PATH           bruteforce: recover the key of the ciphertext from the PATH tables\n");
+        printf("                               instead of searching the key space\n");
+        printf("  --chains=N, --chain-length=T, --tables=K\n");
+        printf("                               table shape for --tmto-build (default: T = 2^ceil(key-bits / 3),\n");
+        printf("                               N = 2 * 2^key-bits / T, K = %d)\n", SEARCH_DEFAULT_TABLES);
+        printf("  --ciphertext=HEX             bruteforce --tmto-lookup: the 16 hex digit block to recover the key\n");
+        printf("                               of (default: the block bruteforce encrypts)\n");
+    }
+    if (supported & SEARCH_OPT_DICTIONARY) {
+        printf("  --dictionary=FILE            bruteforce_partB: try the keys of each line of FILE (memory-mapped,\n");
+        printf("                               split between processes by byte offset) before the key space\n");
+        printf("  --derive=raw,hex,parity,string\n");
+        printf("                               keys tried per --dictionary line: its first 8 bytes, the 16 hex\n");
+        printf("                               digits it holds, its first 8 bytes shifted past the parity bits,\n");
+        printf("                               DES_string_to_key() of it; any comma-separated set (default: raw)\n");
+    }
+    if (supported & SEARCH_OPT_MITM) {
+        printf("  --cipher=2des|3des2          mitm: double DES (CBC with key1, then key2) or two-key triple DES\n");
+        printf("                               (default: 2des)\n");
+        printf("  --memory=MB                  mitm: meet-in-the-middle table per process; a larger table is built\n");
+        printf("                               and probed in passes (default: %d)\n", SEARCH_DEFAULT_MEMORY);
+    }
+}
+
+// Parses a --key-pattern value into the unknown counter bits and the value
+// of the known ones. Key byte i, bit b (7 to 1) is counter bit
+// 7 * (7 - i) + b - 1 (keyspace.h). Returns -1 if the pattern is malformed.
+static int parse_key_pattern(const char *pattern, unsigned long long *free, unsigned long long *fixed) {
+    *free = 0;
+    *fixed = 0;
+    const char *p = pattern;
+    for (int i = 0; i < 8; i++) {
+        size_t length = strcspn(p, ":");
+        int shift = 7 * (7 - i);
+        if (length == 2 && p[0] == '?' && p[1] == '?') {
+            *free |= 0x7FULL << shift;
+        } else if (length == 2 && strspn(p, "0123456789abcdefABCDEF") >= 2) {
+            char hex[3] = {p[0], p[1], '\0'};
+            *fixed |= (strtoull(hex, NULL, 16) >> 1) << shift;
+        } else if (length == 8 && strspn(p, "01?") >= 8) {
+            for (int b = 7; b >= 1; b--) {
+                char c = p[7 - b];
+                if (c == '?') {
+                    *free |= 1ULL << (shift + b - 1);
+                } else if (c == '1') {
+                    *fixed |= 1ULL << (shift + b - 1);
+                }
+            }
+        } else {
+            return -1;
+        }
+        p += length;
+        if (*p != (i == 7 ? '\0' : ':')) {
+            return -1;
+        }
+        p += i < 7;
+    }
+    return *free != 0 ? 0 : -1;
+}
+
+// Parses a private key given as an argument or in a --batch line: decimal,
+// 0x hex or 0 octal. Returns -1 (after printing why) if it is empty,
+// negative or followed by anything else.
+static inline int parse_search_key(const char *text, unsigned long long *key) {
+    char *end;
+    *key = strtoull(text, &end, 0);
+    if (*text == '\0' || *text == '-' || *end != '\0') {
+        printf("Error: invalid private key %s\n", text);
+        return -1;
+    }
+    return 0;
+}
+
+// Group of the flag arg ("--name" or "--name=value"), 0 if it is unknown
+static unsigned search_option_group(const char *arg) {
+    static const struct {
+        const char *name;
+        unsigned group;
+    } flags[] = {
+        {"backend", SEARCH_OPT_BACKEND}, {"simd", SEARCH_OPT_BACKEND}, {"order", SEARCH_OPT_ORDER},
+        {"traversal", SEARCH_OPT_TRAVERSAL}, {"seed", SEARCH_OPT_TRAVERSAL}, {"offset", SEARCH_OPT_OFFSET},
+        {"threads", SEARCH_OPT_THREADS}, {"distribution", SEARCH_OPT_DISTRIBUTION},
+        {"chunk", SEARCH_OPT_DISTRIBUTION}, {"calibration", SEARCH_OPT_DISTRIBUTION},
+        {"rebalance", SEARCH_OPT_DISTRIBUTION}, {"lease", SEARCH_OPT_DISTRIBUTION}, {"key-bits", SEARCH_OPT_RANGE},
+        {"key-pattern", SEARCH_OPT_RANGE}, {"start", SEARCH_OPT_RANGE}, {"end", SEARCH_OPT_RANGE},
+        {"checkpoint", SEARCH_OPT_CHECKPOINT}, {"checkpoint-interval", SEARCH_OPT_CHECKPOINT},
+        {"resume", SEARCH_OPT_CHECKPOINT}, {"keyword", SEARCH_OPT_KEYWORDS}, {"match", SEARCH_OPT_KEYWORDS},
+        {"batch", SEARCH_OPT_BATCH}, {"tmto-build", SEARCH_OPT_TMTO}, {"tmto-lookup", SEARCH_OPT_TMTO},
+        {"chains", SEARCH_OPT_TMTO}, {"chain-length", SEARCH_OPT_TMTO}, {"tables", SEARCH_OPT_TMTO},
+        {"ciphertext", SEARCH_OPT_TMTO}, {"dictionary", SEARCH_OPT_DICTIONARY}, {"derive", SEARCH_OPT_DICTIONARY},
+        {"cipher", SEARCH_OPT_MITM}, {"memory", SEARCH_OPT_MITM}
+    };
+    size_t length = strcspn(arg + 2, "=");
+    for (size_t f = 0; f < sizeof(flags) / sizeof(flags[0]); f++) {
+        if (strlen(flags[f].name) == length && strncmp(arg + 2, flags[f].name, length) == 0) {
+            return flags[f].group;
+        }
+    }
+    return 0;
+}
+
+// Parses the flags of the supported groups (search_option_set). Returns 0
+// on success or -1 (after printing the offending flag) when an option is
+// unknown, belongs to a group the program does not support or has an
+// invalid value.
+static int parse_search_options(int *argc, char *argv[], unsigned supported, struct search_options *opts) {
+    opts->backend = SEARCH_BACKEND_OPENSSL;
+    opts->simd = "auto";
+    opts->order = KEYSPACE_ORDER_LINEAR;
+    opts->traversal = KEYSPACE_TRAVERSAL_FORWARD;
+    opts->traversal_given = 0;
+    opts->seed = 0;
+    opts->offset = -1;
+    opts->threads = 1;
+    opts->distribution = SEARCH_DIST_STATIC;
+    opts->chunk = SEARCH_DEFAULT_CHUNK;
+    opts->calibration = SEARCH_DEFAULT_CALIBRATION;
+    opts->rebalance = 0;
+    opts->lease = 0;
+    opts->checkpoint = NULL;
+    opts->checkpoint_interval = SEARCH_DEFAULT_CHECKPOINT_INTERVAL;
+    opts->resume = 0;
+    opts->key_bits = KEYSPACE_BITS;
+    opts->masked = 0;
+    opts->key_free = 0;
+    opts->key_fixed = 0;
+    opts->start = 0;
+    opts->end = 0;
+    opts->batch = NULL;
+    opts->tmto_build = NULL;
+    opts->tmto_lookup = NULL;
+    opts->chains = 0;
+    opts->chain_length = 0;
+    opts->tables = SEARCH_DEFAULT_TABLES;
+    opts->ciphertext_given = 0;
+    opts->dictionary = NULL;
+    opts->derive = SEARCH_DERIVE_RAW;
+    opts->cipher = SEARCH_CIPHER_2DES;
+    opts->memory = (unsigned long long)SEARCH_DEFAULT_MEMORY << 20;
+    opts->keyword_count = 0;
+    opts->match = DES_MATCH_ANY;
+
+    int kept = 1;
+    for (int i = 1; i < *argc; i++) {
+        const char *arg = argv[i];
+        if (strncmp(arg, "--", 2) != 0) {
+            argv[kept++] = argv[i];
+            continue;
+        }
+        unsigned group = search_option_group(arg);
+        if (group != 0 && (supported & group) == 0) {
+            printf("Error: %s does not apply to %s\n", arg, argv[0]);
+            return -1;
+        }
+
+        if (strcmp(arg, "--backend=openssl") == 0) {
+            opts->backend = SEARCH_BACKEND_OPENSSL;
+        } else if (strcmp(arg, "--backend=bitslice") == 0) {
+            opts->backend = SEARCH_BACKEND_BITSLICE;
+        } else if (strcmp(arg, "--order=linear") == 0) {
+            opts->order = KEYSPACE_ORDER_LINEAR;
+        } else if (strcmp(arg, "--order=gray") == 0) {
+            opts->order = KEYSPACE_ORDER_GRAY;
+        } else if (strncmp(arg, "--traversal=", 12) == 0) {
+            static const char *const names[] = {"forward", "reverse", "bidirectional", "interleaved",
+                                                "bit-reversed", "random"};
+            int t = 0;
+            while (t < 6 && strcmp(arg + 12, names[t]) != 0) {
+                t++;
+            }
+            if (t == 6) {
+                printf("Error: unknown traversal in %s\n", arg);
+                return -1;
+            }
+            opts->traversal = (enum keyspace_traversal)t;
+            opts->traversal_given = 1;
+        } else if (strncmp(arg, "--seed=", 7) == 0) {
+            char *end;
+            opts->seed = strtoull(arg + 7, &end, 0);
+            if (arg[7] == '\0' || *end != '\0') {
+                printf("Error: invalid seed in %s\n", arg);
+                return -1;
+            }
+        } else if (strncmp(arg, "--simd=", 7) == 0) {
+            opts->simd = arg + 7;
+        } else if (strncmp(arg, "--offset=", 9) == 0) {
+            char *end;
+            opts->offset = strtol(arg + 9, &end, 10);
+            if (arg[9] == '\0' || *end != '\0' || opts->offset < 0) {
+                printf("Error: invalid offset in %s\n", arg);
+                return -1;
+            }
+        } else if (strncmp(arg, "--threads=", 10) == 0) {
+            char *end;
+            long threads = strtol(arg + 10, &end, 10);
+            if (arg[10] == '\0' || *end != '\0' || threads < 1 || threads > 1024) {
+                printf("Error: invalid thread count in %s\n", arg);
+                return -1;
+            }
+            opts->threads = (int)threads;
+        } else if (strcmp(arg, "--distribution=static") == 0) {
+            opts->distribution = SEARCH_DIST_STATIC;
+        } else if (strcmp(arg, "--distribution=dynamic") == 0) {
+            opts->distribution = SEARCH_DIST_DYNAMIC;
+        } else if (strcmp(arg, "--distribution=weighted") == 0) {
+            opts->distribution = SEARCH_DIST_WEIGHTED;
+        } else if (strncmp(arg, "--calibration=", 14) == 0 || strncmp(arg, "--rebalance=", 12) == 0
+                   || strncmp(arg, "--lease=", 8) == 0) {
+            double *field = arg[2] == 'c' ? &opts->calibration : arg[2] == 'r' ? &opts->rebalance : &opts->lease;
+            const char *value = strchr(arg, '=') + 1;
+            char *end;
+            double seconds = strtod(value, &end);
+            if (*value == '\0' || *end != '\0' || !(seconds > 0)) {
+                printf("Error: invalid time in %s\n", arg);
+                return -1;
+            }
+            *field = seconds;
+        } else if (strncmp(arg, "--chunk=", 8) == 0) {
+            char *end;
+            opts->chunk = strtoull(arg + 8, &end, 10);
+            if (arg[8] == '\0' || *end != '\0' || opts->chunk == 0) {
+                printf("Error: invalid chunk size in %s\n", arg);
+                return -1;
+            }
+        } else if (strncmp(arg, "--checkpoint=", 13) == 0 && arg[13] != '\0') {
+            opts->checkpoint = arg + 13;
+        } else if (strncmp(arg, "--checkpoint-interval=", 22) == 0) {
+            char *end;
+            opts->checkpoint_interval = strtod(arg + 22, &end);
+            if (arg[22] == '\0' || *end != '\0' || !(opts->checkpoint_interval > 0)) {
+                printf("Error: invalid checkpoint interval in %s\n", arg);
+                return -1;
+            }
+        } else if (strncmp(arg, "--key-bits=", 11) == 0) {
+            char *end;
+            long bits = strtol(arg + 11, &end, 10);
+            if (arg[11] == '\0' || *end != '\0' || bits < 1 || bits > KEYSPACE_BITS) {
+                printf("Error: invalid key width in %s\n", arg);
+                return -1;
+            }
+            opts->key_bits = (int)bits;
+        } else if (strncmp(arg, "--key-pattern=", 14) == 0) {
+            if (parse_key_pattern(arg + 14, &opts->key_free, &opts->key_fixed) != 0) {
+                printf("Error: invalid key pattern in %s (8 bytes separated by ':', at least one bit unknown)\n",
+                       arg);
+                return -1;
+            }
+            opts->masked = 1;
+        } else if (strncmp(arg, "--start=", 8) == 0 || strncmp(arg, "--end=", 6) == 0) {
+            int end = arg[2] == 'e';
+            const char *value = arg + (end ? 6 : 8);
+            char *stop;
+            unsigned long long counter = strtoull(value, &stop, 0);
+            if (*value == '\0' || *value == '-' || *stop != '\0' || counter > KEYSPACE_SIZE
+                || (end && counter == 0)) {
+                printf("Error: invalid key counter in %s\n", arg);
+                return -1;
+            }
+            *(end ? &opts->end : &opts->start) = counter;
+        } else if (strncmp(arg, "--batch=", 8) == 0 && arg[8] != '\0') {
+            opts->batch = arg + 8;
+        } else if (strncmp(arg, "--tmto-build=", 13) == 0 && arg[13] != '\0') {
+            opts->tmto_build = arg + 13;
+        } else if (strncmp(arg, "--tmto-lookup=", 14) == 0 && arg[14] != '\0') {
+            opts->tmto_lookup = arg + 14;
+        } else if (strncmp(arg, "--chains=", 9) == 0 || strncmp(arg, "--chain-length=", 15) == 0) {
+            int length = arg[7] == '-';
+            const char *value = arg + (length ? 15 : 9);
+            char *end;
+            unsigned long long n = strtoull(value, &end, 10);
+            if (*value == '\0' || *value == '-' || *end != '\0' || n == 0 || n > (1ULL << 40)) {
+                printf("Error: invalid table size in %s\n", arg);
+                return -1;
+            }
+            *(length ? &opts->chain_length : &opts->chains) = n;
+        } else if (strncmp(arg, "--tables=", 9) == 0) {
+            char *end;
+            long tables = strtol(arg + 9, &end, 10);
+            if (arg[9] == '\0' || *end != '\0' || tables < 1 || tables != (int)tables) {
+                printf("Error: invalid table count in %s\n", arg);
+                return -1;
+            }
+            opts->tables = (int)tables;
+        } else if (strncmp(arg, "--ciphertext=", 13) == 0) {
+            const char *hex = arg + 13;
+            if (strlen(hex) != 16 || strspn(hex, "0123456789abcdefABCDEF") != 16) {
+                printf("Error: %s needs 16 hex digits\n", arg);
+                return -1;
+            }
+            for (int i = 0; i < 8; i++) {
+                char byte[3] = {hex[2 * i], hex[2 * i + 1], '\0'};
+                opts->ciphertext[i] = (unsigned char)strtoul(byte, NULL, 16);
+            }
+            opts->ciphertext_given = 1;
+        } else if (strncmp(arg, "--dictionary=", 13) == 0 && arg[13] != '\0') {
+            opts->dictionary = arg + 13;
+        } else if (strncmp(arg, "--derive=", 9) == 0) {
+            opts->derive = 0;
+            for (const char *name = arg + 9; ; name++) {
+                size_t length = strcspn(name, ",");
+                int d = 0;
+                while (d < SEARCH_DERIVE_COUNT && (strlen(search_dict_derive_names[d]) != length
+                                                   || strncmp(name, search_dict_derive_names[d], length) != 0)) {
+                    d++;
+                }
+                if (d == SEARCH_DERIVE_COUNT) {
+                    printf("Error: unknown derivation in %s\n", arg);
+                    return -1;
+                }
+                opts->derive |= 1u << d;
+                name += length;
+                if (*name == '\0') {
+                    break;
+                }
+            }
+        } else if (strcmp(arg, "--cipher=2des") == 0) {
+            opts->cipher = SEARCH_CIPHER_2DES;
+        } else if (strcmp(arg, "--cipher=3des2") == 0) {
+            opts->cipher = SEARCH_CIPHER_3DES2;
+        } else if (strncmp(arg, "--memory=", 9) == 0) {
+            char *end;
+            unsigned long long mb = strtoull(arg + 9, &end, 10);
+            if (arg[9] == '\0' || arg[9] == '-' || *end != '\0' || mb == 0 || mb > (1ULL << 30)) {
+                printf("Error: invalid memory size in %s\n", arg);
+                return -1;
+            }
+            opts->memory = mb << 20;
+        } else if (strncmp(arg, "--keyword=", 10) == 0 && arg[10] != '\0') {
+            if (opts->keyword_count == SEARCH_MAX_KEYWORDS - 1) {
+                printf("Error: at most %d keywords\n", SEARCH_MAX_KEYWORDS);
+                return -1;
+            }
+            opts->keywords[opts->keyword_count++] = arg + 10;
+        } else if (strcmp(arg, "--match=any") == 0) {
+            opts->match = DES_MATCH_ANY;
+        } else if (strcmp(arg, "--match=all") == 0) {
+            opts->match = DES_MATCH_ALL;
+        } else if (strcmp(arg, "--resume") == 0) {
+            opts->resume = 1;
+        } else {
+            printf("Error: unknown option %s\n", arg);
+            return -1;
+        }
+    }
+    if (opts->resume && opts->checkpoint == NULL) {
+        printf("Error: --resume needs --checkpoint=PATH\n");
+        return -1;
+    }
+    if (opts->masked) {
+        // The positions enumerate the unknown bits only
+        if (opts->key_bits != KEYSPACE_BITS) {
+            printf("Error: --key-pattern cannot be combined with --key-bits\n");
+            return -1;
+        }
+        opts->key_bits = __builtin_popcountll(opts->key_free);
+    }
+    unsigned long long limit = 1ULL << opts->key_bits;
+    if (opts->end == 0) {
+        opts->end = limit;
+    }
+    if (opts->start >= opts->end || opts->end > limit) {
+        printf("Error: --start and --end need start < end <= 2^%d\n", opts->key_bits);
+        return -1;
+    }
+    if (opts->order == KEYSPACE_ORDER_GRAY && keyspace_traversal_shuffles(opts->traversal)) {
+        // The Gray-code walk needs consecutive positions
+        printf("Error: --order=gray only works with the forward, reverse and bidirectional traversals\n");
+        return -1;
+    }
+    if (opts->rebalance > 0 && opts->distribution != SEARCH_DIST_WEIGHTED) {
+        printf("Error: --rebalance needs --distribution=weighted\n");
+        return -1;
+    }
+    if (opts->lease > 0 && opts->distribution != SEARCH_DIST_DYNAMIC) {
+        printf("Error: --lease needs --distribution=dynamic\n");
+        return -1;
+    }
+    if (opts->tmto_build != NULL && opts->tmto_lookup != NULL) {
+        printf("Error: --tmto-build and --tmto-lookup are separate runs\n");
+        return -1;
+    }
+    if (opts->batch != NULL && opts->checkpoint != NULL) {
+        // A checkpoint records searched positions, not the keys already found
+        printf("Error: --batch cannot be combined with --checkpoint\n");
+        return -1;
+    }
+    argv[kept] = NULL;
+    *argc = kept;
+    return 0;
+}
+
+// --traversal, or fallback if it was not given
+static inline enum keyspace_traversal search_traversal(const struct search_options *opts,
+                                                       enum keyspace_traversal fallback) {
+    return opts->traversal_given ? opts->traversal : fallback;
+}
+
+// The mask of --key-pattern, set up in mask, or NULL without one
+static inline const struct keyspace_mask *search_key_mask(const struct search_options *opts,
+                                                          struct keyspace_mask *mask) {
+    if (!opts->masked) {
+        return NULL;
+    }
+    keyspace_mask_init(mask, opts->key_free, opts->key_fixed);
+    return mask;
+}
+
+// Fills keywords with primary followed by the --keyword flags. Returns
+// their number.
+static inline int search_keywords(const struct search_options *opts, const char *primary,
+                                  const char *keywords[SEARCH_MAX_KEYWORDS]) {
+    keywords[0] = primary;
+    for (int k = 0; k < opts->keyword_count; k++) {
+        keywords[k + 1] = opts->keywords[k];
+    }
+    return opts->keyword_count + 1;
+}
+
+#endif
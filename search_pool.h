@@ -0,0 +1,677 @@
+#ifndef SEARCH_POOL_H
+#define SEARCH_POOL_H
+
+// Thread pool that searches one rank's share of the key space.
+//
+// The owner of the pool feeds it ranges of positions (search_pool_feed) and
+// closes it when no more will come. Each worker thread owns a
+// search_context and takes chunks of SEARCH_POOL_CHUNK positions from the
+// oldest queued range, so a thread that gets ahead simply takes more chunks;
+// workers wait while the queue is empty and the pool is still open. Solving
+// the last target, or a stop requested by the owner (for example because
+// another rank found the key), sets a shared flag the workers check between
+// keys. Only the thread that started the pool talks to MPI
+// (MPI_THREAD_FUNNELED is enough).
+//
+// The flags the workers read before every key (stop and solved) sit on a
+// cache line of their own, apart from the lock and the queue that change
+// with every chunk, and each worker's state starts a new cache line, so
+// the workers only share a line with another thread when the search state
+// really changes. The queue itself stays behind a mutex: a worker takes it
+// once per chunk, a few hundred times a second per process even with the
+// widest bitslice kernel, so a lock-free queue would save nothing
+// measurable.
+//
+// With several targets a hit retires just that target: the workers keep
+// going with the others, and the owner can also retire targets solved by
+// other processes (search_pool_retire).
+//
+// The owner can also take back the part of the newest range that was not
+// handed out yet (search_pool_trim), to pass it to another process.
+//
+// With search_pool_track() the pool records the chunks its workers complete,
+// and positions in its skip set (a resumed checkpoint) are never handed out;
+// search_pool_record() only records them, and search_pool_covered() tells
+// whether a range is complete (search_dist.h confirms leased chunks so).
+// Ranges, chunks and recorded coverage are all in positions; with
+// search_pool_map() the workers map each position to the counter it
+// tests only when they try the key; with search_pool_dict() the positions
+// are byte offsets of a wordlist instead (search_dict.h).
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "des_bitslice.h"
+#include "des_check.h"
+#include "des_gray.h"
+#include "keyspace.h"
+#include "search_context.h"
+#include "search_coverage.h"
+#include "search_dict.h"
+#include "search_options.h"
+
+// Positions handed to a worker at a time (a multiple of every bitslice width)
+#define SEARCH_POOL_CHUNK (1ULL << 16)
+
+// How long search_pool_nap() sleeps, in nanoseconds
+#define SEARCH_POOL_NAP_NS 1000000L
+
+// Ranges that can wait in the queue
+#define SEARCH_POOL_QUEUE 8
+
+// Cache line size, for the layout of the state threads share
+#define SEARCH_POOL_LINE 64
+
+// Positions first..last; first > last walks the range downwards
+struct search_range {
+    uint64_t first;
+    uint64_t last;
+};
+
+struct search_pool;
+
+struct search_worker {
+    _Alignas(SEARCH_POOL_LINE) struct search_pool *pool;
+    pthread_t thread;
+    struct search_context ctx;
+    _Atomic uint64_t tested;      // Keys tested by this worker; the owner reads it while searching
+    uint64_t busy_ns;             // Time spent searching chunks
+};
+
+struct search_pool {
+    const struct des_check *checks;
+    int targets;
+    uint64_t all;                 // Mask of all the targets
+    enum search_backend backend;
+    enum keyspace_order order;
+    const struct keyspace_map *map; // Position to counter map, or NULL
+    const struct search_dict *dict; // Positions are offsets into this wordlist, or NULL
+    // Read by the workers before every key, written only when the search state changes
+    _Alignas(SEARCH_POOL_LINE) atomic_int stop;
+    _Atomic uint64_t solved;      // Targets solved here or elsewhere; workers skip them
+    atomic_int active;            // Workers that have not returned yet
+    _Alignas(SEARCH_POOL_LINE) pthread_mutex_t lock; // Protects everything below
+    pthread_cond_t more;          // Signalled on feed, close and stop
+    struct search_range queue[SEARCH_POOL_QUEUE];
+    int head;
+    int queued;
+    uint64_t taken;               // Positions of queue[head] already handed out
+    uint64_t handed;              // Positions handed out to the workers so far
+    int closed;
+    int hit;                      // The workers solved a target
+    uint64_t own;                 // Targets solved by the workers
+    uint64_t found[SEARCH_TARGETS_MAX]; // Counter of the key of each of them
+    const struct search_coverage *skip; // Positions already searched, or NULL
+    uint64_t skipped;             // Positions not handed out because of skip
+    int tracking;                 // Record completed chunks in done
+    struct search_coverage done;
+    int threads;
+    struct search_worker *workers;
+};
+
+// Counters of all the workers of a pool
+struct search_pool_counters {
+    uint64_t tested;
+    uint64_t busy_ns;
+    struct des_check_stats check;
+};
+
+// Counts n keys tested by w. Only w writes its counter, so a relaxed load
+// and store (no locked add) keep it readable from the owner.
+static inline void search_worker_tested(struct search_worker *w, uint64_t n) {
+    atomic_store_explicit(&w->tested, atomic_load_explicit(&w->tested, memory_order_relaxed) + n,
+                          memory_order_relaxed);
+}
+
+static inline int search_pool_stopped(struct search_pool *pool) {
+    return atomic_load_explicit(&pool->stop, memory_order_relaxed);
+}
+
+// Asks the workers to stop after their current key or pass
+static void search_pool_stop(struct search_pool *pool) {
+    atomic_store_explicit(&pool->stop, 1, memory_order_relaxed);
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_broadcast(&pool->more);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static inline uint64_t search_range_size(const struct search_range *range) {
+    return (range->first <= range->last ? range->last - range->first : range->first - range->last) + 1;
+}
+
+// Queues positions first..last. Returns -1 if the queue is full.
+static int search_pool_feed(struct search_pool *pool, uint64_t first, uint64_t last) {
+    pthread_mutex_lock(&pool->lock);
+    if (pool->queued == SEARCH_POOL_QUEUE) {
+        pthread_mutex_unlock(&pool->lock);
+        return -1;
+    }
+    struct search_range *range = &pool->queue[(pool->head + pool->queued) % SEARCH_POOL_QUEUE];
+    range->first = first;
+    range->last = last;
+    pool->queued++;
+    pthread_cond_broadcast(&pool->more);
+    pthread_mutex_unlock(&pool->lock);
+    return 0;
+}
+
+// No more ranges will be fed; workers return once the queue is drained
+static void search_pool_close(struct search_pool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->closed = 1;
+    pthread_cond_broadcast(&pool->more);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// Ranges queued and not fully handed out yet
+static int search_pool_queued(struct search_pool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    int queued = pool->queued;
+    pthread_mutex_unlock(&pool->lock);
+    return queued;
+}
+
+// Positions queued and not handed out yet. The part of the newest range not
+// handed out goes to tail (spare positions, walked from tail->first), and
+// the free queue slots to slots.
+static uint64_t search_pool_backlog(struct search_pool *pool, struct search_range *tail, uint64_t *spare,
+                                    int *slots) {
+    pthread_mutex_lock(&pool->lock);
+    uint64_t backlog = 0;
+    *spare = 0;
+    for (int q = 0; q < pool->queued; q++) {
+        struct search_range range = pool->queue[(pool->head + q) % SEARCH_POOL_QUEUE];
+        uint64_t left = search_range_size(&range);
+        if (q == 0) {
+            left -= pool->taken;
+            range.first = range.first > range.last ? range.first - pool->taken : range.first + pool->taken;
+        }
+        backlog += left;
+        *tail = range;
+        *spare = left;
+    }
+    *slots = SEARCH_POOL_QUEUE - pool->queued;
+    pthread_mutex_unlock(&pool->lock);
+    return backlog;
+}
+
+// Takes up to n positions off the far end of the newest range, never any
+// already handed out. Returns how many it took.
+static uint64_t search_pool_trim(struct search_pool *pool, uint64_t n) {
+    pthread_mutex_lock(&pool->lock);
+    uint64_t trimmed = 0;
+    if (pool->queued > 0) {
+        int newest = (pool->head + pool->queued - 1) % SEARCH_POOL_QUEUE;
+        struct search_range *range = &pool->queue[newest];
+        uint64_t left = search_range_size(range) - (pool->queued == 1 ? pool->taken : 0);
+        if (n >= left) {
+            trimmed = left;
+            pool->queued--;
+            if (pool->queued == 0) {
+                pool->taken = 0;
+            }
+        } else {
+            trimmed = n;
+            range->last = range->first > range->last ? range->last + n : range->last - n;
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return trimmed;
+}
+
+// Keys the workers tested so far
+static uint64_t search_pool_tested(struct search_pool *pool) {
+    uint64_t tested = 0;
+    for (int t = 0; t < pool->threads; t++) {
+        tested += atomic_load_explicit(&pool->workers[t].tested, memory_order_relaxed);
+    }
+    return tested;
+}
+
+// Positions handed out to the workers so far
+static uint64_t search_pool_handed(struct search_pool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    uint64_t handed = pool->handed;
+    pthread_mutex_unlock(&pool->lock);
+    return handed;
+}
+
+// Moves n positions past the front of queue[head] (lock held)
+static void search_pool_advance(struct search_pool *pool, uint64_t n) {
+    pool->taken += n;
+    if (pool->taken == search_range_size(&pool->queue[pool->head])) {
+        pool->head = (pool->head + 1) % SEARCH_POOL_QUEUE;
+        pool->queued--;
+        pool->taken = 0;
+    }
+}
+
+// Hands the next chunk to a worker. Returns 0 once the pool is stopped, or
+// closed and drained.
+static int search_pool_take(struct search_pool *pool, uint64_t *a, uint64_t *b) {
+    pthread_mutex_lock(&pool->lock);
+    while (!search_pool_stopped(pool)) {
+        if (pool->queued > 0) {
+            struct search_range *range = &pool->queue[pool->head];
+            int down = range->first > range->last;
+            uint64_t left = search_range_size(range) - pool->taken;
+            uint64_t n = left < SEARCH_POOL_CHUNK ? left : SEARCH_POOL_CHUNK;
+            *a = down ? range->first - pool->taken : range->first + pool->taken;
+            if (pool->skip != NULL) {
+                // Jump over a covered run at once, and stop the chunk where
+                // the next one starts
+                int covered;
+                uint64_t run = search_coverage_run(pool->skip, *a, down, &covered);
+                if (covered) {
+                    run = run < left ? run : left;
+                    pool->skipped += run;
+                    search_pool_advance(pool, run);
+                    continue;
+                }
+                n = run < n ? run : n;
+            }
+            *b = down ? *a - (n - 1) : *a + (n - 1);
+            search_pool_advance(pool, n);
+            pool->handed += n;
+            pthread_mutex_unlock(&pool->lock);
+            return 1;
+        }
+        if (pool->closed) {
+            break;
+        }
+        pthread_cond_wait(&pool->more, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return 0;
+}
+
+static inline uint64_t search_pool_solved(const struct search_pool *pool) {
+    return atomic_load_explicit(&pool->solved, memory_order_relaxed);
+}
+
+// Marks target solved (lock held). Returns 1 if it was the last one.
+static int search_pool_settle(struct search_pool *pool, int target) {
+    uint64_t solved = atomic_fetch_or(&pool->solved, 1ULL << target) | (1ULL << target);
+    return solved == pool->all;
+}
+
+// A worker found the key of these targets
+static void search_pool_report(struct search_pool *pool, uint64_t targets, const uint64_t *counters) {
+    int last = 0;
+    pthread_mutex_lock(&pool->lock);
+    for (int t = 0; t < pool->targets; t++) {
+        if (((targets >> t) & 1) && !((search_pool_solved(pool) >> t) & 1)) {
+            pool->hit = 1;
+            pool->own |= 1ULL << t;
+            pool->found[t] = counters[t];
+            last = search_pool_settle(pool, t);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    if (last) {
+        search_pool_stop(pool);
+    }
+}
+
+// Another process solved target; the workers stop testing it, and stop
+// altogether once no target is left
+static void search_pool_retire(struct search_pool *pool, int target) {
+    pthread_mutex_lock(&pool->lock);
+    int last = search_pool_settle(pool, target);
+    pthread_mutex_unlock(&pool->lock);
+    if (last) {
+        search_pool_stop(pool);
+    }
+}
+
+// Targets solved by the workers so far; copies their keys into found
+static uint64_t search_pool_own(struct search_pool *pool, uint64_t found[SEARCH_TARGETS_MAX]) {
+    pthread_mutex_lock(&pool->lock);
+    uint64_t own = pool->own;
+    memcpy(found, pool->found, sizeof(pool->found));
+    pthread_mutex_unlock(&pool->lock);
+    return own;
+}
+
+// Reports the targets in hits, all solved by the key with this counter.
+// Returns 1 if no target is left.
+static int search_pool_hit(struct search_pool *pool, uint64_t hits, uint64_t counter) {
+    uint64_t counters[SEARCH_TARGETS_MAX];
+    for (int t = 0; t < pool->targets; t++) {
+        counters[t] = counter;
+    }
+    search_pool_report(pool, hits, counters);
+    return search_pool_stopped(pool);
+}
+
+// Tests the lines of the wordlist that start in [lo, hi], front to back
+// whatever the direction of the chunk. Returns 1 once a hit solved the last
+// target.
+static int search_pool_dict_chunk(struct search_worker *w, uint64_t lo, uint64_t hi) {
+    struct search_pool *pool = w->pool;
+    const struct search_dict *dict = pool->dict;
+    int bitslice = pool->backend == SEARCH_BACKEND_BITSLICE;
+    int room = bitslice ? des_bs_lanes() : dict->derivations;
+    uint64_t p = search_dict_line_start(dict, lo);
+    while (p <= hi && p < dict->size) {
+        // A batch of keys from whole lines
+        int count = 0;
+        while (p <= hi && p < dict->size && count + dict->derivations <= room) {
+            size_t length = search_dict_line_length(dict, p);
+            count += search_dict_keys(dict, dict->data + p, length, &w->ctx.keys[count]);
+            p = search_dict_line_start(dict, p + length + 1);
+        }
+        if (count == 0) {
+            continue;
+        }
+        if (search_pool_stopped(pool)) {
+            return 0;
+        }
+        search_worker_tested(w, (uint64_t)count);
+        if (bitslice) {
+            uint64_t hits = search_context_check_keys(&w->ctx, count, search_pool_solved(pool));
+            if (hits) {
+                uint64_t counters[SEARCH_TARGETS_MAX];
+                for (int t = 0; t < pool->targets; t++) {
+                    counters[t] = keyspace_key_to_counter(&w->ctx.keys[w->ctx.hit_lanes[t]]);
+                }
+                search_pool_report(pool, hits, counters);
+                if (search_pool_stopped(pool)) {
+                    return 1;
+                }
+            }
+        } else {
+            for (int k = 0; k < count; k++) {
+                uint64_t hits = search_context_try_cblock(&w->ctx, &w->ctx.keys[k], search_pool_solved(pool));
+                if (hits && search_pool_hit(pool, hits, keyspace_key_to_counter(&w->ctx.keys[k]))) {
+                    return 1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+// Searches positions a..b (in that direction). Returns 1 once a hit solved
+// the last target.
+static int search_pool_chunk(struct search_worker *w, uint64_t a, uint64_t b) {
+    struct search_pool *pool = w->pool;
+    int down = a > b;
+    uint64_t lo = down ? b : a;
+    uint64_t hi = down ? a : b;
+    uint64_t n = hi - lo + 1;
+
+    if (pool->dict != NULL) {
+        return search_pool_dict_chunk(w, lo, hi);
+    }
+
+    if (pool->backend == SEARCH_BACKEND_BITSLICE) {
+        uint64_t lanes = (uint64_t)des_bs_lanes();
+        for (uint64_t done = 0; done < n; ) {
+            if (search_pool_stopped(pool)) {
+                return 0;
+            }
+            int count = (int)(n - done < lanes ? n - done : lanes);
+            uint64_t base = down ? hi - done - (count - 1) : lo + done;
+            uint64_t hits = search_context_try_keys(&w->ctx, pool->order, pool->map, base, count,
+                                                    search_pool_solved(pool));
+            search_worker_tested(w, (uint64_t)count);
+            if (hits) {
+                uint64_t counters[SEARCH_TARGETS_MAX];
+                for (int t = 0; t < pool->targets; t++) {
+                    counters[t] = keyspace_search_counter(pool->order, pool->map, base + w->ctx.hit_lanes[t]);
+                }
+                search_pool_report(pool, hits, counters);
+                if (search_pool_stopped(pool)) {
+                    return 1;
+                }
+            }
+            done += count;
+        }
+        return 0;
+    }
+
+    if (pool->order == KEYSPACE_ORDER_GRAY) {
+        // One schedule per chunk, updated with a single XOR per key
+        struct des_gray_walk walk;
+        des_gray_walk_init(&walk, a, b, pool->map != NULL ? pool->map->mask : NULL);
+        while (des_gray_walk_next(&walk)) {
+            if (search_pool_stopped(pool)) {
+                return 0;
+            }
+            search_worker_tested(w, 1);
+            uint64_t hits = search_context_try_schedule(&w->ctx, &walk.schedule, search_pool_solved(pool));
+            if (hits && search_pool_hit(pool, hits, walk.counter)) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    for (uint64_t k = 0; k < n; k++) {
+        uint64_t i = down ? hi - k : lo + k;
+        if (search_pool_stopped(pool)) {
+            return 0;
+        }
+        search_worker_tested(w, 1);
+        uint64_t counter = keyspace_search_counter(pool->order, pool->map, i);
+        uint64_t hits = search_context_try_key(&w->ctx, counter, search_pool_solved(pool));
+        if (hits && search_pool_hit(pool, hits, counter)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void *search_pool_worker(void *arg) {
+    struct search_worker *w = (struct search_worker *)arg;
+    struct search_pool *pool = w->pool;
+
+    uint64_t a, b;
+    while (search_pool_take(pool, &a, &b)) {
+        uint64_t start = des_check_now_ns();
+        int hit = search_pool_chunk(w, a, b);
+        w->busy_ns += des_check_now_ns() - start;
+        if (hit) {
+            break;
+        }
+        if (pool->tracking && !search_pool_stopped(pool)) {
+            pthread_mutex_lock(&pool->lock);
+            search_coverage_add(&pool->done, a < b ? a : b, a < b ? b : a);
+            pthread_mutex_unlock(&pool->lock);
+        }
+    }
+
+    atomic_fetch_sub(&pool->active, 1);
+    return NULL;
+}
+
+// Undoes a search_pool_start() that failed with the first started workers
+// running and the contexts of the first ready ones allocated
+static void search_pool_unwind(struct search_pool *pool, int started, int ready) {
+    search_pool_stop(pool);
+    for (int t = 0; t < started; t++) {
+        pthread_join(pool->workers[t].thread, NULL);
+    }
+    for (int t = 0; t < ready; t++) {
+        search_context_free(&pool->workers[t].ctx);
+    }
+    free(pool->workers);
+    pool->workers = NULL;
+    search_coverage_free(&pool->done);
+    pthread_cond_destroy(&pool->more);
+    pthread_mutex_destroy(&pool->lock);
+}
+
+// Starts threads workers searching for targets (1 to SEARCH_TARGETS_MAX)
+// checks on an empty, open queue. Returns -1 (after printing why) if they
+// cannot be started, with the workers already started joined and
+// everything freed.
+static int search_pool_start(struct search_pool *pool, const struct des_check *checks, int targets,
+                             enum search_backend backend, enum keyspace_order order, int threads) {
+    pool->checks = checks;
+    pool->targets = targets;
+    pool->all = targets == 64 ? ~0ULL : (1ULL << targets) - 1;
+    atomic_init(&pool->solved, 0);
+    pool->backend = backend;
+    pool->order = order;
+    pool->map = NULL;
+    pool->dict = NULL;
+    atomic_init(&pool->stop, 0);
+    atomic_init(&pool->active, threads);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->more, NULL);
+    pool->head = 0;
+    pool->queued = 0;
+    pool->taken = 0;
+    pool->handed = 0;
+    pool->closed = 0;
+    pool->hit = 0;
+    pool->own = 0;
+    memset(pool->found, 0, sizeof(pool->found));
+    pool->skip = NULL;
+    pool->skipped = 0;
+    pool->tracking = 0;
+    search_coverage_init(&pool->done);
+    pool->threads = threads;
+    // sizeof(struct search_worker) is a multiple of its alignment
+    pool->workers = aligned_alloc(SEARCH_POOL_LINE, (size_t)threads * sizeof(struct search_worker));
+    if (pool->workers == NULL) {
+        printf("Error: Failed to allocate the worker threads.\n");
+        search_pool_unwind(pool, 0, 0);
+        return -1;
+    }
+    memset(pool->workers, 0, (size_t)threads * sizeof(struct search_worker));
+
+    for (int t = 0; t < threads; t++) {
+        struct search_worker *w = &pool->workers[t];
+        w->pool = pool;
+        if (search_context_init(&w->ctx, checks, targets, backend) != 0) {
+            search_pool_unwind(pool, t, t);
+            return -1;
+        }
+        if (pthread_create(&w->thread, NULL, search_pool_worker, w) != 0) {
+            printf("Error: Failed to start worker thread %d.\n", t);
+            search_pool_unwind(pool, t, t + 1);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Records completed chunks from now on and never hands out the positions in
+// skip (if not NULL), which must outlive the pool. Call before feeding.
+static void search_pool_track(struct search_pool *pool, const struct search_coverage *skip) {
+    pthread_mutex_lock(&pool->lock);
+    pool->skip = skip;
+    pool->tracking = 1;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// Records completed chunks from now on, keeping the skip set of
+// search_pool_track() if any
+static void search_pool_record(struct search_pool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->tracking = 1;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// Makes the workers test the counter map sends each position to, if it
+// changes any (a shuffling traversal or a key mask); map must outlive the
+// pool. Call before feeding.
+static void search_pool_map(struct search_pool *pool, const struct keyspace_map *map) {
+    pthread_mutex_lock(&pool->lock);
+    pool->map = keyspace_map_active(map) ? map : NULL;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// Makes the positions byte offsets of dict, whose lines the workers try
+// instead of counters; dict must outlive the pool. Call before feeding.
+static inline void search_pool_dict(struct search_pool *pool, const struct search_dict *dict) {
+    pthread_mutex_lock(&pool->lock);
+    pool->dict = dict;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// Copies the completed chunks into out (which must be initialized). Returns
+// -1 if out cannot grow.
+static int search_pool_done(struct search_pool *pool, struct search_coverage *out) {
+    pthread_mutex_lock(&pool->lock);
+    int status = search_coverage_merge(out, &pool->done);
+    pthread_mutex_unlock(&pool->lock);
+    return status;
+}
+
+// Returns 1 if every position of lo..hi (lo <= hi) was completed by the
+// workers or is in the skip set. Needs search_pool_track() or
+// search_pool_record().
+static int search_pool_covered(struct search_pool *pool, uint64_t lo, uint64_t hi) {
+    pthread_mutex_lock(&pool->lock);
+    int complete = 1;
+    uint64_t pos = lo;
+    while (complete) {
+        int covered;
+        uint64_t run = search_coverage_run(&pool->done, pos, 0, &covered);
+        if (!covered && pool->skip != NULL) {
+            run = search_coverage_run(pool->skip, pos, 0, &covered);
+        }
+        if (!covered) {
+            complete = 0;
+        } else if (run > hi - pos) {
+            break;
+        } else {
+            pos += run;
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return complete;
+}
+
+// Returns 0 once every worker has returned
+static inline int search_pool_running(struct search_pool *pool) {
+    return atomic_load(&pool->active) > 0;
+}
+
+// Short sleep for the thread polling MPI while the workers search
+static inline void search_pool_nap(void) {
+    struct timespec nap = {0, SEARCH_POOL_NAP_NS};
+    nanosleep(&nap, NULL);
+}
+
+// Adds up the counters of the workers. Call once search_pool_running()
+// returned 0 and before search_pool_join().
+static void search_pool_counters(struct search_pool *pool, struct search_pool_counters *out) {
+    out->tested = 0;
+    out->busy_ns = 0;
+    out->check.candidates = 0;
+    out->check.check_ns = 0;
+    for (int t = 0; t < pool->threads; t++) {
+        const struct search_worker *w = &pool->workers[t];
+        out->tested += atomic_load_explicit(&w->tested, memory_order_relaxed);
+        out->busy_ns += w->busy_ns;
+        out->check.candidates += w->ctx.stats.candidates;
+        out->check.check_ns += w->ctx.stats.check_ns;
+    }
+}
+
+// Joins the workers and frees their contexts. Returns 1 if they found a key
+// (the counters are in pool->found, for the targets in pool->own).
+static int search_pool_join(struct search_pool *pool) {
+    for (int t = 0; t < pool->threads; t++) {
+        pthread_join(pool->workers[t].thread, NULL);
+        search_context_free(&pool->workers[t].ctx);
+    }
+    free(pool->workers);
+    pool->workers = NULL;
+    search_coverage_free(&pool->done);
+    pthread_cond_destroy(&pool->more);
+    pthread_mutex_destroy(&pool->lock);
+    return pool->hit;
+}
+
+#endif
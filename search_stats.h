@@ -0,0 +1,153 @@
+#ifndef SEARCH_STATS_H
+#define SEARCH_STATS_H
+
+// Per-process counters of the search, gathered on rank 0 and printed at the
+// end of a run as a table and as one line of JSON.
+//
+// - keys: keys tested by the workers of the process
+// - seconds: search start to loop exit; keys_per_second is keys / seconds
+// - crypto_seconds: worker time inside chunks minus check_seconds (key
+//   setup and decryption, plus the little bookkeeping between keys)
+// - check_seconds: worker time verifying candidates, or scanning the whole
+//   text when the keywords have no cheaper first compare (des_check.h)
+// - candidates: keys that passed the first block or window compare; with a
+//   whole-text scan, texts that passed the printable filter or matched
+// - mpi_seconds: time the polling thread was awake: MPI progress calls,
+//   serving dynamic chunks and writing checkpoints
+// - stop_seconds: from the moment the process learned the outcome to its
+//   loop exit
+// - wait_seconds: loop exit to leaving the barrier after the search
+//   (joining the workers, the last checkpoint and waiting for the others)
+//
+// Worker times are summed over the threads, so with --threads=T crypto and
+// check seconds add up to at most T times the search time.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <mpi.h>
+
+#include "search_pool.h"
+#include "search_stop.h"
+
+enum search_stat {
+    SEARCH_STAT_KEYS,
+    SEARCH_STAT_SECONDS,
+    SEARCH_STAT_CRYPTO,
+    SEARCH_STAT_CHECK,
+    SEARCH_STAT_CANDIDATES,
+    SEARCH_STAT_MPI,
+    SEARCH_STAT_STOP,
+    SEARCH_STAT_WAIT,
+    SEARCH_STAT_COUNT
+};
+
+static const char *const search_stat_names[SEARCH_STAT_COUNT] = {
+    "keys", "seconds", "crypto_seconds", "check_seconds", "candidates", "mpi_seconds", "stop_seconds",
+    "wait_seconds",
+};
+
+struct search_stats {
+    double values[SEARCH_STAT_COUNT];
+    double exit_at;               // MPI_Wtime() of the loop exit
+};
+
+// Reads the counters of the pool and the polling loop. Call right after the
+// loop, before joining the pool.
+static void search_stats_collect(struct search_stats *stats, struct search_pool *pool,
+                                 const struct search_stop *stop, double start_time) {
+    struct search_pool_counters counters;
+    search_pool_counters(pool, &counters);
+    stats->exit_at = MPI_Wtime();
+
+    double *v = stats->values;
+    double busy = counters.busy_ns / 1e9;
+    v[SEARCH_STAT_KEYS] = (double)counters.tested;
+    v[SEARCH_STAT_SECONDS] = stats->exit_at - start_time;
+    v[SEARCH_STAT_CHECK] = counters.check.check_ns / 1e9;
+    v[SEARCH_STAT_CRYPTO] = busy > v[SEARCH_STAT_CHECK] ? busy - v[SEARCH_STAT_CHECK] : 0;
+    v[SEARCH_STAT_CANDIDATES] = (double)counters.check.candidates;
+    v[SEARCH_STAT_MPI] = v[SEARCH_STAT_SECONDS] > stop->napped ? v[SEARCH_STAT_SECONDS] - stop->napped : 0;
+    v[SEARCH_STAT_STOP] = stop->decided ? stats->exit_at - stop->decided_at : 0;
+    v[SEARCH_STAT_WAIT] = 0;
+}
+
+// The barrier after the search, timed
+static void search_stats_barrier(struct search_stats *stats, MPI_Comm comm) {
+    MPI_Barrier(comm);
+    stats->values[SEARCH_STAT_WAIT] = MPI_Wtime() - stats->exit_at;
+}
+
+static inline double search_stats_rate(const double *v) {
+    return v[SEARCH_STAT_SECONDS] > 0 ? v[SEARCH_STAT_KEYS] / v[SEARCH_STAT_SECONDS] : 0;
+}
+
+static void search_stats_row(const char *label, const double *v) {
+    printf("%-6s %14.0f %12.0f %10.4f %10.4f %10.0f %10.4f %10.4f %10.4f\n", label, v[SEARCH_STAT_KEYS],
+           search_stats_rate(v), v[SEARCH_STAT_CRYPTO], v[SEARCH_STAT_CHECK], v[SEARCH_STAT_CANDIDATES],
+           v[SEARCH_STAT_MPI], v[SEARCH_STAT_STOP], v[SEARCH_STAT_WAIT]);
+}
+
+// One JSON object; rank < 0 leaves out the rank (the total)
+static void search_stats_json(int rank, const double *v) {
+    printf("{");
+    if (rank >= 0) {
+        printf("\"rank\":%d,", rank);
+    }
+    for (int f = 0; f < SEARCH_STAT_COUNT; f++) {
+        printf("\"%s\":%.9g,", search_stat_names[f], v[f]);
+    }
+    printf("\"keys_per_second\":%.9g}", search_stats_rate(v));
+}
+
+// Collective. Rank 0 gathers the counters of every process and prints them,
+// with a total row: sums, except the slowest seconds, stop and wait.
+static void search_stats_report(const struct search_stats *stats, MPI_Comm comm) {
+    int id, size;
+    MPI_Comm_rank(comm, &id);
+    MPI_Comm_size(comm, &size);
+    double *all = NULL;
+    if (id == 0) {
+        all = malloc((size_t)size * SEARCH_STAT_COUNT * sizeof(double));
+        if (all == NULL) {
+            printf("Error: Failed to allocate the statistics.\n");
+            MPI_Abort(comm, EXIT_FAILURE);
+        }
+    }
+    MPI_Gather(stats->values, SEARCH_STAT_COUNT, MPI_DOUBLE, all, SEARCH_STAT_COUNT, MPI_DOUBLE, 0, comm);
+    if (id != 0) {
+        return;
+    }
+
+    double total[SEARCH_STAT_COUNT] = {0};
+    for (int r = 0; r < size; r++) {
+        const double *v = all + (size_t)r * SEARCH_STAT_COUNT;
+        for (int f = 0; f < SEARCH_STAT_COUNT; f++) {
+            int slowest = f == SEARCH_STAT_SECONDS || f == SEARCH_STAT_STOP || f == SEARCH_STAT_WAIT;
+            total[f] = slowest ? (v[f] > total[f] ? v[f] : total[f]) : total[f] + v[f];
+        }
+    }
+
+    printf("\n%-6s %14s %12s %10s %10s %10s %10s %10s %10s\n", "rank", "keys", "keys/s", "crypto_s", "check_s",
+           "candidates", "mpi_s", "stop_s", "wait_s");
+    for (int r = 0; r < size; r++) {
+        char label[16];
+        snprintf(label, sizeof(label), "%d", r);
+        search_stats_row(label, all + (size_t)r * SEARCH_STAT_COUNT);
+    }
+    search_stats_row("total", total);
+
+    printf("Stats: {\"ranks\":[");
+    for (int r = 0; r < size; r++) {
+        search_stats_json(r, all + (size_t)r * SEARCH_STAT_COUNT);
+        if (r + 1 < size) {
+            printf(",");
+        }
+    }
+    printf("],\"total\":");
+    search_stats_json(-1, total);
+    printf("}\n");
+    free(all);
+}
+
+#endif
@@ -0,0 +1,276 @@
+#ifndef SEARCH_STOP_H
+#define SEARCH_STOP_H
+
+// Termination of the search across MPI processes.
+//
+// A process tells rank 0 about every target its workers solve, and once
+// its workers have returned it sends rank 0 exactly one final report. Rank
+// 0 announces the outcome with an MPI_Ibcast that the other processes
+// posted up front, as soon as every target is solved, or once all
+// processes reported (the key space is exhausted). Processes the
+// distributor gave up on (search_stop_lose, --lease) are not waited for,
+// nor, once the outcome is announced, the ones still silent a lease later
+// (search_stop_overdue). A process whose broadcast completes stops its pool. Compared with the finder sending the
+// key to every process, a find costs one collective plus N - 1 reports that
+// are always received, even when two processes find a key at the same time.
+//
+// With several targets (bruteforce_partB --batch) rank 0 also forwards each
+// target solved before the end to the other processes, which retire it
+// from their pools. The announcement carries how many targets were
+// forwarded, so every forward is received before a process leaves.
+//
+// Only the thread that polls MPI calls these functions; the workers only
+// see the pool's flags between keys. That thread naps between polls,
+// longer and longer while nothing happens (up to SEARCH_STOP_NAP_MAX_NS),
+// so a long search barely wakes it, and the stop latency stays bounded by
+// the longest nap plus two messages.
+
+#include <stdint.h>
+#include <mpi.h>
+#include <time.h>
+
+#include "search_pool.h"
+
+// Outcome when no key was found
+#define SEARCH_STOP_NONE (-1L)
+
+// Tag of the messages to rank 0 (search_dist.h uses 1 to 3, 6 and 7): a target
+// solved, or the final report
+#define SEARCH_STOP_TAG_REPORT 4
+
+// Tag of the solved targets rank 0 forwards
+#define SEARCH_STOP_TAG_RETIRE 5
+
+// Target field of the final report
+#define SEARCH_STOP_FINAL (-1L)
+
+// Range of the nap between polls, in nanoseconds
+#define SEARCH_STOP_NAP_MIN_NS 1000000L
+#define SEARCH_STOP_NAP_MAX_NS 16000000L
+
+struct search_stop {
+    MPI_Comm comm;
+    int id;
+    int size;
+    int targets;
+    long key;                     // Key of the first target once decided, or SEARCH_STOP_NONE
+    long keys[SEARCH_TARGETS_MAX]; // Key of each target; complete on rank 0
+    long outcome[2];              // Broadcast buffer: key and forwarded targets
+    MPI_Request bcast;
+    int posted;                   // bcast has been started
+    int decided;                  // bcast completed
+    int finished;                 // This process's workers returned and it reported
+    uint64_t sent;                // Targets solved here that rank 0 knows about
+    long forwarded;               // Forwarded targets sent (rank 0) or received
+    long nap_ns;
+    double decided_at;            // MPI_Wtime() when bcast completed
+    double napped;                // Seconds spent in search_stop_nap
+    // Rank 0
+    int remaining;                // Targets not solved yet
+    int reported;                 // Processes that sent their final report
+    int lost;                     // Processes not waited for any more
+    const unsigned char *gone;    // Which ones (search_dist.h), NULL = none
+    int sealed;                   // Every process still missing was given up on
+    double announced_at;          // MPI_Wtime() of the announcement
+    double latency;               // Announcement to last report, in seconds
+};
+
+static void search_stop_init(struct search_stop *stop, MPI_Comm comm, const struct search_pool *pool) {
+    stop->comm = comm;
+    MPI_Comm_rank(comm, &stop->id);
+    MPI_Comm_size(comm, &stop->size);
+    stop->targets = pool->targets;
+    stop->key = SEARCH_STOP_NONE;
+    for (int t = 0; t < SEARCH_TARGETS_MAX; t++) {
+        stop->keys[t] = SEARCH_STOP_NONE;
+    }
+    stop->outcome[0] = SEARCH_STOP_NONE;
+    stop->outcome[1] = 0;
+    stop->posted = 0;
+    stop->decided = 0;
+    stop->finished = 0;
+    stop->sent = 0;
+    stop->forwarded = 0;
+    stop->nap_ns = SEARCH_STOP_NAP_MIN_NS;
+    stop->decided_at = 0;
+    stop->napped = 0;
+    // Targets the pool starts with retired were solved by an earlier pass
+    stop->remaining = pool->targets - __builtin_popcountll(search_pool_solved(pool));
+    stop->reported = 0;
+    stop->lost = 0;
+    stop->gone = NULL;
+    stop->sealed = 0;
+    stop->announced_at = 0;
+    stop->latency = 0;
+    if (stop->id != 0) {
+        MPI_Ibcast(stop->outcome, 2, MPI_LONG, 0, comm, &stop->bcast);
+        stop->posted = 1;
+    }
+}
+
+// Rank 0: announces the outcome as soon as it is known
+static void search_stop_decide(struct search_stop *stop) {
+    if (!stop->posted && (stop->remaining == 0 || stop->reported + stop->lost >= stop->size)) {
+        stop->outcome[0] = stop->keys[0];
+        stop->outcome[1] = stop->forwarded;
+        stop->announced_at = MPI_Wtime();
+        MPI_Ibcast(stop->outcome, 2, MPI_LONG, 0, stop->comm, &stop->bcast);
+        stop->posted = 1;
+    }
+    if (stop->reported + stop->lost >= stop->size) {
+        stop->latency = MPI_Wtime() - stop->announced_at;
+    }
+}
+
+// Rank 0: stops waiting for the final report of a process that stopped
+// answering; gone flags every process given up on so far, this one
+// included. A process only reports after the distributor answered it with
+// an empty chunk, which it never does for a lost one, so until the
+// announcement the reports of the others are still counted exactly. A
+// lost process that reports after all is already counted and ignored.
+static void search_stop_lose(struct search_stop *stop, const unsigned char *gone) {
+    stop->lost++;
+    stop->gone = gone;
+    search_stop_decide(stop);
+}
+
+// Rank 0: once its own workers returned, gives up on every process whose
+// final report has not arrived wait seconds after the announcement, so one
+// that hangs after the outcome is known does not hold the others back.
+// Reports arriving after that are ignored. Returns how many were given up on.
+static int search_stop_overdue(struct search_stop *stop, double wait) {
+    if (!stop->posted || !stop->finished || stop->reported + stop->lost >= stop->size
+        || MPI_Wtime() < stop->announced_at + wait) {
+        return 0;
+    }
+    int missing = stop->size - stop->reported - stop->lost;
+    stop->lost += missing;
+    stop->sealed = 1;
+    search_stop_decide(stop);
+    return missing;
+}
+
+// Rank 0: records the key of a target and, while other targets are left,
+// forwards it to the other processes
+static void search_stop_solved(struct search_stop *stop, struct search_pool *pool, int target, long key) {
+    if (stop->keys[target] != SEARCH_STOP_NONE) {
+        return;
+    }
+    stop->keys[target] = key;
+    stop->remaining--;
+    search_pool_retire(pool, target);
+    if (stop->remaining > 0 && !stop->posted) {
+        long msg[2] = {target, key};
+        for (int rank = 1; rank < stop->size; rank++) {
+            MPI_Send(msg, 2, MPI_LONG, rank, SEARCH_STOP_TAG_RETIRE, stop->comm);
+        }
+        stop->forwarded++;
+    }
+    search_stop_decide(stop);
+}
+
+// Other ranks: takes one forwarded target
+static void search_stop_retire(struct search_stop *stop, struct search_pool *pool) {
+    long msg[2];
+    MPI_Recv(msg, 2, MPI_LONG, 0, SEARCH_STOP_TAG_RETIRE, stop->comm, MPI_STATUS_IGNORE);
+    stop->keys[msg[0]] = msg[1];
+    stop->forwarded++;
+    search_pool_retire(pool, (int)msg[0]);
+}
+
+// Called regularly by the thread that polls MPI while the pool searches.
+// Returns 0 once the outcome is known, this process's workers have returned
+// and, on rank 0, every process has reported.
+static int search_stop_poll(struct search_stop *stop, struct search_pool *pool) {
+    int busy = 0;
+
+    // Checked first, so every target solved before the workers returned is
+    // sent before the final report
+    int returned = !stop->finished && !search_pool_running(pool);
+
+    uint64_t found[SEARCH_TARGETS_MAX];
+    uint64_t fresh = search_pool_own(pool, found) & ~stop->sent;
+    for (int t = 0; fresh != 0 && t < stop->targets; t++) {
+        if (!((fresh >> t) & 1)) {
+            continue;
+        }
+        stop->sent |= 1ULL << t;
+        busy = 1;
+        if (stop->id == 0) {
+            search_stop_solved(stop, pool, t, (long)found[t]);
+        } else {
+            long msg[2] = {t, (long)found[t]};
+            stop->keys[t] = msg[1];
+            MPI_Send(msg, 2, MPI_LONG, 0, SEARCH_STOP_TAG_REPORT, stop->comm);
+        }
+    }
+
+    if (returned) {
+        stop->finished = 1;
+        busy = 1;
+        if (stop->id == 0) {
+            stop->reported++;
+            search_stop_decide(stop);
+        } else {
+            long msg[2] = {SEARCH_STOP_FINAL, 0};
+            MPI_Send(msg, 2, MPI_LONG, 0, SEARCH_STOP_TAG_REPORT, stop->comm);
+        }
+    }
+
+    int pending;
+    MPI_Status st;
+    if (stop->id == 0) {
+        MPI_Iprobe(MPI_ANY_SOURCE, SEARCH_STOP_TAG_REPORT, stop->comm, &pending, &st);
+        while (pending) {
+            long msg[2];
+            MPI_Recv(msg, 2, MPI_LONG, st.MPI_SOURCE, SEARCH_STOP_TAG_REPORT, stop->comm, MPI_STATUS_IGNORE);
+            if (msg[0] == SEARCH_STOP_FINAL && !stop->sealed && (stop->gone == NULL || !stop->gone[st.MPI_SOURCE])) {
+                stop->reported++;
+                search_stop_decide(stop);
+            } else if (msg[0] != SEARCH_STOP_FINAL) {
+                search_stop_solved(stop, pool, (int)msg[0], msg[1]);
+            }
+            busy = 1;
+            MPI_Iprobe(MPI_ANY_SOURCE, SEARCH_STOP_TAG_REPORT, stop->comm, &pending, &st);
+        }
+    } else if (stop->targets > 1) {
+        MPI_Iprobe(0, SEARCH_STOP_TAG_RETIRE, stop->comm, &pending, &st);
+        while (pending) {
+            search_stop_retire(stop, pool);
+            busy = 1;
+            MPI_Iprobe(0, SEARCH_STOP_TAG_RETIRE, stop->comm, &pending, &st);
+        }
+    }
+
+    if (stop->posted && !stop->decided) {
+        int flag;
+        MPI_Test(&stop->bcast, &flag, MPI_STATUS_IGNORE);
+        if (flag) {
+            stop->decided = 1;
+            stop->decided_at = MPI_Wtime();
+            stop->key = stop->outcome[0];
+            busy = 1;
+            search_pool_stop(pool);
+            // Forwards sent before the announcement that are still queued
+            while (stop->id != 0 && stop->forwarded < stop->outcome[1]) {
+                search_stop_retire(stop, pool);
+            }
+        }
+    }
+
+    if (busy) {
+        stop->nap_ns = SEARCH_STOP_NAP_MIN_NS;
+    } else if (stop->nap_ns < SEARCH_STOP_NAP_MAX_NS) {
+        stop->nap_ns *= 2;
+    }
+    return !(stop->decided && stop->finished && (stop->id != 0 || stop->reported + stop->lost >= stop->size));
+}
+
+static inline void search_stop_nap(struct search_stop *stop) {
+    struct timespec nap = {0, stop->nap_ns};
+    double start = MPI_Wtime();
+    nanosleep(&nap, NULL);
+    stop->napped += MPI_Wtime() - start;
+}
+
+#endif
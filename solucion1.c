@@ -4,6 +4,23 @@
 #include <mpi.h>
 #include <openssl/des.h>
 
+#include "des_bitslice.h"
+#include "des_check.h"
+#include "keyspace.h"
+#include "search_checkpoint.h"
+#include "search_context.h"
+#include "search_dist.h"
+#include "search_file.h"
+#include "search_pool.h"
+#include "search_stats.h"
+#include "search_stop.h"
+#include "search_options.h"
+
+// Flags this program accepts (search_options.h)
+#define PROGRAM_OPTIONS (SEARCH_OPT_BACKEND | SEARCH_OPT_ORDER | SEARCH_OPT_TRAVERSAL | SEARCH_OPT_OFFSET \
+                         | SEARCH_OPT_THREADS | SEARCH_OPT_DISTRIBUTION | SEARCH_OPT_RANGE \
+                         | SEARCH_OPT_CHECKPOINT | SEARCH_OPT_KEYWORDS)
+
 // DES key size
 #define DES_KEY_SIZE 8
 
@@ -40,83 +57,30 @@ void print_key(const uint8_t *key, int size) {
 }
 
 void long_to_des_key(unsigned long long key, DES_cblock *des_key) {
-    // We have to split the key into bytes and copy it into the DES_cblock (8 bytes).
-    for (int i = 0; i < 7; ++i) {
-        (*des_key)[7 - i] = (unsigned char)((key >> (i * 8)) & 0xFF);  // Big-endian byte order
-    }
-    (*des_key)[0] = 0x00;  // Ensure that the highest byte is zero for 56-bit key
-}
-
-// Try a key and check if it decrypts correctly
-int tryKey(long key, const uint8_t *ciphertext, int len, const char *keyword, const DES_cblock *iv, int id) {
-    uint8_t *decrypted = malloc(len); 
-    memset(decrypted, 0, len);
-
-    DES_cblock des_key;
-    // memcpy(&des_key, &key, sizeof(DES_cblock));
-    long_to_des_key(key, &des_key);
-    // printf("Process %d using key: %lln\n", id, key);
-    // print_key(&key, DES_KEY_SIZE);
-
-    decrypt_with_key(ciphertext, decrypted, &des_key, iv,len);
-
-    // Check if the decrypted text matches the correct plaintext
-    return strstr(decrypted, keyword) != NULL;
-}
-
-
-
-// Function to read the entire plaintext from a file
-uint8_t* read_plaintext_from_file(const char *filename, size_t *length) {
-    FILE *file = fopen(filename, "rb");
-    if (file == NULL) {
-        perror("Failed to open file");
-        return NULL;
-    }
-
-    // Get the file size
-    fseek(file, 0, SEEK_END);
-    long file_size = ftell(file);
-    rewind(file);
-
-    if (file_size <= 0) {
-        printf("Error: File is empty or has invalid size.\n");
-        fclose(file);
-        return NULL;
-    }
-
-    // Allocate memory for the file contents
-    uint8_t *buffer = (uint8_t *)malloc(file_size);
-    if (buffer == NULL) {
-        printf("Error: Failed to allocate memory.\n");
-        fclose(file);
-        return NULL;
-    }
-
-    // Read the entire file into the buffer
-    size_t bytes_read = fread(buffer, 1, file_size, file);
-    if (bytes_read != file_size) {
-        printf("Error: Failed to read entire file.\n");
-        free(buffer);
-        fclose(file);
-        return NULL;
-    }
-
-    *length = file_size;  // Set the length of the plaintext
-    fclose(file);
-    return buffer;
+    // Spread the 56 key bits over the 7 used bits of each byte, skipping the
+    // parity bits DES ignores (see keyspace.h)
+    keyspace_counter_to_key(key, des_key);
 }
 
 
 int main(int argc, char *argv[]) {
-    if (argc != 4) {
-        printf("Usage: %s <plaintext_file> <keyword> <private_key>\n", argv[0]);
+    struct search_options opts;
+    if (parse_search_options(&argc, argv, PROGRAM_OPTIONS, &opts) != 0 || argc != 4) {
+        printf("Usage: %s [options] <plaintext_file> <keyword> <private_key>\n", argv[0]);
+        print_search_options(PROGRAM_OPTIONS);
+        return 1;
+    }
+    des_gray_init();
+    if (des_bs_init(opts.simd) != 0) {
         return 1;
     }
 
     const char *plaintext_file = argv[1];
     const char *keyword = argv[2];
-    unsigned long long private_key = strtoull(argv[3], NULL, 10);
+    unsigned long long private_key;
+    if (parse_search_key(argv[3], &private_key) != 0) {
+        return 1;
+    }
 
 
     size_t plaintext_length;
@@ -126,21 +90,36 @@ int main(int argc, char *argv[]) {
     }
 
     int N, id;
-    unsigned long long upper = (1ULL << 56);  
+    unsigned long long upper = KEYSPACE_SIZE;  
     unsigned long long mylower, myupper;
     long found = 0;  
     double start_time, end_time;  
-    MPI_Status st;
-    MPI_Request req;
-    int flag = 0;
     MPI_Comm comm = MPI_COMM_WORLD;
 
-    MPI_Init(&argc, &argv);
+    // Only this thread calls MPI; the search threads never do
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    if (provided < MPI_THREAD_FUNNELED) {
+        // The workers run beside the thread that calls MPI
+        fprintf(stderr, "Error: MPI provides thread level %d, below MPI_THREAD_FUNNELED.\n", provided);
+        MPI_Abort(comm, EXIT_FAILURE);
+    }
     MPI_Comm_size(comm, &N);
     MPI_Comm_rank(comm, &id);
 
+    if (opts.end - opts.start < (unsigned long long)N) {
+        if (id == 0) {
+            printf("Error: the key range holds fewer keys than there are processes\n");
+        }
+        free(plaintext);
+        MPI_Finalize();
+        return 1;
+    }
 
-    uint8_t *ciphertext = (uint8_t *)malloc(plaintext_length);
+
+    // DES_cbc_encrypt writes whole blocks, so round the buffer up
+    size_t padded_length = (plaintext_length + DES_KEY_SIZE - 1) / DES_KEY_SIZE * DES_KEY_SIZE;
+    uint8_t *ciphertext = (uint8_t *)calloc(padded_length, 1);
     DES_cblock iv = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};  // IV initialization
     
     DES_cblock generated_key;
@@ -172,64 +151,101 @@ int main(int argc, char *argv[]) {
     MPI_Barrier(comm);
 
     // Broadcast the ciphertext to all processes
-    MPI_Bcast(ciphertext, plaintext_length, MPI_UNSIGNED_CHAR, 0, comm);
+    MPI_Bcast(ciphertext, padded_length, MPI_UNSIGNED_CHAR, 0, comm);
+
+    const char *keywords[SEARCH_MAX_KEYWORDS];
+    int keyword_count = search_keywords(&opts, keyword, keywords);
+    struct des_check check;
+    if (des_check_init(&check, ciphertext, plaintext_length, &iv, keywords, keyword_count, opts.match,
+                       opts.offset) != 0) {
+        free(ciphertext);
+        free(plaintext);
+        MPI_Finalize();
+        return 1;
+    }
 
-    unsigned long long range_per_node = upper / N;  // Divide the key space by all N workers
-    mylower = range_per_node * id;  // Start range for this process
-    myupper = (id == N - 1) ? upper : range_per_node * (id + 1) - 1;  // Last process gets the remaining keys
+    upper = opts.end;  // --start, --end and --key-bits narrow the search
 
-    printf("Process %d: Searching keys from %llx to %llx\n", id, mylower, myupper);
+    int lanes_per_pass = des_bs_lanes();
+    if (opts.backend == SEARCH_BACKEND_BITSLICE && id == 0) {
+        printf("Bitslice kernel: %s (%d keys per pass)\n", des_bs_kernel_name(), lanes_per_pass);
+    }
+    if (opts.masked && id == 0) {
+        printf("Key pattern: %d unknown bits\n", opts.key_bits);
+    }
 
-    start_time = MPI_Wtime();
+    // Unless --traversal says otherwise, even processes walk their keys
+    // upwards and odd ones downwards
+    enum keyspace_traversal traversal = search_traversal(&opts, KEYSPACE_TRAVERSAL_BIDIRECTIONAL);
+    int down = keyspace_traversal_down(traversal, id);
+    struct keyspace_map map;
+    struct keyspace_mask mask;
+    keyspace_map_init(&map, traversal, opts.start, opts.end, N, opts.seed, search_key_mask(&opts, &mask));
+
+    // Keys already searched by an interrupted run are skipped with --resume
+    struct search_checkpoint ckpt;
+    if (search_checkpoint_init(&ckpt, comm, &opts, &check, &map) != 0) {
+        free(ciphertext);
+        free(plaintext);
+        MPI_Finalize();
+        return 1;
+    }
 
-    MPI_Irecv(&found, 1, MPI_LONG, MPI_ANY_SOURCE, MPI_ANY_TAG, comm, &req);
-
-    if (id % 2 == 0){
-        for (unsigned long long i = mylower; i <= myupper; ++i) {
-            // Periodically check if a key has been found
-            MPI_Test(&req, &flag, &st);
-            if (flag) {
-                // Key found by another process, stop searching
-                break;
-            }
-            if (tryKey(i, ciphertext, plaintext_length, keyword, &iv, id)) {
-                found = i;
-                printf("Key found by process %d\n", id);
-                // Broadcast the found key to all other processes
-                for (int node = 0; node < N; node++) {
-                    MPI_Send(&found, 1, MPI_LONG, node, 0, MPI_COMM_WORLD);
-                }
-                break;
-            }
-        }
+    // --distribution=weighted times every process first and splits the
+    // range by speed
+    struct search_dist_weights weights;
+    if (search_dist_calibrate(&weights, comm, &opts, &check, 1, &map, opts.start, upper) != 0) {
+        MPI_Abort(comm, EXIT_FAILURE);
+    }
+    search_dist_share(&weights, id, N, opts.start, upper, &mylower, &myupper);
+
+    if (opts.distribution == SEARCH_DIST_DYNAMIC) {
+        printf("Process %d: Taking chunks of %llu keys on demand with %d threads\n", id, opts.chunk, opts.threads);
     } else {
-        for (unsigned long long i = myupper; i >= mylower; --i) {
-            // Periodically check if a key has been found
-            MPI_Test(&req, &flag, &st);
-            if (flag) {
-                // Key found by another process, stop searching
-                break;
-            }
-            if (tryKey(i, ciphertext, plaintext_length, keyword, &iv, id)) {
-                found = i;
-                printf("Key found by process %d\n", id);
-                // Broadcast the found key to all other processes
-                for (int node = 0; node < N; node++) {
-                    MPI_Send(&found, 1, MPI_LONG, node, 0, MPI_COMM_WORLD);
-                }
-                break;
-            }
-        }
+        printf("Process %d: Searching keys from %llx to %llx with %d threads\n", id, mylower, myupper, opts.threads);
     }
-    
-    MPI_Test(&req, &flag, &st);
-    // if (flag) {
-    //     printf("Process %d received notification to stop.\n", id);
-    // }
 
-    MPI_Barrier(comm);
+    start_time = MPI_Wtime();
 
-    if (id == 0) {
+    // Worker threads search the keys handed to this process while this
+    // thread polls MPI for a stop from another process and for new chunks
+    struct search_pool pool;
+    if (search_pool_start(&pool, &check, 1, opts.backend, opts.order, opts.threads) != 0) {
+        MPI_Abort(comm, EXIT_FAILURE);
+    }
+    search_checkpoint_attach(&ckpt, &pool);
+    search_pool_map(&pool, &map);
+    struct search_dist dist;
+    search_dist_init(&dist, &pool, comm, opts.distribution, opts.chunk, opts.lease, down, opts.start, opts.end,
+                     mylower, myupper, &weights);
+    struct search_stop stop;
+    search_stop_init(&stop, comm, &pool);
+    while (search_stop_poll(&stop, &pool)) {
+        search_dist_progress(&dist, &pool, &stop);
+        search_checkpoint_tick(&ckpt, &pool);
+        search_stop_nap(&stop);
+    }
+    struct search_stats stats;
+    search_stats_collect(&stats, &pool, &stop, start_time);
+    search_checkpoint_save(&ckpt, &pool);
+    if (search_pool_join(&pool)) {
+        printf("Key found by process %d\n", id);
+    }
+    search_dist_finish(&dist);
+    search_dist_weights_free(&weights);
+    search_checkpoint_free(&ckpt);
+    des_check_free(&check);
+    found = stop.key;
+
+    // Processes given up on (--lease) never reach the barrier
+    if (dist.lost == 0) {
+        search_stats_barrier(&stats, comm);
+    }
+
+    if (id == 0 && found == SEARCH_STOP_NONE) {
+        printf("Key not found\n");
+        printf("Time taken to search the key space: %f seconds\n", MPI_Wtime() - start_time);
+    } else if (id == 0) {
         end_time = MPI_Wtime();
         double elapsed_time = end_time - start_time;
 
@@ -249,11 +265,14 @@ int main(int argc, char *argv[]) {
 
         printf("Key found: %li\nDecrypted: %s\n", found, decrypted);
         printf("Time taken to find the key: %f seconds\n", elapsed_time);
+        printf("Stop latency: %f seconds\n", stop.latency);
 
         free(decrypted);
     }
 
 
+    search_dist_abandon(comm, dist.lost);
+    search_stats_report(&stats, comm);
     MPI_Barrier(comm);
     MPI_Finalize();
     return 0;
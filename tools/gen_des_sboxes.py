@@ -0,0 +1,210 @@
+#!/usr/bin/env python3
+"""Generates des_bitslice_sboxes.h, the straight-line S-box circuits used by
+the bitsliced DES kernels (des_bitslice_kernel.h).
+
+Each S-box output is built as a multiplexer tree over four of the six input
+bits whose leaves are functions of the remaining two. Nodes are hashed so the
+four outputs of an S-box share common subtrees, and every choice of leaf pair
+and multiplexer order is tried to keep the gate count small.
+
+Usage: python3 tools/gen_des_sboxes.py > des_bitslice_sboxes.h
+"""
+import itertools
+
+SBOX = [
+    [[14, 4, 13, 1, 2, 15, 11, 8, 3, 10, 6, 12, 5, 9, 0, 7],
+     [0, 15, 7, 4, 14, 2, 13, 1, 10, 6, 12, 11, 9, 5, 3, 8],
+     [4, 1, 14, 8, 13, 6, 2, 11, 15, 12, 9, 7, 3, 10, 5, 0],
+     [15, 12, 8, 2, 4, 9, 1, 7, 5, 11, 3, 14, 10, 0, 6, 13]],
+    [[15, 1, 8, 14, 6, 11, 3, 4, 9, 7, 2, 13, 12, 0, 5, 10],
+     [3, 13, 4, 7, 15, 2, 8, 14, 12, 0, 1, 10, 6, 9, 11, 5],
+     [0, 14, 7, 11, 10, 4, 13, 1, 5, 8, 12, 6, 9, 3, 2, 15],
+     [13, 8, 10, 1, 3, 15, 4, 2, 11, 6, 7, 12, 0, 5, 14, 9]],
+    [[10, 0, 9, 14, 6, 3, 15, 5, 1, 13, 12, 7, 11, 4, 2, 8],
+     [13, 7, 0, 9, 3, 4, 6, 10, 2, 8, 5, 14, 12, 11, 15, 1],
+     [13, 6, 4, 9, 8, 15, 3, 0, 11, 1, 2, 12, 5, 10, 14, 7],
+     [1, 10, 13, 0, 6, 9, 8, 7, 4, 15, 14, 3, 11, 5, 2, 12]],
+    [[7, 13, 14, 3, 0, 6, 9, 10, 1, 2, 8, 5, 11, 12, 4, 15],
+     [13, 8, 11, 5, 6, 15, 0, 3, 4, 7, 2, 12, 1, 10, 14, 9],
+     [10, 6, 9, 0, 12, 11, 7, 13, 15, 1, 3, 14, 5, 2, 8, 4],
+     [3, 15, 0, 6, 10, 1, 13, 8, 9, 4, 5, 11, 12, 7, 2, 14]],
+    [[2, 12, 4, 1, 7, 10, 11, 6, 8, 5, 3, 15, 13, 0, 14, 9],
+     [14, 11, 2, 12, 4, 7, 13, 1, 5, 0, 15, 10, 3, 9, 8, 6],
+     [4, 2, 1, 11, 10, 13, 7, 8, 15, 9, 12, 5, 6, 3, 0, 14],
+     [11, 8, 12, 7, 1, 14, 2, 13, 6, 15, 0, 9, 10, 4, 5, 3]],
+    [[12, 1, 10, 15, 9, 2, 6, 8, 0, 13, 3, 4, 14, 7, 5, 11],
+     [10, 15, 4, 2, 7, 12, 9, 5, 6, 1, 13, 14, 0, 11, 3, 8],
+     [9, 14, 15, 5, 2, 8, 12, 3, 7, 0, 4, 10, 1, 13, 11, 6],
+     [4, 3, 2, 12, 9, 5, 15, 10, 11, 14, 1, 7, 6, 0, 8, 13]],
+    [[4, 11, 2, 14, 15, 0, 8, 13, 3, 12, 9, 7, 5, 10, 6, 1],
+     [13, 0, 11, 7, 4, 9, 1, 10, 14, 3, 5, 12, 2, 15, 8, 6],
+     [1, 4, 11, 13, 12, 3, 7, 14, 10, 15, 6, 8, 0, 5, 9, 2],
+     [6, 11, 13, 8, 1, 4, 10, 7, 9, 5, 0, 15, 14, 2, 3, 12]],
+    [[13, 2, 8, 4, 6, 15, 11, 1, 10, 9, 3, 14, 5, 0, 12, 7],
+     [1, 15, 13, 8, 10, 3, 7, 4, 12, 5, 6, 11, 0, 14, 9, 2],
+     [7, 11, 4, 1, 9, 12, 14, 2, 0, 6, 10, 13, 15, 3, 5, 8],
+     [2, 1, 14, 7, 4, 10, 8, 13, 15, 12, 9, 0, 3, 5, 6, 11]],
+]
+
+
+def sbox_bit(s, v, o):
+    """Output bit o (0 = MSB) of S-box s for 6-bit input v (b1 = MSB)."""
+    row = ((v >> 4) & 2) | (v & 1)
+    col = (v >> 1) & 0xF
+    return (SBOX[s][row][col] >> (3 - o)) & 1
+
+
+class Circuit:
+    def __init__(self):
+        self.nodes = []    # (op, a, b)
+        self.index = {}
+
+    def node(self, op, a, b=None):
+        if op in ('and', 'or', 'xor') and b is not None and b < a:
+            a, b = b, a
+        key = (op, a, b)
+        if key not in self.index:
+            self.index[key] = len(self.nodes)
+            self.nodes.append(key)
+        return self.index[key]
+
+    def gates(self):
+        return sum(1 for op, _, _ in self.nodes if op not in ('in', 'zero', 'one'))
+
+
+def leaf(c, truth, a, b, na, nb):
+    """Node computing the 2-input function with truth table truth over (a, b),
+    where bit t of truth is the value for a = t >> 1, b = t & 1."""
+    if truth == 0:
+        return c.node('zero', 0)
+    if truth == 15:
+        return c.node('one', 0)
+    forms = {
+        0b1100: lambda: a, 0b0011: lambda: na(),
+        0b1010: lambda: b, 0b0101: lambda: nb(),
+        0b1000: lambda: c.node('and', a, b),
+        0b1110: lambda: c.node('or', a, b),
+        0b0110: lambda: c.node('xor', a, b),
+        0b1001: lambda: c.node('not', c.node('xor', a, b)),
+        0b0100: lambda: c.node('andn', a, b),   # a & ~b
+        0b0010: lambda: c.node('andn', b, a),   # ~a & b
+        0b0001: lambda: c.node('not', c.node('or', a, b)),
+        0b0111: lambda: c.node('not', c.node('and', a, b)),
+        0b1011: lambda: c.node('not', c.node('andn', a, b)),
+        0b1101: lambda: c.node('not', c.node('andn', b, a)),
+    }
+    return forms[truth]()
+
+
+def mux(c, lo, hi, sel):
+    """Node computing sel ? hi : lo, folding constant and complementary inputs."""
+    zero, one = c.node('zero', 0), c.node('one', 0)
+    if lo == hi:
+        return lo
+    if lo == zero:
+        return sel if hi == one else c.node('and', hi, sel)
+    if hi == zero:
+        return c.node('not', sel) if lo == one else c.node('andn', lo, sel)
+    if hi == one:
+        return c.node('or', lo, sel)
+    if lo == one:
+        return c.node('not', c.node('andn', sel, hi))
+    if c.nodes[hi] == ('not', lo, None) or c.nodes[lo] == ('not', hi, None):
+        return c.node('xor', lo, sel)
+    return c.node('xor', lo, c.node('and', c.node('xor', lo, hi), sel))
+
+
+def build(s, pair, order):
+    c = Circuit()
+    inputs = [c.node('in', i) for i in range(6)]
+    a, b = inputs[pair[0]], inputs[pair[1]]
+    na = lambda: c.node('not', a)
+    nb = lambda: c.node('not', b)
+    outputs = []
+    for o in range(4):
+        # order[0] is the top multiplexer, order[-1] the one above the leaves
+        level = []
+        for g in range(16):
+            truth = 0
+            for t in range(4):
+                v = 0
+                for k, var in enumerate(order):
+                    if (g >> (3 - k)) & 1:
+                        v |= 1 << (5 - var)
+                if t >> 1:
+                    v |= 1 << (5 - pair[0])
+                if t & 1:
+                    v |= 1 << (5 - pair[1])
+                if sbox_bit(s, v, o):
+                    truth |= 1 << t
+            level.append(leaf(c, truth, a, b, na, nb))
+        for var in reversed(order):
+            sel = inputs[var]
+            nxt = []
+            for k in range(0, len(level), 2):
+                nxt.append(mux(c, level[k], level[k + 1], sel))
+            level = nxt
+        outputs.append(level[0])
+    return c, outputs
+
+
+def best(s):
+    result = None
+    for pair in itertools.combinations(range(6), 2):
+        rest = [i for i in range(6) if i not in pair]
+        for order in itertools.permutations(rest):
+            c, outs = build(s, pair, order)
+            if result is None or c.gates() < result[0].gates():
+                result = (c, outs)
+    return result
+
+
+def emit(s, c, outs):
+    lines = []
+    lines.append('static inline void DES_BS_FN(s%d)(DES_BS_WORD x0, DES_BS_WORD x1, DES_BS_WORD x2,' % (s + 1))
+    lines.append('                                 DES_BS_WORD x3, DES_BS_WORD x4, DES_BS_WORD x5,')
+    lines.append('                                 DES_BS_WORD *o0, DES_BS_WORD *o1, DES_BS_WORD *o2, DES_BS_WORD *o3) {')
+    names = {}
+    for i, (op, a, b) in enumerate(c.nodes):
+        if op == 'in':
+            names[i] = 'x%d' % a
+            continue
+        if op == 'zero':
+            names[i] = 'DES_BS_ZERO'
+            continue
+        if op == 'one':
+            names[i] = 'DES_BS_ONES'
+            continue
+        name = 't%d' % i
+        names[i] = name
+        if op == 'not':
+            expr = '~%s' % names[a]
+        elif op == 'andn':
+            expr = '%s & ~%s' % (names[a], names[b])
+        else:
+            sym = {'and': '&', 'or': '|', 'xor': '^'}[op]
+            expr = '%s %s %s' % (names[a], sym, names[b])
+        lines.append('    DES_BS_WORD %s = %s;' % (name, expr))
+    for o, n in enumerate(outs):
+        lines.append('    *o%d = %s;' % (o, names[n]))
+    lines.append('}')
+    return '\n'.join(lines)
+
+
+def main():
+    print('// Generated by tools/gen_des_sboxes.py, do not edit.')
+    print('//')
+    print('// Bitsliced DES S-boxes. Inputs x0..x5 are the S-box input bits b1..b6,')
+    print('// outputs o0..o3 the four output bits, most significant first.')
+    print('//')
+    print('// Included by des_bitslice_kernel.h once per register width, with')
+    print('// DES_BS_WORD, DES_BS_FN, DES_BS_ZERO and DES_BS_ONES defined by the caller.')
+    for s in range(8):
+        c, outs = best(s)
+        print()
+        print('// S%d: %d gates' % (s + 1, c.gates()))
+        print(emit(s, c, outs))
+
+
+if __name__ == '__main__':
+    main()
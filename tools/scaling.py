@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""Runs the strong scaling, weak scaling and key-position experiments on the
+MPI solvers and writes speedup, efficiency and time-to-key tables.
+
+Every run searches a reduced key space (--key-bits) with the default static
+split, where process r searches [r * 2^bits / N, (r + 1) * 2^bits / N) and,
+in solucion1 and solucion2, odd processes walk their range downwards. The
+time of a run is the "Time taken to find the key" printed by rank 0; each
+point is the median of --repeat runs.
+
+- strong: fixed keys (fractions of the key space), every rank and thread
+  count. Speedup and efficiency are relative to the smallest rank count
+  (normally 1) with the same thread count.
+- positions: for every rank count, keys at the start, middle and end of the
+  last rank's range, on both sides of the middle range boundary, and at the
+  first and last key the reverse scan of rank 1 visits.
+- weak: 2^(bits + log2 N) keys on N ranks (powers of two only), with the key
+  at the end of rank 0's range, so every rank has the same amount of work.
+
+The positions experiment assumes the default traversal; passing
+"-- --traversal=random" to the other two measures scaling without the time
+to key depending on where the key falls.
+
+Results go to DIR/raw.csv, DIR/strong.csv, DIR/positions.csv and
+DIR/weak.csv; the tables are also printed.
+
+Usage: python3 tools/scaling.py [--ranks=1,2,4] [--threads=1] [--key-bits=22]
+           [--programs=solucion1,solucion2,bruteforce_partB] [--repeat=3]
+           [--mpirun="mpirun --oversubscribe"] [--out=DIR] [-- solver options]
+"""
+import argparse
+import csv
+import math
+import os
+import re
+import shlex
+import statistics
+import subprocess
+import sys
+
+TIME_RE = re.compile(r'Time taken to find the key: ([0-9.]+) seconds')
+
+
+def share(bits, ranks, rank):
+    """First and last counter of rank's static share."""
+    space = 1 << bits
+    per_rank = space // ranks
+    lower = per_rank * rank
+    upper = space - 1 if rank == ranks - 1 else per_rank * (rank + 1) - 1
+    return lower, upper
+
+
+def placements(bits, ranks):
+    """Named key positions for the key-position experiment."""
+    lower, upper = share(bits, ranks, ranks - 1)
+    keys = {
+        'last_rank_start': lower,
+        'last_rank_middle': (lower + upper) // 2,
+        'last_rank_end': upper,
+    }
+    if ranks > 1:
+        boundary = share(bits, ranks, ranks // 2)[0]
+        keys['boundary_below'] = boundary - 1
+        keys['boundary_above'] = boundary
+        lower, upper = share(bits, ranks, 1)
+        keys['reverse_first'] = upper
+        keys['reverse_last'] = lower
+    return keys
+
+
+class Runner:
+    def __init__(self, args):
+        self.args = args
+        self.raw = []
+
+    def run(self, experiment, program, ranks, threads, bits, placement, key):
+        """Median time of --repeat runs, or NaN if the key was not reported."""
+        command = shlex.split(self.args.mpirun) + ['-np', str(ranks), os.path.join(self.args.bin_dir, program),
+                                                   '--key-bits=%d' % bits, '--threads=%d' % threads]
+        command += self.args.solver_options + [self.args.text, self.args.keyword, str(key)]
+        times = []
+        for rep in range(self.args.repeat):
+            try:
+                result = subprocess.run(command, capture_output=True, text=True, timeout=self.args.timeout)
+                match = TIME_RE.search(result.stdout)
+                seconds = float(match.group(1)) if match else math.nan
+            except subprocess.TimeoutExpired:
+                seconds = math.nan
+            times.append(seconds)
+            self.raw.append([experiment, program, ranks, threads, bits, placement, key, rep, seconds])
+        valid = [t for t in times if not math.isnan(t)]
+        return statistics.median(valid) if valid else math.nan
+
+
+def write_table(path, header, rows, title):
+    with open(path, 'w', newline='') as out:
+        writer = csv.writer(out)
+        writer.writerow(header)
+        writer.writerows(rows)
+    print('\n## %s (%s)\n' % (title, path))
+    print('| ' + ' | '.join(header) + ' |')
+    print('|' + '---|' * len(header))
+    for row in rows:
+        print('| ' + ' | '.join('%.4f' % v if isinstance(v, float) else str(v) for v in row) + ' |')
+
+
+def strong(runner, args):
+    rows = []
+    for program in args.programs:
+        for threads in args.threads:
+            for fraction in args.fractions:
+                key = int(fraction * ((1 << args.key_bits) - 1))
+                base = None
+                for ranks in args.ranks:
+                    seconds = runner.run('strong', program, ranks, threads, args.key_bits, 'fraction_%g' % fraction,
+                                         key)
+                    if ranks == args.ranks[0]:
+                        base = seconds * ranks
+                    speedup = base / seconds if seconds > 0 else math.nan
+                    rows.append([program, threads, fraction, key, ranks, seconds, speedup, speedup / ranks])
+    write_table(os.path.join(args.out, 'strong.csv'),
+                ['program', 'threads', 'key_fraction', 'key', 'ranks', 'seconds', 'speedup', 'efficiency'], rows,
+                'Strong scaling')
+
+
+def positions(runner, args):
+    rows = []
+    threads = args.threads[0]
+    for program in args.programs:
+        for ranks in args.ranks:
+            for name, key in placements(args.key_bits, ranks).items():
+                seconds = runner.run('positions', program, ranks, threads, args.key_bits, name, key)
+                rows.append([program, ranks, name, key, seconds])
+    write_table(os.path.join(args.out, 'positions.csv'), ['program', 'ranks', 'placement', 'key', 'seconds'], rows,
+                'Time to key by key position')
+
+
+def weak(runner, args):
+    rows = []
+    threads = args.threads[0]
+    for program in args.programs:
+        base = None
+        for ranks in args.ranks:
+            if ranks & (ranks - 1):
+                continue
+            bits = args.key_bits + ranks.bit_length() - 1
+            key = share(bits, ranks, 0)[1]
+            seconds = runner.run('weak', program, ranks, threads, bits, 'rank0_end', key)
+            if base is None:
+                base = seconds
+            rows.append([program, ranks, bits, key, seconds, base / seconds if seconds > 0 else math.nan])
+    write_table(os.path.join(args.out, 'weak.csv'), ['program', 'ranks', 'key_bits', 'key', 'seconds', 'efficiency'],
+                rows, 'Weak scaling')
+
+
+def int_list(text):
+    return [int(v) for v in text.split(',')]
+
+
+def main():
+    argv = sys.argv[1:]
+    solver_options = []
+    if '--' in argv:
+        solver_options = argv[argv.index('--') + 1:]
+        argv = argv[:argv.index('--')]
+
+    parser = argparse.ArgumentParser(description='Scaling and key-position experiments for the MPI solvers.')
+    parser.add_argument('--ranks', type=int_list, default=[1, 2, 4])
+    parser.add_argument('--threads', type=int_list, default=[1])
+    parser.add_argument('--key-bits', type=int, default=22)
+    parser.add_argument('--fractions', type=lambda t: [float(v) for v in t.split(',')], default=[0.5, 0.99],
+                        help='key positions of the strong scaling runs, as fractions of the key space')
+    parser.add_argument('--programs', type=lambda t: t.split(','),
+                        default=['solucion1', 'solucion2', 'bruteforce_partB'])
+    parser.add_argument('--experiments', type=lambda t: t.split(','), default=['strong', 'positions', 'weak'])
+    parser.add_argument('--repeat', type=int, default=3)
+    parser.add_argument('--timeout', type=float, default=600)
+    parser.add_argument('--mpirun', default='mpirun')
+    parser.add_argument('--bin-dir', default='.')
+    parser.add_argument('--text', default='example.txt')
+    parser.add_argument('--keyword', default='Esta es una prueba',
+                        help='15+ characters, so solucion2 finds it at any offset')
+    parser.add_argument('--out', default='scaling')
+    args = parser.parse_args(argv)
+    args.solver_options = solver_options
+    args.ranks.sort()
+
+    os.makedirs(args.out, exist_ok=True)
+    runner = Runner(args)
+    experiments = {'strong': strong, 'positions': positions, 'weak': weak}
+    for name in args.experiments:
+        experiments[name](runner, args)
+
+    with open(os.path.join(args.out, 'raw.csv'), 'w', newline='') as out:
+        writer = csv.writer(out)
+        writer.writerow(['experiment', 'program', 'ranks', 'threads', 'key_bits', 'placement', 'key', 'repeat',
+                         'seconds'])
+        writer.writerows(runner.raw)
+
+
+if __name__ == '__main__':
+    main()